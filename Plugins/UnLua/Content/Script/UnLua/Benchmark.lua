@@ -0,0 +1,238 @@
+--- UnLuaBenchmark commandlet 的测试对象 UUnLuaBenchmarkObject 绑定的模块
+--- 每个函数执行约Count次被测操作，返回实际执行的操作次数
+local M = UnLua.Class()
+
+local Notified = 0
+
+function M:Compute(Value)
+    return Value + 1
+end
+
+function M:BindNotify()
+    self.OnNotify:Add(self, M.OnNotified)
+end
+
+function M:OnNotified(Value)
+    Notified = Value
+end
+
+local function OnEvent(Value)
+    Notified = Value
+end
+
+--- 每个主题 UnLua.Benchmark.<N> 订阅N个监听，每次发布算一次操作
+for _, N in ipairs({ 1, 10, 1000 }) do
+    local Topic = "UnLua.Benchmark." .. N
+
+    M["SubscribeEvents" .. N] = function()
+        for _ = 1, N do
+            UnLua.Subscribe(Topic, OnEvent)
+        end
+    end
+
+    M["PublishEvents" .. N] = function(_, Count)
+        local Publish = UnLua.Publish
+        for i = 1, Count do
+            Publish(Topic, i)
+        end
+        return Count
+    end
+end
+
+local Hits = 0
+
+function M:ServerHit_RPC(Value, Location)
+    Hits = Hits + Value + Location.X
+end
+
+--- Batch依次为每次调用的self和参数
+function M.ServerHitBatched_Batch(Batch, Count)
+    for i = 1, Count * 3, 3 do
+        local Value, Location = Batch[i + 1], Batch[i + 2]
+        Hits = Hits + Value + Location.X
+    end
+end
+
+function M:CallUE(Count)
+    local Sum = 0
+    for _ = 1, Count do
+        Sum = self:Add(Sum, 1)
+    end
+    return Count
+end
+
+function M:ReadProperty(Count)
+    local Value
+    for _ = 1, Count do
+        Value = self.IntValue
+    end
+    return Count
+end
+
+function M:WriteProperty(Count)
+    for i = 1, Count do
+        self.IntValue = i
+    end
+    return Count
+end
+
+--- 每访问一个结构体字段算一次操作
+function M:ReadHitResult(Count)
+    local Hit = self.Hit
+    local Sum = 0
+    local N = Count // 3
+    for _ = 1, N do
+        if Hit.bBlockingHit then
+            Sum = Sum + Hit.Distance + Hit.Time
+        end
+    end
+    return N * 3
+end
+
+function M:ReadHitResultNested(Count)
+    local Hit = self.Hit
+    local Sum = 0
+    local N = Count // 2
+    for _ = 1, N do
+        Sum = Sum + Hit.Location.X
+    end
+    return N * 2
+end
+
+function M:WriteHitResult(Count)
+    local Hit = self.Hit
+    local N = Count // 2
+    for i = 1, N do
+        Hit.Distance = i
+        Hit.bBlockingHit = i % 2 == 0
+    end
+    return N * 2
+end
+
+--- 每访问一个元素算一次操作
+function M:IterateArray(Count)
+    local Numbers = self.Numbers
+    local Length = Numbers:Length()
+    local Sum = 0
+    local N = Count // Length
+    for _ = 1, N do
+        for _, Value in pairs(Numbers) do
+            Sum = Sum + Value
+        end
+    end
+    return N * Length
+end
+
+--- 静态导出的加法和点积，每次调用两个函数算一次操作
+function M:StaticExportMath(Count)
+    local Math = UE.FUnLuaBenchmarkMath
+    local Add, Dot = Math.Add, Math.Dot
+    local A = UE.FVector(1, 2, 3)
+    local B = UE.FVector(4, 5, 6)
+    local Sum = 0
+    for _ = 1, Count do
+        Sum = Sum + Dot(Add(A, B), B)
+    end
+    return Count
+end
+
+function M:StaticExportMathLegacy(Count)
+    local Math = UE.FUnLuaBenchmarkMath
+    local Add, Dot = Math.AddLegacy, Math.DotLegacy
+    local A = UE.FVector(1, 2, 3)
+    local B = UE.FVector(4, 5, 6)
+    local Sum = 0
+    for _ = 1, Count do
+        Sum = Sum + Dot(Add(A, B), B)
+    end
+    return Count
+end
+
+--- 用UE.File按行或一次读完整个文件，返回读到的字节数
+function M:ReadFileLines(Path, Mode)
+    local File = UE.File()
+    if not File:Open(Path, Mode) then
+        error("failed to open " .. Path)
+    end
+    local Size = 0
+    local Line = File:Read("L")
+    while Line do
+        Size = Size + #Line
+        Line = File:Read("L")
+    end
+    File:Close()
+    return Size
+end
+
+function M:ReadFileAll(Path, Mode)
+    local File = UE.File()
+    if not File:Open(Path, Mode) then
+        error("failed to open " .. Path)
+    end
+    local Size = #File:Read("a")
+    File:Close()
+    return Size
+end
+
+--- 热更新替换对象图：100个模块各100个函数，每替换一个函数算一次操作
+local PatchedModules, PatchedValues
+
+function M:PrepareObjectGraph()
+    PatchedModules, PatchedValues = {}, {}
+    for i = 1, 100 do
+        local Module = {}
+        for j = 1, 100 do
+            local Old = function() return i + j end
+            Module["F" .. j] = Old
+            PatchedValues[Old] = function() return i * j end
+        end
+        PatchedModules[i] = Module
+    end
+    -- 和真实模块一样从_G可达
+    _G.UnLuaBenchmarkModules = PatchedModules
+end
+
+local function PatchObjectGraph(Native)
+    if Native and not UnLua.PatchObjectGraph then
+        error("UnLua.PatchObjectGraph is not available in this build")
+    end
+    local HotReload = require("UnLua.HotReload")
+    local WasNative = HotReload.config.native_graph_patch
+    HotReload.config.native_graph_patch = Native
+    HotReload.update_global(PatchedValues)
+    HotReload.config.native_graph_patch = WasNative
+    _G.UnLuaBenchmarkModules = nil
+end
+
+function M:PatchObjectGraphNative()
+    PatchObjectGraph(true)
+end
+
+function M:PatchObjectGraphLua()
+    PatchObjectGraph(false)
+end
+
+--- 返回上次替换了的函数个数
+function M:CountPatchedFunctions()
+    local Count = 0
+    for _, Module in ipairs(PatchedModules) do
+        for _, F in pairs(Module) do
+            if PatchedValues[F] == nil then
+                Count = Count + 1
+            end
+        end
+    end
+    return Count
+end
+
+function M:VectorMath(Count)
+    local A = UE.FVector(1, 2, 3)
+    local B = UE.FVector(4, 5, 6)
+    local Sum = 0
+    for _ = 1, Count do
+        Sum = Sum + (A + B):Dot(B)
+    end
+    return Count
+end
+
+return M
@@ -0,0 +1,6 @@
+--- 同 UnLua.BenchmarkTick，由 TickManager 批量Tick
+local M = UnLua.Class("UnLua.BenchmarkTick")
+
+M.BatchedTick = true
+
+return M
@@ -0,0 +1,8 @@
+--- UnLuaBenchmark 中每帧Tick的 AUnLuaBenchmarkTickActor 绑定的模块
+local M = UnLua.Class()
+
+function M:ReceiveTick(DeltaSeconds)
+    self.Elapsed = (self.Elapsed or 0) + DeltaSeconds
+end
+
+return M
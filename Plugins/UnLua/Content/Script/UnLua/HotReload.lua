@@ -15,6 +15,8 @@ local ignore_modules = {}
 local config = {
     debug = false,
     script_root_path = UE.UUnLuaFunctionLibrary.GetScriptRootPath(),
+    -- 使用C++遍历对象图替换引用，设为false可回退到Lua实现做对比
+    native_graph_patch = true,
     ignore_modules = ignore_modules
 }
 local hook = {
@@ -113,6 +115,9 @@ end
 ---@type table<string, number>
 local loaded_module_times = {}
 
+--- 文件监听的序号，只处理此序号之后修改的模块
+local _, watcher_serial = UnLua.GetModifiedModules()
+
 local function get_last_modified_time(module_name)
     local filename = config.script_root_path .. module_name:gsub("%.", "/") .. ".lua"
     return UE.UUnLuaFunctionLibrary.GetFileLastModifiedTimestamp(filename)
@@ -472,9 +477,18 @@ local function update_global(value_map)
         end
     end
 
+    local start_time = os.clock()
+    if config.native_graph_patch and UnLua.PatchObjectGraph then
+        -- 从 update_modules 的栈帧开始，与 update_running_stack(running_state, 2) 一致
+        local count = UnLua.PatchObjectGraph(value_map, exclude, 2, _G, debug.getregistry())
+        print(string.format("patched %d objects in %.3fs", count, os.clock() - start_time))
+        return
+    end
+
     update_running_stack(running_state, 2)
     update_table(_G)
     update_table(debug.getregistry())
+    print(string.format("patched objects in %.3fs", os.clock() - start_time))
 end
 
 local function update_modules(old_modules, new_modules, new_envs)
@@ -609,14 +623,27 @@ function M.reload(module_names)
 
     local modified_modules = {}
 
-    for module_name, time in pairs(loaded_module_times) do
-        if not ignore_modules[module_name] then
-            local current_time = get_last_modified_time(module_name)
-            if current_time ~= time then
+    local watched_modules, serial = UnLua.GetModifiedModules(watcher_serial)
+    if watched_modules and watcher_serial then
+        -- the native watcher already knows what changed, no need to stat every loaded module
+        watcher_serial = serial
+        for _, module_name in ipairs(watched_modules) do
+            if loaded_module_times[module_name] and not ignore_modules[module_name] then
                 modified_modules[#modified_modules + 1] = module_name
-                loaded_module_times[module_name] = current_time
+                loaded_module_times[module_name] = get_last_modified_time(module_name)
+            end
+        end
+    else
+        for module_name, time in pairs(loaded_module_times) do
+            if not ignore_modules[module_name] then
+                local current_time = get_last_modified_time(module_name)
+                if current_time ~= time then
+                    modified_modules[#modified_modules + 1] = module_name
+                    loaded_module_times[module_name] = current_time
+                end
             end
         end
+        watcher_serial = serial
     end
     print("modified modules:", dump(modified_modules))
     if #modified_modules > 0 then
@@ -625,5 +652,7 @@ function M.reload(module_names)
 end
 
 M.require = sandbox.require
+-- 供UnLuaBenchmark commandlet对比C++和Lua两种对象图替换的耗时
+M.update_global = update_global
 
 return M
@@ -0,0 +1,18 @@
+local M = {}
+
+--- 纯Lua计算，供lua.bench.jobs在游戏线程和工作线程上运行并比较结果
+function M.Score(Args)
+    local Seed = Args.Seed
+    local Best, BestScore, Sum = 0, -math.huge, 0
+    for i = 1, Args.Count do
+        Seed = (Seed * 1103515245 + 12345) % 2147483648
+        local Score = math.sin(Seed) * 0.5 + (Seed % 1000) / 1000
+        Sum = Sum + Score
+        if Score > BestScore then
+            Best, BestScore = i, Score
+        end
+    end
+    return { Best, BestScore, Sum }
+end
+
+return M
@@ -508,7 +508,7 @@ static int32 TArray_Delete(lua_State* L)
         return 0;
 
     auto Registry = UnLua::FLuaEnv::FindEnvChecked(L).GetContainerRegistry();
-    Registry->Remove(Array);
+    Registry->Remove(L, 1, Array);
 
     Array->~FLuaArray();
     return 0;
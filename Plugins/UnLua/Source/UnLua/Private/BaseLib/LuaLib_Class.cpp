@@ -14,6 +14,7 @@
 
 #include "UnLuaEx.h"
 #include "LuaCore.h"
+#include "BaseLib/LuaLib_Object.h"
 #include "ReflectionUtils/ClassDesc.h"
 
 #if UNLUA_LEGACY_BLUEPRINT_PATH
@@ -73,6 +74,32 @@ int32 UClass_Load(lua_State* L)
     return 1;
 }
 
+/**
+ * Load a class asynchronously, in a coroutine or with a callback. for example:
+ *   local Class = UClass.LoadAsync("/Game/Core/Blueprints/AICharacter.AICharacter_C")
+ * @see UObject.LoadAsync(...)
+ */
+static int32 UClass_LoadAsync(lua_State* L)
+{
+    const int32 NumParams = lua_gettop(L);
+    if (NumParams < 1 || NumParams > 2)
+        return luaL_error(L, "invalid parameters");
+
+    const char* ClassPath = lua_tostring(L, 1);
+    if (!ClassPath)
+        return luaL_error(L, "invalid class name");
+
+    FString Name = UTF8_TO_TCHAR(ClassPath);
+
+#if UNLUA_LEGACY_BLUEPRINT_PATH
+    LeagcyAppendSuffix(Name);
+#endif
+
+    TArray<FSoftObjectPath> Paths;
+    Paths.Emplace(Name);
+    return UObject_LoadAsyncPaths(L, MoveTemp(Paths), 2, LoadAsync_Class);
+}
+
 /**
  * Test whether this class is a child of another class
  */
@@ -127,6 +154,7 @@ static int32 UClass_GetDefaultObject(lua_State* L)
 static const luaL_Reg UClassLib[] =
 {
     {"Load", UClass_Load},
+    {"LoadAsync", UClass_LoadAsync},
     {"IsChildOf", UClass_IsChildOf},
     {"GetDefaultObject", UClass_GetDefaultObject},
     {nullptr, nullptr}
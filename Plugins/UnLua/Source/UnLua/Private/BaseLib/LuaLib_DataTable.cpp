@@ -14,10 +14,285 @@
 
 #include "UnLuaEx.h"
 #include "LuaCore.h"
+#include "LuaEnv.h"
+#include "Registries/ClassRegistry.h"
+#include "Registries/ObjectRegistry.h"
 #include "Kismet/DataTableFunctionLibrary.h"
+#include "ReflectionUtils/FieldDesc.h"
+#include "ReflectionUtils/PropertyDesc.h"
 
 namespace UnLua
 {
+    /**
+     * Change tracking for data tables. Row views share the state of their table and validate themselves without any
+     * lookup, the state outlives the table as long as a view holds it.
+     */
+    struct FDataTableState
+    {
+        uint32 Version = 0;
+    };
+
+    /**
+     * States of the data tables which have row views, dropped when their table is destroyed
+     */
+    class FDataTableStates : public FUObjectArray::FUObjectDeleteListener
+    {
+    public:
+        static FDataTableStates& Get()
+        {
+            static FDataTableStates Instance;
+            return Instance;
+        }
+
+        FDataTableStates()
+        {
+            GUObjectArray.AddUObjectDeleteListener(this);
+        }
+
+        TSharedPtr<FDataTableState> FindOrAdd(UDataTable* Table)
+        {
+            if (const auto Exists = States.Find(Table))
+                return *Exists;
+
+            const auto State = MakeShared<FDataTableState>();
+            States.Add(Table, State);
+            Table->OnDataTableChanged().AddLambda([WeakState = TWeakPtr<FDataTableState>(State)]
+            {
+                if (const auto Pinned = WeakState.Pin())
+                    ++Pinned->Version;
+            });
+            return State;
+        }
+
+        virtual void NotifyUObjectDeleted(const UObjectBase* Object, int32 Index) override
+        {
+            if (States.Num() > 0)
+                States.Remove(Object);
+        }
+
+        virtual void OnUObjectArrayShutdown() override
+        {
+            GUObjectArray.RemoveUObjectDeleteListener(this);
+        }
+
+    private:
+        TMap<const UObjectBase*, TSharedPtr<FDataTableState>> States;
+    };
+
+    /**
+     * Read-only view pointing directly into the row memory of a data table. It is invalidated
+     * when the table changes (reimport, rows added or removed) or is unloaded.
+     */
+    struct FDataTableRowView
+    {
+        TWeakObjectPtr<UDataTable> Table;
+        TSharedPtr<FDataTableState> State;
+        uint32 Version;
+        void* RowPtr;
+
+        FORCEINLINE bool IsValid() const { return State->Version == Version && Table.IsValid(); }
+    };
+
+    /** Row view metatables by row struct, dropped with all their cached descriptors whenever a class is unregistered */
+    static const char* ROW_VIEW_METATABLES_KEY = "UnLua_RowViewMetatables";
+
+    /**
+     * Resolve a field of the row struct and cache it in the field table (upvalue 1)
+     */
+    static bool RowView_ResolveField(lua_State* L)
+    {
+        FClassDesc* ClassDesc = (FClassDesc*)lua_touserdata(L, lua_upvalueindex(2));
+        TSharedPtr<FFieldDesc> Field = ClassDesc->RegisterField(FName(UTF8_TO_TCHAR(lua_tostring(L, 2))), ClassDesc);
+        if (!Field || !Field->IsValid() || !Field->IsProperty())
+            return false;
+
+        FLuaEnv::FindEnvChecked(L).GetObjectRegistry()->Push(L, Field->AsProperty());
+        lua_pushvalue(L, 2);
+        lua_pushvalue(L, -2);
+        lua_rawset(L, lua_upvalueindex(1));
+        return true;
+    }
+
+    static int32 RowView_Index(lua_State* L)
+    {
+        if (lua_type(L, 1) != LUA_TUSERDATA || lua_type(L, 2) != LUA_TSTRING)
+            return 0;
+        const FDataTableRowView* View = (FDataTableRowView*)lua_touserdata(L, 1);
+
+        if (!View->IsValid())
+            return luaL_error(L, "attempt to read field '%s' of an invalidated data table row view", lua_tostring(L, 2));
+
+        lua_pushvalue(L, 2);
+        if (lua_rawget(L, lua_upvalueindex(1)) == LUA_TNIL)
+        {
+            lua_pop(L, 1);
+            if (!RowView_ResolveField(L))
+                return 0;
+        }
+
+        const auto Property = static_cast<TSharedPtr<FPropertyDesc>*>(lua_touserdata(L, -1));
+        // nested structs and containers are copied, the row memory may go away while they are alive
+        (*Property)->ReadValue_InContainer(L, View->RowPtr, true);
+        return 1;
+    }
+
+    static int32 RowView_NewIndex(lua_State* L)
+    {
+        return luaL_error(L, "attempt to write field '%s' of a read-only data table row view", lua_tostring(L, 2));
+    }
+
+    static int32 RowView_Delete(lua_State* L)
+    {
+        FDataTableRowView* View = (FDataTableRowView*)lua_touserdata(L, 1);
+        if (View)
+            View->~FDataTableRowView();
+        return 0;
+    }
+
+    /**
+     * Push the metatable of row views for the given struct, it is created on first use
+     */
+    static void PushRowViewMetatable(lua_State* L, const UScriptStruct* StructType)
+    {
+        // structs may have been recompiled or unloaded since, their descriptors must not be used anymore
+        const auto Generation = FClassRegistry::GetMetatableGeneration();
+        bool bValid = lua_getfield(L, LUA_REGISTRYINDEX, ROW_VIEW_METATABLES_KEY) == LUA_TTABLE;
+        if (bValid)
+        {
+            lua_pushstring(L, "Generation");
+            bValid = lua_rawget(L, -2) == LUA_TNUMBER && (uint32)lua_tointeger(L, -1) == Generation;
+            lua_pop(L, 1);
+        }
+        if (!bValid)
+        {
+            lua_pop(L, 1);
+            lua_newtable(L);
+            lua_pushstring(L, "Generation");
+            lua_pushinteger(L, Generation);
+            lua_rawset(L, -3);
+            lua_pushvalue(L, -1);
+            lua_setfield(L, LUA_REGISTRYINDEX, ROW_VIEW_METATABLES_KEY);
+        }
+
+        if (lua_rawgetp(L, -1, StructType) == LUA_TTABLE)
+        {
+            lua_remove(L, -2);
+            return;
+        }
+        lua_pop(L, 1);
+
+        FClassDesc* ClassDesc = FLuaEnv::FindEnvChecked(L).GetClassRegistry()->Register(StructType);
+        check(ClassDesc);
+
+        lua_newtable(L);                        // metatable
+
+        lua_pushstring(L, "__index");
+        lua_newtable(L);                        // field cache
+        lua_pushlightuserdata(L, ClassDesc);
+        lua_pushcclosure(L, RowView_Index, 2);
+        lua_rawset(L, -3);
+
+        lua_pushstring(L, "__newindex");
+        lua_pushcfunction(L, RowView_NewIndex);
+        lua_rawset(L, -3);
+
+        lua_pushstring(L, "__gc");
+        lua_pushcfunction(L, RowView_Delete);
+        lua_rawset(L, -3);
+
+        lua_pushstring(L, "__name");
+        lua_pushstring(L, TCHAR_TO_UTF8(*FString::Printf(TEXT("RowView<%s>"), *ClassDesc->GetName())));
+        lua_rawset(L, -3);
+
+        lua_pushvalue(L, -1);
+        lua_rawsetp(L, -3, StructType);
+        lua_remove(L, -2);
+    }
+
+    /**
+     * Get a read-only view of a row, which reads fields directly from the row memory.
+     */
+    static int32 UDataTable_GetRowView(lua_State* L)
+    {
+        int32 NumParams = lua_gettop(L);
+        if (NumParams != 2)
+            return luaL_error(L, "invalid parameters");
+
+        UDataTable* Table = Cast<UDataTable>(UnLua::GetUObject(L, 1));
+        if (!Table)
+            return luaL_error(L, "invalid UDataTable");
+
+        if (!IsType(L, 2, TType<FName>()))
+            return luaL_error(L, "invalid row name");
+
+        const UScriptStruct* StructType = Table->GetRowStruct();
+        void* RowPtr = Table->FindRowUnchecked(UnLua::Get(L, 2, TType<FName>()));
+        if (!StructType || !RowPtr)
+        {
+            lua_pushnil(L);
+            return 1;
+        }
+
+        PushRowViewMetatable(L, StructType);
+        FDataTableRowView* View = (FDataTableRowView*)lua_newuserdata(L, sizeof(FDataTableRowView));
+        const auto State = FDataTableStates::Get().FindOrAdd(Table);
+        new(View) FDataTableRowView{Table, State, State->Version, RowPtr};
+        lua_insert(L, -2);
+        lua_setmetatable(L, -2);
+        return 1;
+    }
+
+    /**
+     * Get a single field of all rows as a Lua array, in the same order as the row names.
+     */
+    static int32 UDataTable_GetColumn(lua_State* L)
+    {
+        int32 NumParams = lua_gettop(L);
+        if (NumParams != 2)
+            return luaL_error(L, "invalid parameters");
+
+        UDataTable* Table = Cast<UDataTable>(UnLua::GetUObject(L, 1));
+        if (!Table)
+            return luaL_error(L, "invalid UDataTable");
+
+        const UScriptStruct* StructType = Table->GetRowStruct();
+        if (!StructType)
+            return luaL_error(L, "invalid row struct");
+
+        FClassDesc* ClassDesc = FLuaEnv::FindEnvChecked(L).GetClassRegistry()->Register(StructType);
+        TSharedPtr<FFieldDesc> Field = ClassDesc ? ClassDesc->RegisterField(FName(UTF8_TO_TCHAR(luaL_checkstring(L, 2))), ClassDesc) : nullptr;
+        if (!Field || !Field->IsValid() || !Field->IsProperty())
+            return luaL_error(L, "invalid column name");
+
+        const TSharedPtr<FPropertyDesc> Property = Field->AsProperty();
+        const TMap<FName, uint8*>& RowMap = Table->GetRowMap();
+        lua_createtable(L, RowMap.Num(), 0);
+        int32 Index = 0;
+        for (const auto& Pair : RowMap)
+        {
+            Property->ReadValue_InContainer(L, Pair.Value, true);
+            lua_rawseti(L, -2, ++Index);
+        }
+        return 1;
+    }
+
+    /**
+     * Check whether a row view is still pointing at live row memory.
+     */
+    static int32 UDataTable_IsRowViewValid(lua_State* L)
+    {
+        // any value may have been given the metatable of row views with setmetatable
+        bool bValid = false;
+        if (lua_type(L, 1) == LUA_TUSERDATA && lua_getmetatable(L, 1))
+        {
+            lua_pushstring(L, "__newindex");
+            if (lua_rawget(L, -2) == LUA_TFUNCTION && lua_tocfunction(L, -1) == RowView_NewIndex)
+                bValid = ((FDataTableRowView*)lua_touserdata(L, 1))->IsValid();
+            lua_pop(L, 2);
+        }
+        lua_pushboolean(L, bValid);
+        return 1;
+    }
     /**
      * Get row data with structure.
      */
@@ -70,6 +345,9 @@ namespace UnLua
     static const luaL_Reg UDataTableLib[] =
     {
         {"GetRowDataStructure", UDataTable_GetRowDataStructure},
+        {"GetRowView", UDataTable_GetRowView},
+        {"GetColumn", UDataTable_GetColumn},
+        {"IsRowViewValid", UDataTable_IsRowViewValid},
         {nullptr, nullptr}
     };
 
@@ -1,5 +1,7 @@
 #include "UnLuaEx.h"
 #include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
 
 class UE4File
 {
@@ -20,10 +22,27 @@ public:
 	bool Open(const FString&InFilePath,const FString& Mode)
 	{
 		bool Ret = false;
-		
+
+		//'m' suffix on a read-only mode ("rm", "rbm") maps the whole file into memory
+		if (Mode.EndsWith(TEXT("m"), ESearchCase::IgnoreCase))
+		{
+			const FString BaseMode = Mode.LeftChop(1);
+			if (!BaseMode.Equals(TEXT("r"), ESearchCase::IgnoreCase) && !BaseMode.Equals(TEXT("rb"), ESearchCase::IgnoreCase))
+			{
+				return false;
+			}
+			this->Close();
+			if (this->OpenMapped(InFilePath))
+			{
+				return true;
+			}
+			//mapping is not supported on every platform, fall back to a buffered reader
+			return this->Open(InFilePath, BaseMode);
+		}
+
 		if (this->HelperCheckFileMode(Mode, this->Flags, this->bWirte))
 		{
-			FILE.Reset();
+			this->Close();
 			if (this->bWirte)
 			{
 				FArchive* FilePtr = IFileManager::Get().CreateFileWriter(*InFilePath, this->Flags);
@@ -56,25 +75,43 @@ public:
 	void Close()
 	{
 		FILE.Reset();
+		MappedRegion.Reset();
+		MappedHandle.Reset();
+		MappedPos = 0;
+		this->DiscardReadBuffer();
 	}
 	void  Seek(const FString& Mode, int32 Offset)
 	{
-		if (FILE.IsValid())
+		if (this->IsValid())
 		{
 			static const FString modenames[] = { TEXT("set"), TEXT("cur"), TEXT("end")};
+			int64 NewPos = -1;
 			if (Mode.Equals(modenames[0]))
 			{
-				FILE->Seek(Offset);
+				NewPos = Offset;
 			}
 			else if (Mode.Equals(modenames[1]))
 			{
-				FILE->Seek(FILE->Tell() + Offset);
+				NewPos = this->Tell() + Offset;
 			}
 			else if (Mode.Equals(modenames[2]))
 			{
-				int64 Length = FILE->TotalSize();
-				int64 RealOffset = Length - Offset;
-				FILE->Seek(RealOffset);
+				int64 Length = this->TotalSize();
+				NewPos = Length - Offset;
+			}
+
+			if (NewPos < 0)
+			{
+				return;
+			}
+			if (MappedRegion.IsValid())
+			{
+				MappedPos = FMath::Min(NewPos, (int64)MappedRegion->GetMappedSize());
+			}
+			else
+			{
+				this->DiscardReadBuffer();
+				FILE->Seek(NewPos);
 			}
 		}
 
@@ -82,6 +119,10 @@ public:
 
 	int32 TotalSize()
 	{
+		if (MappedRegion.IsValid())
+		{
+			return MappedRegion->GetMappedSize();
+		}
 		if (FILE.IsValid())
 		{
 			return FILE->TotalSize();
@@ -91,7 +132,7 @@ public:
 
 	bool IsValid()
 	{
-		return FILE.IsValid();
+		return FILE.IsValid() || MappedRegion.IsValid();
 	}
 
 
@@ -109,10 +150,21 @@ public:
 		return FILE;
 	}
 
+	/** Move the archive to the logical read position before writing, buffered data is stale afterwards */
+	TSharedPtr <FArchive> GetFArchiveForWrite()
+	{
+		if (FILE.IsValid() && ReadBufferPos < ReadBuffer.Num())
+		{
+			FILE->Seek(this->Tell());
+		}
+		this->DiscardReadBuffer();
+		return FILE;
+	}
+
 
 	bool IsReadable()
 	{
-		return (this->FILE.IsValid() && (false == this->bWirte || this->Flags & FILEWRITE_AllowRead));
+		return MappedRegion.IsValid() || (this->FILE.IsValid() && (false == this->bWirte || this->Flags & FILEWRITE_AllowRead));
 	}
 
 
@@ -123,80 +175,179 @@ public:
 
 
 	//////////FUNCTIONS FOR LUA LIB//////////////////////
-		/**
-	 *
-	 @param Size is Size is Zero Means Read All From Current Offset,else means read SizeBytes from current Offset
+	int64 Tell()
+	{
+		if (MappedRegion.IsValid())
+		{
+			return MappedPos;
+		}
+		//the archive is ahead of the logical position by what is left in the read buffer
+		return FILE->Tell() - (ReadBuffer.Num() - ReadBufferPos);
+	}
+
+	bool AtEnd()
+	{
+		if (MappedRegion.IsValid())
+		{
+			return MappedPos >= (int64)MappedRegion->GetMappedSize();
+		}
+		return ReadBufferPos >= ReadBuffer.Num() && FILE->AtEnd();
+	}
+
+	/**
+	 * Get the bytes readable at the current position without copying, refilling the read buffer if it is empty.
+	 @return number of bytes available in OutData, zero at the end of file
 	 */
-	FORCEINLINE  int ReadSize(TArray<uint8>& Buffer, uint32 Size = 0)
+	FORCEINLINE int64 Peek(const uint8*& OutData)
 	{
-		TArray<uint8> DataBuffer;
-		static const int64 DataBufferSize = 10 * 1024;
-		//when file is valid and is read mode or FILEWRITE_AllowRead flag is set
-		if (this->IsReadable())
-		{
-			DataBuffer.AddUninitialized(DataBufferSize);//10K
-			//get file size
-			int64 FileSize = FILE->TotalSize();
-			//get current offset
-			int64 CurPos = FILE->Tell();
-			//compute readable target size(size left to be read from current offset)
-			int64 TargetSize = FileSize - CurPos;
-			int64 ReadSize = 0;
-			if (0 < Size)
+		if (MappedRegion.IsValid())
+		{
+			OutData = MappedRegion->GetMappedPtr() + MappedPos;
+			return MappedRegion->GetMappedSize() - MappedPos;
+		}
+
+		if (ReadBufferPos >= ReadBuffer.Num())
+		{
+			static const int64 ReadBlockSize = 64 * 1024;
+			const int64 BlockSize = FMath::Min(ReadBlockSize, FILE->TotalSize() - FILE->Tell());
+			ReadBuffer.SetNumUninitialized(FMath::Max(BlockSize, (int64)0), false);
+			ReadBufferPos = 0;
+			if (BlockSize > 0)
 			{
-				TargetSize = FMath::Min(TargetSize, (int64)Size);
+				FILE->Serialize(ReadBuffer.GetData(), BlockSize);
 			}
-			while (TargetSize)
+		}
+		OutData = ReadBuffer.GetData() + ReadBufferPos;
+		return ReadBuffer.Num() - ReadBufferPos;
+	}
+
+	FORCEINLINE void Consume(int64 Size)
+	{
+		if (MappedRegion.IsValid())
+		{
+			MappedPos += Size;
+		}
+		else
+		{
+			ReadBufferPos += Size;
+		}
+	}
+
+	/**
+	 * Read Size bytes into Dest
+	 @return number of bytes actually read
+	 */
+	int64 ReadRaw(void* Dest, int64 Size)
+	{
+		int64 Read = 0;
+		while (Read < Size)
+		{
+			const uint8* Data;
+			const int64 Available = this->Peek(Data);
+			if (0 >= Available)
 			{
-				CurPos = FILE->Tell();
-				FILE->Serialize(DataBuffer.GetData(), FMath::Min(TargetSize, DataBufferSize));
-				ReadSize = FILE->Tell() - CurPos;
-				TargetSize -= ReadSize;
-				Buffer.Append(DataBuffer.GetData(), ReadSize);
+				break;
 			}
+			const int64 Count = FMath::Min(Available, Size - Read);
+			FMemory::Memcpy((uint8*)Dest + Read, Data, Count);
+			this->Consume(Count);
+			Read += Count;
 		}
-		return Buffer.Num();
+		return Read;
+	}
+
+	/**
+	 *
+	 @param Size is Size is Zero Means Read All From Current Offset,else means read SizeBytes from current Offset
+	 @return number of bytes pushed as a lua string, nothing is pushed when zero
+	 */
+	FORCEINLINE int64 PushSize(lua_State *L, int64 Size = 0)
+	{
+		//when file is valid and is read mode or FILEWRITE_AllowRead flag is set
+		if (!this->IsReadable())
+		{
+			return 0;
+		}
+
+		//compute readable target size(size left to be read from current offset)
+		int64 TargetSize = this->TotalSize() - this->Tell();
+		if (0 < Size)
+		{
+			TargetSize = FMath::Min(TargetSize, Size);
+		}
+		if (0 >= TargetSize)
+		{
+			return 0;
+		}
+
+		const uint8* Data;
+		if (this->Peek(Data) >= TargetSize)
+		{
+			//mapped or already buffered, no intermediate copy
+			lua_pushlstring(L, (const char*)Data, TargetSize);
+			this->Consume(TargetSize);
+			return TargetSize;
+		}
+
+		//read straight into the lua buffer
+		luaL_Buffer Buffer;
+		char* Dest = luaL_buffinitsize(L, &Buffer, TargetSize);
+		const int64 ReadSize = this->ReadRaw(Dest, TargetSize);
+		luaL_pushresultsize(&Buffer, ReadSize);
+		return ReadSize;
 	}
 
 	//ReadLine
 	FORCEINLINE void ReadLine(lua_State *L, bool bWithNewLineCh = false)
 	{
-		if (FILE->AtEnd())
+		if (this->AtEnd())
 		{
 			lua_pushnil(L);
+			return;
 		}
-		else
+
+		const uint8* Data;
+		int64 Available = this->Peek(Data);
+		const uint8* NewLine = (const uint8*)FMemory::Memchr(Data, '\n', Available);
+		if (NewLine)
+		{
+			//the whole line is in the buffer
+			const int64 LineSize = NewLine - Data;
+			lua_pushlstring(L, (const char*)Data, bWithNewLineCh ? LineSize + 1 : LineSize);
+			this->Consume(LineSize + 1);
+			return;
+		}
+
+		luaL_Buffer Buffer;
+		luaL_buffinit(L, &Buffer);
+		while (0 < Available)
 		{
-			TArray<uint8> Buffer;
-			uint8 Ch;
-			while (!FILE->AtEnd())
+			NewLine = (const uint8*)FMemory::Memchr(Data, '\n', Available);
+			if (NewLine)
 			{
-				FILE->SerializeBits(&Ch, sizeof(uint8) * 8);
-				if (Ch == '\n')
-				{
-					if (bWithNewLineCh)
-					{
-						Buffer.Add(Ch);
-					}
-					break;
-				}
-				Buffer.Add(Ch);
+				const int64 LineSize = NewLine - Data;
+				luaL_addlstring(&Buffer, (const char*)Data, bWithNewLineCh ? LineSize + 1 : LineSize);
+				this->Consume(LineSize + 1);
+				break;
 			}
-			lua_pushlstring(L, (const char*)Buffer.GetData(), Buffer.Num());
+			luaL_addlstring(&Buffer, (const char*)Data, Available);
+			this->Consume(Available);
+			Available = this->Peek(Data);
 		}
+		luaL_pushresult(&Buffer);
 	}
 
 
 	FORCEINLINE  void ReadNumber(lua_State *L)
 	{
-		if (FILE->AtEnd())
+		if (this->AtEnd())
 		{
 			lua_pushnumber(L, 0);
 		}
 		else
 		{
 			lua_Number Number = 0;
-			FILE->SerializeBits(&Number, sizeof(lua_Number) * 8);
+			this->ReadRaw(&Number, sizeof(lua_Number));
 			lua_Integer IntegerNumber = (lua_Integer)floor((double)Number);
 			if (Number - IntegerNumber > 0)
 			{
@@ -215,7 +366,7 @@ public:
 		if (0 >= TryReadNumber)
 		{
 			//if current is the end of file
-			if (FILE->AtEnd())
+			if (this->AtEnd())
 			{
 				lua_pushnil(L);
 			}
@@ -226,29 +377,45 @@ public:
 		}
 		else
 		{
-			//if current is the end of file
-			if (FILE->AtEnd())
+			//if current is the end of file, or nothing could be read
+			if (this->AtEnd() || 0 >= this->PushSize(L, TryReadNumber))
 			{
 				lua_pushnil(L);
 			}
-			else
-			{
-				//try read number of bytes (string buffer)
-				TArray<uint8> Buffer;
-				int32 ReadNumber = this->ReadSize(Buffer, TryReadNumber);
-				if (0 >= ReadNumber)
-				{
-					lua_pushnil(L);
-				}
-				else
-				{
-					lua_pushlstring(L, (const char*)Buffer.GetData(), ReadNumber);
-				}
-
-			}
 		}
 	}
 private:
+	bool OpenMapped(const FString& InFilePath)
+	{
+		IMappedFileHandle* Handle = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*InFilePath);
+		if (nullptr == Handle)
+		{
+			return false;
+		}
+		MappedHandle.Reset(Handle);
+		if (0 == MappedHandle->GetFileSize())
+		{
+			//empty files can't be mapped
+			MappedHandle.Reset();
+			return false;
+		}
+		IMappedFileRegion* Region = MappedHandle->MapRegion(0, MappedHandle->GetFileSize());
+		if (nullptr == Region)
+		{
+			MappedHandle.Reset();
+			return false;
+		}
+		MappedRegion.Reset(Region);
+		MappedPos = 0;
+		return true;
+	}
+
+	void DiscardReadBuffer()
+	{
+		ReadBuffer.Reset();
+		ReadBufferPos = 0;
+	}
+
 	bool HelperCheckFileMode(const FString& Mode, uint32& OutFlags, bool& OutIsWrite)
 	{
 		bool Ret = false;
@@ -310,6 +477,12 @@ private:
 	}
 
 	TSharedPtr <FArchive> FILE;
+	TArray<uint8> ReadBuffer;
+	int32 ReadBufferPos = 0;
+	//region must be released before the handle
+	TUniquePtr<IMappedFileHandle> MappedHandle;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	int64 MappedPos = 0;
 	bool bWirte;
 	uint32 Flags;
 	FString FilePath;
@@ -327,22 +500,17 @@ static int32 UE4File_ReadFile(lua_State *L)
 		return 0;
 	}
 
-	TSharedPtr<FArchive> fileArchive = File->GetFArchive();
 	if (nargs < 1)
 	{
 		//read line
-		TArray<uint8> Buffer;
-		uint8 Ch;
-		while (!fileArchive->AtEnd())
+		if (File->AtEnd())
 		{
-			fileArchive->SerializeBits(&Ch, sizeof(uint8) * 8);
-			if (Ch == '\n')
-			{
-				break;
-			}
-			Buffer.Add(Ch);
+			lua_pushliteral(L, "");
+		}
+		else
+		{
+			File->ReadLine(L, false);
 		}
-		lua_pushlstring(L, (const char*)Buffer.GetData(), Buffer.Num());
 		return 1;
 	}
 	else
@@ -377,16 +545,10 @@ static int32 UE4File_ReadFile(lua_State *L)
 				}
 				case 'a':
 				{
-					TArray<uint8> Buffer;
-					int32 ReadNumber = File->ReadSize(Buffer);
-					if (0 >= ReadNumber)
+					if (0 >= File->PushSize(L))
 					{
 						lua_pushliteral(L, "");
 					}
-					else
-					{
-						lua_pushlstring(L, (const char*)Buffer.GetData(), ReadNumber);
-					}
 					break;
 				}
 				default:
@@ -420,7 +582,7 @@ static int32 UE4File_WriteFile(lua_State *L)
 	{
 		return 0;
 	}
-	TSharedPtr<FArchive> fileArchive = File->GetFArchive();
+	TSharedPtr<FArchive> fileArchive = File->GetFArchiveForWrite();
 	for (; nargs--; arg++)
 	{
 		if (lua_type(L, arg) == LUA_TNUMBER)
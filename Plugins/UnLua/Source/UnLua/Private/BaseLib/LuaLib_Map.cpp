@@ -286,7 +286,7 @@ static int32 TMap_Delete(lua_State* L)
         return 0;
 
     auto Registry = UnLua::FLuaEnv::FindEnvChecked(L).GetContainerRegistry();
-    Registry->Remove(Map);
+    Registry->Remove(L, 1, Map);
 
     Map->~FLuaMap();
     return 0;
@@ -13,26 +13,17 @@
 // See the License for the specific language governing permissions and limitations under the License.
 
 #include "Engine/World.h"
+#include "Engine/StreamableManager.h"
 #include "LowLevel.h"
 #include "UnLuaEx.h"
 #include "LuaCore.h"
+#include "BaseLib/LuaLib_Object.h"
 
 /**
- * Load an object. for example: UObject.Load("/Game/Core/Blueprints/AI/BehaviorTree_Enemy.BehaviorTree_Enemy")
- * @see LoadObject(...)
+ * Append the asset name to a package path, "/Game/Foo" -> "/Game/Foo.Foo"
  */
-int32 UObject_Load(lua_State* L)
+static void AppendAssetName(FString& ObjectPath)
 {
-    int32 NumParams = lua_gettop(L);
-    if (NumParams != 1)
-        return luaL_error(L, "invalid parameters");
-
-    const char* ObjectName = lua_tostring(L, 1);
-    if (!ObjectName)
-        return luaL_error(L, "invalid class name");
-
-    FString ObjectPath = UTF8_TO_TCHAR(ObjectName);
-
     int32 Index = INDEX_NONE;
     ObjectPath.FindChar(TCHAR('.'), Index);
     if (Index == INDEX_NONE)
@@ -45,6 +36,24 @@ int32 UObject_Load(lua_State* L)
             ObjectPath += Name;
         }
     }
+}
+
+/**
+ * Load an object. for example: UObject.Load("/Game/Core/Blueprints/AI/BehaviorTree_Enemy.BehaviorTree_Enemy")
+ * @see LoadObject(...)
+ */
+int32 UObject_Load(lua_State* L)
+{
+    int32 NumParams = lua_gettop(L);
+    if (NumParams != 1)
+        return luaL_error(L, "invalid parameters");
+
+    const char* ObjectName = lua_tostring(L, 1);
+    if (!ObjectName)
+        return luaL_error(L, "invalid class name");
+
+    FString ObjectPath = UTF8_TO_TCHAR(ObjectName);
+    AppendAssetName(ObjectPath);
 
     UObject* Object = LoadObject<UObject>(nullptr, *ObjectPath);
     if (Object)
@@ -69,6 +78,281 @@ int32 UObject_Load(lua_State* L)
     return 1;
 }
 
+struct FLoadAsyncState
+{
+    lua_State* MainState = nullptr;
+    TArray<FSoftObjectPath> Paths;
+    int32 Flags = 0;
+    int32 ThreadRef = LUA_NOREF;
+    int32 FunctionRef = LUA_NOREF;
+    bool bCompleted = false;
+};
+
+static FStreamableManager& GetStreamableManager()
+{
+    static FStreamableManager StreamableManager;
+    return StreamableManager;
+}
+
+/**
+ * In-flight requests of each env, cancelled when the env is destroyed so that no callback reaches a closed lua state
+ */
+static TMap<lua_State*, TArray<TSharedPtr<FStreamableHandle>>>& GetPendingLoads()
+{
+    static TMap<lua_State*, TArray<TSharedPtr<FStreamableHandle>>> PendingLoads;
+    static bool bInitialized = false;
+    if (!bInitialized)
+    {
+        bInitialized = true;
+        UnLua::FLuaEnv::OnDestroyed.AddLambda([](UnLua::FLuaEnv& Env)
+        {
+            TArray<TSharedPtr<FStreamableHandle>> Handles;
+            if (!GetPendingLoads().RemoveAndCopyValue(Env.GetMainState(), Handles))
+                return;
+            for (const auto& Handle : Handles)
+                Handle->CancelHandle();
+        });
+    }
+    return PendingLoads;
+}
+
+/**
+ * Get the object path of a string, FSoftObjectPtr or FSoftObjectPath value
+ */
+static bool GetSoftObjectPath(lua_State* L, int32 Index, FSoftObjectPath& OutPath)
+{
+    const int32 Type = lua_type(L, Index);
+    if (Type == LUA_TSTRING)
+    {
+        FString ObjectPath = UTF8_TO_TCHAR(lua_tostring(L, Index));
+        AppendAssetName(ObjectPath);
+        OutPath = ObjectPath;
+        return true;
+    }
+
+    if (Type != LUA_TUSERDATA || luaL_getmetafield(L, Index, "__name") == LUA_TNIL)
+        return false;
+    const FString TypeName = UTF8_TO_TCHAR(lua_tostring(L, -1));
+    lua_pop(L, 1);
+
+    const void* Value = GetCppInstanceFast(L, Index);
+    if (!Value)
+        return false;
+
+    if (TypeName == TEXT("FSoftObjectPtr"))
+    {
+        OutPath = ((const FSoftObjectPtr*)Value)->ToSoftObjectPath();
+        return true;
+    }
+
+    if (TypeName == TEXT("FSoftObjectPath") || TypeName == TEXT("FSoftClassPath"))
+    {
+        OutPath = *(const FSoftObjectPath*)Value;
+        return true;
+    }
+    return false;
+}
+
+static void PushLoadedObject(lua_State* L, const FSoftObjectPath& Path, bool bClass)
+{
+    UObject* Object = Path.ResolveObject();
+    if (!Object || (bClass && !Object->IsA<UClass>()))
+    {
+        lua_pushnil(L);
+        return;
+    }
+
+    auto& Env = UnLua::FLuaEnv::FindEnvChecked(L);
+    if (const auto Enum = Cast<UEnum>(Object))
+    {
+        const auto EnumDesc = Env.GetEnumRegistry()->Register(Enum);
+        int32 Type = luaL_getmetatable(L, TCHAR_TO_UTF8(*EnumDesc->GetName()));
+        check(Type == LUA_TTABLE);
+        return;
+    }
+
+    if (const auto Class = Cast<UClass>(Object))
+    {
+        if (!Env.GetClassRegistry()->Register(Class))
+        {
+            lua_pushnil(L);
+            return;
+        }
+    }
+
+    UnLua::PushUObject(L, Object);
+}
+
+static void PushLoadResults(lua_State* L, const TArray<FSoftObjectPath>& Paths, int32 Flags)
+{
+    const bool bClass = !!(Flags & LoadAsync_Class);
+    if (!(Flags & LoadAsync_Batch))
+    {
+        PushLoadedObject(L, Paths[0], bClass);
+        return;
+    }
+
+    lua_createtable(L, Paths.Num(), 0);
+    for (int32 i = 0; i < Paths.Num(); ++i)
+    {
+        PushLoadedObject(L, Paths[i], bClass);
+        lua_rawseti(L, -2, i + 1);
+    }
+}
+
+/**
+ * Continuation of a coroutine suspended by LoadAsync, the normalized paths were left at the bottom of its stack
+ */
+static int32 UObject_LoadAsyncContinue(lua_State* L, int32 Status, lua_KContext Context)
+{
+    const int32 NumPaths = (int32)(Context >> 8);
+    TArray<FSoftObjectPath> Paths;
+    Paths.Reserve(NumPaths);
+    for (int32 i = 1; i <= NumPaths; ++i)
+        Paths.Emplace(UTF8_TO_TCHAR(lua_tostring(L, i)));
+
+    PushLoadResults(L, Paths, (int32)(Context & 0xff));
+    return 1;
+}
+
+static void OnLoadAsyncCompleted(const TSharedRef<FLoadAsyncState>& State)
+{
+    State->bCompleted = true;
+    auto Env = UnLua::FLuaEnv::FindEnv(State->MainState);
+    if (!Env)
+        return;
+
+    if (State->ThreadRef != LUA_NOREF)
+    {
+        Env->ResumeThread(State->ThreadRef);
+        return;
+    }
+
+    if (State->FunctionRef == LUA_NOREF)
+        return;
+
+    lua_State* L = State->MainState;
+    const int32 Top = lua_gettop(L);
+    lua_pushcfunction(L, UnLua::ReportLuaCallError);
+    lua_rawgeti(L, LUA_REGISTRYINDEX, State->FunctionRef);
+    luaL_unref(L, LUA_REGISTRYINDEX, State->FunctionRef);
+    State->FunctionRef = LUA_NOREF;
+    PushLoadResults(L, State->Paths, State->Flags);
+    lua_pcall(L, 1, 0, Top + 1);
+    lua_settop(L, Top);
+}
+
+/**
+ * Request the paths through the streamable manager. With a callback at CallbackIndex the results are passed to it
+ * and nothing is returned, otherwise the running coroutine is suspended until all paths are loaded. Paths that are
+ * already in memory are returned without yielding.
+ */
+int32 UObject_LoadAsyncPaths(lua_State* L, TArray<FSoftObjectPath>&& Paths, int32 CallbackIndex, int32 Flags)
+{
+    const bool bHasCallback = !lua_isnoneornil(L, CallbackIndex);
+    if (bHasCallback)
+        luaL_checktype(L, CallbackIndex, LUA_TFUNCTION);
+    else if (!lua_isyieldable(L))
+        return luaL_error(L, "LoadAsync must be called in a coroutine or with a callback");
+
+    TArray<FSoftObjectPath> PathsToLoad;
+    for (const auto& Path : Paths)
+    {
+        if (Path.IsValid() && !Path.ResolveObject())
+            PathsToLoad.AddUnique(Path);
+    }
+
+    auto& Env = UnLua::FLuaEnv::FindEnvChecked(L);
+    const auto State = MakeShared<FLoadAsyncState>();
+    State->MainState = Env.GetMainState();
+    State->Flags = Flags;
+    if (bHasCallback)
+    {
+        lua_pushvalue(L, CallbackIndex);
+        State->FunctionRef = luaL_ref(L, LUA_REGISTRYINDEX);
+        State->Paths = Paths;
+    }
+
+    TSharedPtr<FStreamableHandle> Handle;
+    if (PathsToLoad.Num() > 0)
+        Handle = GetStreamableManager().RequestAsyncLoad(MoveTemp(PathsToLoad), FStreamableDelegate::CreateLambda([State] { OnLoadAsyncCompleted(State); }));
+
+    if (!Handle.IsValid() || State->bCompleted)
+    {
+        // nothing to wait for, or the delegate has already run
+        if (!bHasCallback)
+        {
+            PushLoadResults(L, Paths, Flags);
+            return 1;
+        }
+        if (!State->bCompleted)
+            OnLoadAsyncCompleted(State);
+        return 0;
+    }
+
+    auto& Handles = GetPendingLoads().FindOrAdd(State->MainState);
+    Handles.RemoveAllSwap([](const TSharedPtr<FStreamableHandle>& Pending) { return !Pending->IsLoadingInProgress(); });
+    Handles.Add(Handle);
+    if (bHasCallback)
+        return 0;
+
+    lua_settop(L, 0);
+    for (const auto& Path : Paths)
+        lua_pushstring(L, TCHAR_TO_UTF8(*Path.ToString()));
+    State->ThreadRef = Env.FindOrAddThread(L);
+    return lua_yieldk(L, 0, (lua_KContext)Flags | ((lua_KContext)Paths.Num() << 8), UObject_LoadAsyncContinue);
+}
+
+/**
+ * Load an object asynchronously, by path, FSoftObjectPtr or FSoftObjectPath. for example:
+ *   local Mesh = UObject.LoadAsync("/Game/Weapons/Rifle/SM_Rifle") -- in a coroutine
+ *   UObject.LoadAsync("/Game/Weapons/Rifle/SM_Rifle", function(Mesh) end)
+ */
+static int32 UObject_LoadAsync(lua_State* L)
+{
+    const int32 NumParams = lua_gettop(L);
+    if (NumParams < 1 || NumParams > 2)
+        return luaL_error(L, "invalid parameters");
+
+    TArray<FSoftObjectPath> Paths;
+    if (!GetSoftObjectPath(L, 1, Paths.AddDefaulted_GetRef()))
+        return luaL_error(L, "invalid object path");
+
+    return UObject_LoadAsyncPaths(L, MoveTemp(Paths), 2, 0);
+}
+
+/**
+ * Load a list of objects in parallel, the results keep the order of the paths with nil for failed loads. for example:
+ *   local Assets = UObject.LoadAsyncBatch({"/Game/FX/P_Hit", SoftObjectPtr}) -- in a coroutine
+ */
+static int32 UObject_LoadAsyncBatch(lua_State* L)
+{
+    const int32 NumParams = lua_gettop(L);
+    if (NumParams < 1 || NumParams > 2)
+        return luaL_error(L, "invalid parameters");
+
+    luaL_checktype(L, 1, LUA_TTABLE);
+
+    TArray<FSoftObjectPath> Paths;
+    const lua_Integer NumPaths = luaL_len(L, 1);
+    Paths.Reserve(NumPaths);
+    for (lua_Integer i = 1; i <= NumPaths; ++i)
+    {
+        lua_rawgeti(L, 1, i);
+        if (!GetSoftObjectPath(L, -1, Paths.AddDefaulted_GetRef()))
+            return luaL_error(L, "invalid object path at index %d", (int)i);
+        lua_pop(L, 1);
+    }
+
+    if (Paths.Num() == 0)
+    {
+        lua_newtable(L);
+        return 1;
+    }
+
+    return UObject_LoadAsyncPaths(L, MoveTemp(Paths), 2, LoadAsync_Batch);
+}
+
 /**
  * Test validity of an object
  */
@@ -251,7 +535,7 @@ int32 UObject_Delete(lua_State* L)
     if (UnLua::LowLevel::IsReleasedPtr(Object))
         return 0;
 
-    UnLua::FLuaEnv::FindEnvChecked(L).GetObjectRegistry()->NotifyUObjectLuaGC(Object);
+    UnLua::FLuaEnv::FindEnvChecked(L).GetObjectRegistry()->NotifyUObjectLuaGC(L, Object, 1);
     return 0;
 }
 
@@ -261,6 +545,8 @@ int32 UObject_Delete(lua_State* L)
 static const luaL_Reg UObjectLib[] =
 {
     {"Load", UObject_Load},
+    {"LoadAsync", UObject_LoadAsync},
+    {"LoadAsyncBatch", UObject_LoadAsyncBatch},
     {"IsValid", UObject_IsValid},
     {"GetName", UObject_GetName},
     {"GetOuter", UObject_GetOuter},
@@ -0,0 +1,27 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#pragma once
+
+#include "lua.hpp"
+#include "UObject/SoftObjectPath.h"
+
+enum ELoadAsyncFlags
+{
+    LoadAsync_Batch = 1,
+    LoadAsync_Class = 2,
+};
+
+int32 UObject_LoadAsyncPaths(lua_State* L, TArray<FSoftObjectPath>&& Paths, int32 CallbackIndex, int32 Flags);
@@ -164,7 +164,7 @@ static int32 TSet_Delete(lua_State* L)
         return 0;
 
     auto Registry = UnLua::FLuaEnv::FindEnvChecked(L).GetContainerRegistry();
-    Registry->Remove(Set);
+    Registry->Remove(L, 1, Set);
 
     Set->~FLuaSet();
     return 0;
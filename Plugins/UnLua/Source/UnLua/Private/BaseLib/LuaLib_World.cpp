@@ -15,6 +15,8 @@
 #include "UnLuaEx.h"
 #include "LuaCore.h"
 #include "LuaDynamicBinding.h"
+#include "LuaActorPool.h"
+#include "LuaEnv.h"
 #include "Engine/World.h"
 
 /**
@@ -161,6 +163,188 @@ static int32 UWorld_SpawnActorEx(lua_State* L)
     return 1;
 }
 
+static void PushActorPoolStats(lua_State* L, const UnLua::FLuaActorPool::FStats& Stats)
+{
+    lua_createtable(L, 0, 6);
+    lua_pushinteger(L, Stats.Hits);
+    lua_setfield(L, -2, "Hits");
+    lua_pushinteger(L, Stats.Misses);
+    lua_setfield(L, -2, "Misses");
+    lua_pushinteger(L, Stats.Releases);
+    lua_setfield(L, -2, "Releases");
+    lua_pushinteger(L, Stats.Prewarmed);
+    lua_setfield(L, -2, "Prewarmed");
+    lua_pushnumber(L, Stats.SpawnSeconds);
+    lua_setfield(L, -2, "SpawnSeconds");
+    lua_pushnumber(L, Stats.SavedSeconds);
+    lua_setfield(L, -2, "SavedSeconds");
+}
+
+/**
+ * Acquire an actor from the pool, or spawn a new one if the pool is empty.
+ * World:AcquireActor(
+ *  ProjectileClass, InitialTransform, InitializerTable, "Weapon.Projectile_C", ActorSpawnParameters
+ * )
+ * actors are pooled per module, the module defaults to the one the class is bound to. the initializer
+ * table and spawn parameters are only used when a new actor is spawned, reused actors get their
+ * "OnAcquireFromPool" Lua function called instead.
+ */
+static int32 UWorld_AcquireActor(lua_State* L)
+{
+    int32 NumParams = lua_gettop(L);
+    if (NumParams < 2)
+        return luaL_error(L, "invalid parameters");
+
+    UWorld* World = Cast<UWorld>(UnLua::GetUObject(L, 1));
+    if (!World)
+        return luaL_error(L, "invalid world");
+
+    UClass* Class = Cast<UClass>(UnLua::GetUObject(L, 2));
+    if (!Class || !Class->IsChildOf(AActor::StaticClass()))
+        return luaL_error(L, "invalid actor class");
+
+    FTransform Transform;
+    if (NumParams > 2)
+    {
+        FTransform* TransformPtr = (FTransform*)GetCppInstanceFast(L, 3);
+        if (TransformPtr)
+        {
+            Transform = *TransformPtr;
+        }
+    }
+
+    const FString ModuleName = NumParams > 4 ? UTF8_TO_TCHAR(lua_tostring(L, 5)) : FString();
+    UnLua::FLuaActorPool& Pool = UnLua::FLuaEnv::FindEnvChecked(L).GetActorPool();
+    if (AActor* Actor = Pool.Acquire(L, World, Class, ModuleName, Transform))
+    {
+        UnLua::PushUObject(L, Actor);
+        return 1;
+    }
+
+    int32 TableRef = LUA_NOREF;
+    if (NumParams > 3 && lua_type(L, 4) == LUA_TTABLE)
+    {
+        lua_pushvalue(L, 4);
+        TableRef = luaL_ref(L, LUA_REGISTRYINDEX);
+    }
+    FActorSpawnParameters SpawnParameters;
+    if (NumParams > 5)
+    {
+        FActorSpawnParameters* ActorSpawnParametersPtr = (FActorSpawnParameters*)GetCppInstanceFast(L, 6);
+        if (ActorSpawnParametersPtr)
+        {
+            SpawnParameters = *ActorSpawnParametersPtr;
+        }
+    }
+    UnLua::PushUObject(L, Pool.Spawn(L, World, Class, ModuleName, TableRef, Transform, SpawnParameters));
+    return 1;
+}
+
+/**
+ * Return an actor to the pool. Its "OnReleaseToPool" Lua function is called to reset state, then
+ * it is hidden with collision and actor/component tick disabled until acquired again, when they are
+ * restored to what they were on release.
+ * World:ReleaseActor(Projectile)
+ */
+static int32 UWorld_ReleaseActor(lua_State* L)
+{
+    int32 NumParams = lua_gettop(L);
+    if (NumParams != 2)
+        return luaL_error(L, "invalid parameters");
+
+    UWorld* World = Cast<UWorld>(UnLua::GetUObject(L, 1));
+    if (!World)
+        return luaL_error(L, "invalid world");
+
+    AActor* Actor = Cast<AActor>(UnLua::GetUObject(L, 2));
+    if (!Actor || Actor->GetWorld() != World || Actor->IsPendingKillPending())
+        return luaL_error(L, "invalid actor");
+
+    UnLua::FLuaEnv::FindEnvChecked(L).GetActorPool().Release(L, Actor);
+    return 0;
+}
+
+/**
+ * Spawn actors into the pool ahead of time, they are counted as Prewarmed instead of Misses.
+ * World:PrewarmActors(ProjectileClass, 32, InitializerTable, "Weapon.Projectile_C")
+ */
+static int32 UWorld_PrewarmActors(lua_State* L)
+{
+    int32 NumParams = lua_gettop(L);
+    if (NumParams < 3)
+        return luaL_error(L, "invalid parameters");
+
+    UWorld* World = Cast<UWorld>(UnLua::GetUObject(L, 1));
+    if (!World)
+        return luaL_error(L, "invalid world");
+
+    UClass* Class = Cast<UClass>(UnLua::GetUObject(L, 2));
+    if (!Class || !Class->IsChildOf(AActor::StaticClass()))
+        return luaL_error(L, "invalid actor class");
+
+    const lua_Integer Count = luaL_checkinteger(L, 3);
+    if (Count < 1)
+        return luaL_error(L, "invalid count");
+
+    const FString ModuleName = NumParams > 4 ? UTF8_TO_TCHAR(lua_tostring(L, 5)) : FString();
+    const FTransform Transform;
+    const FActorSpawnParameters SpawnParameters;
+    UnLua::FLuaActorPool& Pool = UnLua::FLuaEnv::FindEnvChecked(L).GetActorPool();
+    for (lua_Integer i = 0; i < Count; ++i)
+    {
+        int32 TableRef = LUA_NOREF;
+        if (NumParams > 3 && lua_type(L, 4) == LUA_TTABLE)
+        {
+            lua_pushvalue(L, 4);
+            TableRef = luaL_ref(L, LUA_REGISTRYINDEX);
+        }
+        AActor* Actor = Pool.Spawn(L, World, Class, ModuleName, TableRef, Transform, SpawnParameters, true);
+        if (Actor)
+            Pool.Release(L, Actor);
+    }
+    return 0;
+}
+
+/**
+ * Destroy all pooled actors of a class, or of every class if none is given.
+ * World:ClearActorPool(ProjectileClass)
+ */
+static int32 UWorld_ClearActorPool(lua_State* L)
+{
+    int32 NumParams = lua_gettop(L);
+    if (NumParams < 1)
+        return luaL_error(L, "invalid parameters");
+
+    UWorld* World = Cast<UWorld>(UnLua::GetUObject(L, 1));
+    if (!World)
+        return luaL_error(L, "invalid world");
+
+    UClass* Class = NumParams > 1 ? Cast<UClass>(UnLua::GetUObject(L, 2)) : nullptr;
+    UnLua::FLuaEnv::FindEnvChecked(L).GetActorPool().Clear(World, Class);
+    return 0;
+}
+
+/**
+ * Get the actor pool metrics of the Lua env, or of one class if given: Hits, Misses, Releases,
+ * Prewarmed, SpawnSeconds (total time spent spawning on misses) and SavedSeconds (average spawn
+ * time multiplied by hits).
+ * World:GetActorPoolStats(ProjectileClass)
+ */
+static int32 UWorld_GetActorPoolStats(lua_State* L)
+{
+    const UnLua::FLuaActorPool& Pool = UnLua::FLuaEnv::FindEnvChecked(L).GetActorPool();
+    UClass* Class = lua_gettop(L) > 1 ? Cast<UClass>(UnLua::GetUObject(L, 2)) : nullptr;
+    if (!Class)
+    {
+        PushActorPoolStats(L, Pool.GetStats());
+        return 1;
+    }
+
+    const UnLua::FLuaActorPool::FStats* Stats = Pool.FindStats(Class);
+    PushActorPoolStats(L, Stats ? *Stats : UnLua::FLuaActorPool::FStats());
+    return 1;
+}
+
 DEFINE_TYPE(ESpawnActorCollisionHandlingMethod)
 
 DEFINE_TYPE(EObjectFlags)
@@ -202,6 +386,11 @@ static const luaL_Reg UWorldLib[] =
 {
     {"SpawnActor", UWorld_SpawnActor},
     {"SpawnActorEx", UWorld_SpawnActorEx},
+    {"AcquireActor", UWorld_AcquireActor},
+    {"ReleaseActor", UWorld_ReleaseActor},
+    {"PrewarmActors", UWorld_PrewarmActors},
+    {"ClearActorPool", UWorld_ClearActorPool},
+    {"GetActorPoolStats", UWorld_GetActorPoolStats},
     {nullptr, nullptr}
 };
 
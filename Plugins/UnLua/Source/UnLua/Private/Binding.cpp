@@ -19,6 +19,7 @@ namespace UnLua
     struct FExported
     {
         TArray<IExportedEnum*> Enums;
+        TMap<FString, IExportedEnum*> NamedEnums;
         TArray<IExportedFunction*> Functions;
         TMap<FString, IExportedClass*> ReflectedClasses;
         TMap<FString, IExportedClass*> NonReflectedClasses;
@@ -42,6 +43,7 @@ namespace UnLua
     void ExportEnum(IExportedEnum* Enum)
     {
         GetExported()->Enums.Add(Enum);
+        GetExported()->NamedEnums.Add(Enum->GetName(), Enum);
     }
 
     void ExportFunction(IExportedFunction* Function)
@@ -99,6 +101,11 @@ namespace UnLua
         return Class;
     }
 
+    IExportedEnum* FindExportedEnum(FString Name)
+    {
+        return GetExported()->NamedEnums.FindRef(Name);
+    }
+
     TSharedPtr<ITypeInterface> FindTypeInterface(FString Name)
     {
         return GetExported()->Types.FindRef(Name);
@@ -0,0 +1,136 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#include "HotReloadWatcher.h"
+
+#if UNLUA_WITH_FILE_WATCHER
+
+#include "DirectoryWatcherModule.h"
+#include "IDirectoryWatcher.h"
+#include "UnLuaBase.h"
+#include "UnLuaFunctionLibrary.h"
+#include "UnLuaModule.h"
+#include "UnLuaSettings.h"
+
+namespace UnLua
+{
+    FHotReloadWatcher& FHotReloadWatcher::Get()
+    {
+        static FHotReloadWatcher Instance;
+        return Instance;
+    }
+
+    void FHotReloadWatcher::Start()
+    {
+        if (IsRunning())
+            return;
+
+        auto& DirectoryWatcherModule = FModuleManager::LoadModuleChecked<FDirectoryWatcherModule>("DirectoryWatcher");
+        IDirectoryWatcher* DirectoryWatcher = DirectoryWatcherModule.Get();
+        if (!DirectoryWatcher)
+            return;
+
+        ScriptRootPath = UUnLuaFunctionLibrary::GetScriptRootPath();
+        const auto Delegate = IDirectoryWatcher::FDirectoryChanged::CreateRaw(this, &FHotReloadWatcher::OnDirectoryChanged);
+        if (!DirectoryWatcher->RegisterDirectoryChangedCallback_Handle(ScriptRootPath, Delegate, DirectoryWatcherHandle))
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("failed to watch script directory %s, hot reload falls back to polling."), *ScriptRootPath);
+            DirectoryWatcherHandle.Reset();
+            return;
+        }
+
+        TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FHotReloadWatcher::Tick));
+    }
+
+    void FHotReloadWatcher::Stop()
+    {
+        if (!IsRunning())
+            return;
+
+        if (const auto DirectoryWatcherModule = FModuleManager::GetModulePtr<FDirectoryWatcherModule>("DirectoryWatcher"))
+        {
+            if (IDirectoryWatcher* DirectoryWatcher = DirectoryWatcherModule->Get())
+                DirectoryWatcher->UnregisterDirectoryChangedCallback_Handle(ScriptRootPath, DirectoryWatcherHandle);
+        }
+
+        FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+        DirectoryWatcherHandle.Reset();
+        bPendingAutoReload = false;
+    }
+
+    uint64 FHotReloadWatcher::GetModifiedModules(uint64 Since, TArray<FString>& OutModuleNames) const
+    {
+        for (const auto& Pair : ModifiedModules)
+        {
+            if (Pair.Value > Since)
+                OutModuleNames.Add(Pair.Key);
+        }
+        return Serial;
+    }
+
+    void FHotReloadWatcher::OnDirectoryChanged(const TArray<FFileChangeData>& FileChanges)
+    {
+        bool bChanged = false;
+        for (const auto& Change : FileChanges)
+        {
+            if (Change.Action == FFileChangeData::FCA_Removed || FPaths::GetExtension(Change.Filename) != TEXT("lua"))
+                continue;
+
+            FString RelativePath = FPaths::ConvertRelativePathToFull(Change.Filename);
+            if (!FPaths::MakePathRelativeTo(RelativePath, *ScriptRootPath) || RelativePath.StartsWith(TEXT("..")))
+                continue;
+
+            FString ModuleName = FPaths::ChangeExtension(RelativePath, TEXT(""));
+            ModuleName.ReplaceInline(TEXT("/"), TEXT("."));
+            ModifiedModules.Add(MoveTemp(ModuleName), ++Serial);
+            bChanged = true;
+        }
+
+        if (!bChanged)
+            return;
+
+        LastChangeTime = FPlatformTime::Seconds();
+        bPendingAutoReload = true;
+    }
+
+    bool FHotReloadWatcher::Tick(float DeltaTime)
+    {
+#if !WITH_EDITOR
+        // the editor engine ticks the directory watcher, games and servers have to do it themselves
+        if (const auto DirectoryWatcherModule = FModuleManager::GetModulePtr<FDirectoryWatcherModule>("DirectoryWatcher"))
+        {
+            if (IDirectoryWatcher* DirectoryWatcher = DirectoryWatcherModule->Get())
+                DirectoryWatcher->Tick(DeltaTime);
+        }
+#endif
+
+        if (!bPendingAutoReload)
+            return true;
+
+        const auto& Settings = *GetDefault<UUnLuaSettings>();
+        if (!Settings.bAutoHotReload)
+            return true;
+
+        // editors save files in several steps, wait for them to settle before reloading
+        if (FPlatformTime::Seconds() - LastChangeTime < Settings.AutoHotReloadDelay)
+            return true;
+
+        bPendingAutoReload = false;
+        IUnLuaModule::Get().HotReload();
+        return true;
+    }
+}
+
+#endif
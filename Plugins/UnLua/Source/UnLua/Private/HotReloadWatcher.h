@@ -0,0 +1,68 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "UnLuaCompatibility.h"
+
+#if UNLUA_WITH_FILE_WATCHER
+
+struct FFileChangeData;
+
+namespace UnLua
+{
+    /**
+     * Watches the script root directory and keeps track of modified Lua modules, so a hot reload
+     * only needs to look at the modules that actually changed instead of stat'ing every loaded file.
+     */
+    class FHotReloadWatcher
+    {
+    public:
+        static FHotReloadWatcher& Get();
+
+        void Start();
+
+        void Stop();
+
+        bool IsRunning() const { return DirectoryWatcherHandle.IsValid(); }
+
+        /**
+         * Get the modules modified after the given serial.
+         * @return the serial of the latest modification
+         */
+        uint64 GetModifiedModules(uint64 Since, TArray<FString>& OutModuleNames) const;
+
+    private:
+        void OnDirectoryChanged(const TArray<FFileChangeData>& FileChanges);
+
+        bool Tick(float DeltaTime);
+
+        FString ScriptRootPath;
+        FDelegateHandle DirectoryWatcherHandle;
+#if ENGINE_MAJOR_VERSION >= 5
+        FTSTicker::FDelegateHandle TickerHandle;
+#else
+        FDelegateHandle TickerHandle;
+#endif
+        TMap<FString, uint64> ModifiedModules;
+        uint64 Serial = 0;
+        double LastChangeTime = 0;
+        bool bPendingAutoReload = false;
+    };
+}
+
+#endif
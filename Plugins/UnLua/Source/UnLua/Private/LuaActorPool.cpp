@@ -0,0 +1,187 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#include "LuaActorPool.h"
+#include "LuaEnv.h"
+#include "LuaCore.h"
+#include "LuaDynamicBinding.h"
+#include "GameFramework/Actor.h"
+#include "Components/ActorComponent.h"
+
+namespace UnLua
+{
+    static void CallActorPoolHook(lua_State* L, AActor* Actor, const char* HookName)
+    {
+        const int32 FunctionRef = PushFunction(L, Actor, HookName);
+        if (FunctionRef == LUA_NOREF)
+            return;
+        CallFunction(L, 1, 0);
+        luaL_unref(L, LUA_REGISTRYINDEX, FunctionRef);
+    }
+
+    FLuaActorPool::FLuaActorPool(FLuaEnv* InEnv)
+        : Env(InEnv)
+    {
+        OnWorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddRaw(this, &FLuaActorPool::OnWorldCleanup);
+    }
+
+    FLuaActorPool::~FLuaActorPool()
+    {
+        FWorldDelegates::OnWorldCleanup.Remove(OnWorldCleanupHandle);
+    }
+
+    FLuaActorPool::FPoolKey FLuaActorPool::MakeKey(UWorld* World, UClass* Class, const FString& ModuleName) const
+    {
+        // actors released to the pool are keyed by the module their class is bound to
+        return FPoolKey(World, Class, ModuleName.IsEmpty() ? Env->GetManager()->GetBoundModuleName(Class) : ModuleName);
+    }
+
+    AActor* FLuaActorPool::Acquire(lua_State* L, UWorld* World, UClass* Class, const FString& ModuleName, const FTransform& Transform)
+    {
+        TArray<FPooledActor>* Pool = Pools.Find(MakeKey(World, Class, ModuleName));
+        if (!Pool)
+            return nullptr;
+
+        while (Pool->Num() > 0)
+        {
+            const FPooledActor Pooled = Pool->Pop(false);
+            PooledActors.Remove(Pooled.Actor);
+            AActor* Actor = Pooled.Actor.Get();
+            if (!Actor || Actor->IsPendingKillPending())
+                continue;
+
+            Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+            Actor->SetActorHiddenInGame(Pooled.bHidden);
+            Actor->SetActorEnableCollision(Pooled.bCollisionEnabled);
+            Actor->SetActorTickEnabled(Pooled.bTickEnabled);
+            for (const auto& ComponentTick : Pooled.ComponentTicks)
+            {
+                if (UActorComponent* Component = ComponentTick.Key.Get())
+                    Component->SetComponentTickEnabled(ComponentTick.Value);
+            }
+            CallActorPoolHook(L, Actor, "OnAcquireFromPool");
+
+            FStats& ClassStat = ClassStats.FindOrAdd(Class);
+            for (FStats* Target : {&Stats, &ClassStat})
+            {
+                Target->Hits++;
+                if (Target->Misses > 0)
+                    Target->SavedSeconds += Target->SpawnSeconds / Target->Misses;
+            }
+            return Actor;
+        }
+        return nullptr;
+    }
+
+    AActor* FLuaActorPool::Spawn(lua_State* L, UWorld* World, UClass* Class, const FString& ModuleName, int32 TableRef, const FTransform& Transform, const FActorSpawnParameters& SpawnParameters, bool bPrewarm)
+    {
+        const double StartTime = FPlatformTime::Seconds();
+        AActor* NewActor;
+        {
+            FScopedLuaDynamicBinding Binding(L, Class, ModuleName.IsEmpty() ? nullptr : *ModuleName, TableRef);
+            NewActor = World->SpawnActor(Class, &Transform, SpawnParameters);
+        }
+        const double Seconds = FPlatformTime::Seconds() - StartTime;
+        if (NewActor)
+            ActorKeys.Add(NewActor, MakeKey(World, Class, ModuleName));
+
+        FStats& ClassStat = ClassStats.FindOrAdd(Class);
+        for (FStats* Target : {&Stats, &ClassStat})
+        {
+            // prewarmed spawns are paid up front, they are not pool misses
+            if (bPrewarm)
+            {
+                Target->Prewarmed++;
+                continue;
+            }
+            Target->Misses++;
+            Target->SpawnSeconds += Seconds;
+        }
+        return NewActor;
+    }
+
+    bool FLuaActorPool::Release(lua_State* L, AActor* Actor)
+    {
+        if (PooledActors.Contains(Actor))
+            return false;
+
+        CallActorPoolHook(L, Actor, "OnReleaseToPool");
+
+        FPooledActor Pooled;
+        Pooled.Actor = Actor;
+        Pooled.bHidden = Actor->IsHidden();
+        Pooled.bCollisionEnabled = Actor->GetActorEnableCollision();
+        Pooled.bTickEnabled = Actor->IsActorTickEnabled();
+        for (UActorComponent* Component : Actor->GetComponents())
+        {
+            if (!Component)
+                continue;
+            Pooled.ComponentTicks.Emplace(Component, Component->IsComponentTickEnabled());
+            Component->SetComponentTickEnabled(false);
+        }
+
+        Actor->SetActorHiddenInGame(true);
+        Actor->SetActorEnableCollision(false);
+        Actor->SetActorTickEnabled(false);
+
+        // actors spawned for another module than the one of their class go back to their own pool
+        UClass* Class = Actor->GetClass();
+        const FPoolKey* Key = ActorKeys.Find(Actor);
+        Pools.FindOrAdd(Key ? *Key : MakeKey(Actor->GetWorld(), Class, FString())).Add(MoveTemp(Pooled));
+        PooledActors.Add(Actor);
+        Stats.Releases++;
+        ClassStats.FindOrAdd(Class).Releases++;
+        return true;
+    }
+
+    void FLuaActorPool::Clear(UWorld* World, UClass* Class)
+    {
+        const FObjectKey WorldKey(World);
+        const FObjectKey ClassKey(Class);
+        for (auto It = Pools.CreateIterator(); It; ++It)
+        {
+            if (It->Key.Get<0>() != WorldKey || (Class && It->Key.Get<1>() != ClassKey))
+                continue;
+            for (const FPooledActor& Pooled : It->Value)
+            {
+                PooledActors.Remove(Pooled.Actor);
+                ActorKeys.Remove(Pooled.Actor);
+                if (Pooled.Actor.IsValid())
+                    Pooled.Actor->Destroy();
+            }
+            It.RemoveCurrent();
+        }
+    }
+
+    void FLuaActorPool::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+    {
+        const FObjectKey WorldKey(World);
+        for (auto It = Pools.CreateIterator(); It; ++It)
+        {
+            if (It->Key.Get<0>() != WorldKey)
+                continue;
+            for (const FPooledActor& Pooled : It->Value)
+                PooledActors.Remove(Pooled.Actor);
+            It.RemoveCurrent();
+        }
+
+        // also forgets the actors destroyed without being released
+        for (auto It = ActorKeys.CreateIterator(); It; ++It)
+        {
+            if (It->Value.Get<0>() == WorldKey || !It->Key.IsValid())
+                It.RemoveCurrent();
+        }
+    }
+}
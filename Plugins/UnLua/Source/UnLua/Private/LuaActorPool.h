@@ -0,0 +1,93 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/World.h"
+#include "UObject/ObjectKey.h"
+#include "lua.hpp"
+
+class AActor;
+class UActorComponent;
+
+namespace UnLua
+{
+    class FLuaEnv;
+
+    /**
+     * Pools of released actors, per world, class and bound Lua module. Pooled actors keep their Lua instance,
+     * so acquiring one skips both the spawn and the module binding.
+     */
+    class UNLUA_API FLuaActorPool
+    {
+    public:
+        struct FStats
+        {
+            int64 Hits = 0;
+            int64 Misses = 0;
+            int64 Releases = 0;
+            int64 Prewarmed = 0;
+            double SpawnSeconds = 0;
+            double SavedSeconds = 0;
+        };
+
+        explicit FLuaActorPool(FLuaEnv* InEnv);
+
+        ~FLuaActorPool();
+
+        /** @return a pooled actor made active again at the transform, or nullptr if the pool is empty */
+        AActor* Acquire(lua_State* L, UWorld* World, UClass* Class, const FString& ModuleName, const FTransform& Transform);
+
+        /** Spawn a new actor bound to the module, prewarmed spawns are not counted as misses */
+        AActor* Spawn(lua_State* L, UWorld* World, UClass* Class, const FString& ModuleName, int32 TableRef, const FTransform& Transform, const FActorSpawnParameters& SpawnParameters, bool bPrewarm = false);
+
+        /** Released to the pool the actor was spawned for, @return false if the actor is already pooled */
+        bool Release(lua_State* L, AActor* Actor);
+
+        /** Destroy the pooled actors of the world, only those of the class if one is given */
+        void Clear(UWorld* World, UClass* Class);
+
+        const FStats& GetStats() const { return Stats; }
+
+        const FStats* FindStats(const UClass* Class) const { return ClassStats.Find(Class); }
+
+    private:
+        typedef TTuple<FObjectKey, FObjectKey, FString> FPoolKey;
+
+        /** State changed on release, restored as it was on acquire */
+        struct FPooledActor
+        {
+            TWeakObjectPtr<AActor> Actor;
+            bool bHidden = false;
+            bool bCollisionEnabled = true;
+            bool bTickEnabled = true;
+            TArray<TPair<TWeakObjectPtr<UActorComponent>, bool>> ComponentTicks;
+        };
+
+        FPoolKey MakeKey(UWorld* World, UClass* Class, const FString& ModuleName) const;
+
+        /** Drop the pools of a world torn down, its actors are destroyed along with it */
+        void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+
+        FLuaEnv* Env;
+        TMap<FPoolKey, TArray<FPooledActor>> Pools;
+        TSet<TWeakObjectPtr<AActor>> PooledActors;
+        TMap<TWeakObjectPtr<AActor>, FPoolKey> ActorKeys; // pool of each actor spawned by the pool
+        TMap<FObjectKey, FStats> ClassStats;
+        FStats Stats;
+        FDelegateHandle OnWorldCleanupHandle;
+    };
+}
@@ -0,0 +1,538 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#include "LuaBoundaryRecorder.h"
+
+#if UNLUA_WITH_BOUNDARY_RECORDER
+
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "LuaEnv.h"
+#include "UnLuaBase.h"
+#include "UnLuaManager.h"
+#include "UnLuaModule.h"
+#include "ReflectionUtils/FunctionDesc.h"
+#include "ReflectionUtils/PropertyDesc.h"
+
+namespace UnLua
+{
+    static constexpr uint8 BoundaryMagic[4] = {'U', 'L', 'B', 'R'};
+    static constexpr uint8 BoundaryVersion = 2;
+    static constexpr int32 BoundaryFlushSize = 64 * 1024;
+
+    FLuaBoundaryRecorder* FLuaBoundaryRecorder::Active = nullptr;
+
+    FLuaBoundaryRecorder::FLuaBoundaryRecorder(FArchive* InFile)
+        : File(InFile)
+    {
+        Buffer.Append(BoundaryMagic, sizeof(BoundaryMagic));
+        Buffer.Add(BoundaryVersion);
+    }
+
+    FLuaBoundaryRecorder::~FLuaBoundaryRecorder()
+    {
+        Flush();
+        File->Close();
+        delete File;
+    }
+
+    bool FLuaBoundaryRecorder::Start(const FString& FilePath)
+    {
+        Stop();
+
+        const auto NewFile = IFileManager::Get().CreateFileWriter(*FilePath);
+        if (!NewFile)
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("Failed to create boundary recording %s"), *FilePath);
+            return false;
+        }
+
+        Active = new FLuaBoundaryRecorder(NewFile);
+        UE_LOG(LogUnLua, Log, TEXT("Recording UE/Lua boundary calls to %s"), *FilePath);
+        return true;
+    }
+
+    void FLuaBoundaryRecorder::Stop()
+    {
+        if (!Active)
+            return;
+
+        UE_LOG(LogUnLua, Log, TEXT("%llu UE/Lua boundary calls recorded"), Active->NumCalls);
+        delete Active;
+        Active = nullptr;
+    }
+
+    bool FLuaBoundaryRecorder::IsRecordedParam(const FProperty* Property)
+    {
+        return Property->HasAnyPropertyFlags(CPF_Parm) && !Property->HasAnyPropertyFlags(CPF_ReturnParm);
+    }
+
+    void FLuaBoundaryRecorder::GetShapes(const UFunction* Function, const void* Params, FShapes& OutShapes)
+    {
+        OutShapes.Num = 0;
+        OutShapes.bAvailable = Params != nullptr;
+        if (!Params)
+            return;
+
+        for (TFieldIterator<FProperty> It(Function); It && OutShapes.Num < MaxShapes; ++It)
+        {
+            const FProperty* Property = *It;
+            if (!IsRecordedParam(Property))
+                continue;
+
+            const void* ValuePtr = Property->ContainerPtrToValuePtr<void>(Params);
+            uint32 Shape = 0;
+            if (const auto ArrayProperty = CastField<FArrayProperty>(Property))
+                Shape = FScriptArrayHelper(ArrayProperty, ValuePtr).Num();
+            else if (const auto SetProperty = CastField<FSetProperty>(Property))
+                Shape = FScriptSetHelper(SetProperty, ValuePtr).Num();
+            else if (const auto MapProperty = CastField<FMapProperty>(Property))
+                Shape = FScriptMapHelper(MapProperty, ValuePtr).Num();
+            else if (CastField<FStrProperty>(Property))
+                Shape = static_cast<const FString*>(ValuePtr)->Len();
+            OutShapes.Values[OutShapes.Num++] = Shape;
+        }
+    }
+
+    void FLuaBoundaryRecorder::Record(EDirection Direction, FLuaEnv* Env, const UObject* Object, const UFunction* Function, const FShapes& Shapes, uint64 StartCycles)
+    {
+        // may have been stopped during the call
+        if (!Active)
+            return;
+
+        const uint64 DurationNs = (uint64)((FPlatformTime::Cycles64() - StartCycles) * FPlatformTime::GetSecondsPerCycle64() * 1e9);
+        Active->WriteCall(Direction, Env, Object, Function, Shapes, DurationNs);
+    }
+
+    void FLuaBoundaryRecorder::WriteCall(EDirection Direction, FLuaEnv* Env, const UObject* Object, const UFunction* Function, const FShapes& Shapes, uint64 DurationNs)
+    {
+        const uint32 ClassIndex = FindOrAddClass(Env, Object->GetClass());
+        const uint32 NameIndex = FindOrAddName(Function->GetFName());
+
+        Buffer.Add((uint8)ERecordType::Call);
+        Buffer.Add((uint8)Direction);
+        WriteVarInt(ClassIndex);
+        WriteVarInt(NameIndex);
+        WriteVarInt(DurationNs);
+        Buffer.Add(Shapes.bAvailable ? 1 : 0);
+        WriteVarInt(Shapes.Num);
+        for (int32 i = 0; i < Shapes.Num; ++i)
+            WriteVarInt(Shapes.Values[i]);
+
+        ++NumCalls;
+        if (Buffer.Num() >= BoundaryFlushSize)
+            Flush();
+    }
+
+    uint32 FLuaBoundaryRecorder::FindOrAddClass(FLuaEnv* Env, const UClass* Class)
+    {
+        if (const auto Index = ClassIndices.Find(Class))
+            return *Index;
+
+        // the module is needed to bind the stub of a class bound dynamically
+        const uint32 Index = ClassIndices.Num();
+        ClassIndices.Add(Class, Index);
+        Buffer.Add((uint8)ERecordType::Class);
+        WriteVarInt(Index);
+        WriteString(Class->GetPathName());
+        WriteString(Env ? Env->GetManager()->GetBoundModuleName(Class) : FString());
+        return Index;
+    }
+
+    uint32 FLuaBoundaryRecorder::FindOrAddName(FName Name)
+    {
+        if (const auto Index = NameIndices.Find(Name))
+            return *Index;
+
+        const uint32 Index = NameIndices.Num();
+        NameIndices.Add(Name, Index);
+        Buffer.Add((uint8)ERecordType::Name);
+        WriteVarInt(Index);
+        WriteString(Name.ToString());
+        return Index;
+    }
+
+    void FLuaBoundaryRecorder::WriteVarInt(uint64 Value)
+    {
+        while (Value >= 0x80)
+        {
+            Buffer.Add((uint8)(Value | 0x80));
+            Value >>= 7;
+        }
+        Buffer.Add((uint8)Value);
+    }
+
+    void FLuaBoundaryRecorder::WriteString(const FString& Value)
+    {
+        const FTCHARToUTF8 Bytes(*Value);
+        WriteVarInt(Bytes.Length());
+        Buffer.Append((const uint8*)Bytes.Get(), Bytes.Length());
+    }
+
+    void FLuaBoundaryRecorder::Flush()
+    {
+        if (Buffer.Num() == 0)
+            return;
+        File->Serialize(Buffer.GetData(), Buffer.Num());
+        Buffer.Reset();
+    }
+
+    struct FBoundaryReader
+    {
+        explicit FBoundaryReader(const TArray<uint8>& InData)
+            : Data(InData)
+        {
+        }
+
+        bool IsEnd() const
+        {
+            return bError || Pos >= Data.Num();
+        }
+
+        uint8 ReadByte()
+        {
+            if (Pos >= Data.Num())
+            {
+                bError = true;
+                return 0;
+            }
+            return Data[Pos++];
+        }
+
+        uint64 ReadVarInt()
+        {
+            uint64 Value = 0;
+            for (int32 Shift = 0; Shift < 64; Shift += 7)
+            {
+                const uint8 Byte = ReadByte();
+                Value |= (uint64)(Byte & 0x7f) << Shift;
+                if (!(Byte & 0x80))
+                    return Value;
+            }
+            bError = true;
+            return Value;
+        }
+
+        FString ReadString()
+        {
+            const uint64 Length = ReadVarInt();
+            if (bError || Length > (uint64)(Data.Num() - Pos))
+            {
+                bError = true;
+                return FString();
+            }
+            const FUTF8ToTCHAR Chars((const ANSICHAR*)Data.GetData() + Pos, (int32)Length);
+            Pos += (int32)Length;
+            return FString(Chars.Length(), Chars.Get());
+        }
+
+        const TArray<uint8>& Data;
+        int32 Pos = 0;
+        bool bError = false;
+    };
+
+    bool FLuaBoundaryReplay::Load(const FString& FilePath)
+    {
+        TArray<uint8> Data;
+        if (!FFileHelper::LoadFileToArray(Data, *FilePath))
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("Failed to load boundary recording %s"), *FilePath);
+            return false;
+        }
+
+        if (Data.Num() < 5 || FMemory::Memcmp(Data.GetData(), BoundaryMagic, sizeof(BoundaryMagic)) != 0 || Data[4] != BoundaryVersion)
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("Invalid boundary recording %s"), *FilePath);
+            return false;
+        }
+
+        using ERecordType = FLuaBoundaryRecorder::ERecordType;
+        FBoundaryReader Reader(Data);
+        Reader.Pos = 5;
+        // a record is only added once it was read completely and refers to known classes and names, an invalid record
+        // is rejected alone, reading stops where the stream itself is cut short or unreadable
+        int32 NumRejected = 0;
+        while (!Reader.IsEnd())
+        {
+            const auto Type = (ERecordType)Reader.ReadByte();
+            if (Type == ERecordType::Class)
+            {
+                const uint64 Index = Reader.ReadVarInt();
+                FString ClassPath = Reader.ReadString();
+                FString ModuleName = Reader.ReadString();
+                if (Reader.bError)
+                    break;
+                if (Index != (uint64)ClassPaths.Num())
+                {
+                    ++NumRejected;
+                    continue;
+                }
+                ClassPaths.Add(MoveTemp(ClassPath));
+                ModuleNames.Add(MoveTemp(ModuleName));
+            }
+            else if (Type == ERecordType::Name)
+            {
+                const uint64 Index = Reader.ReadVarInt();
+                const FString Name = Reader.ReadString();
+                if (Reader.bError)
+                    break;
+                if (Index != (uint64)Names.Num())
+                {
+                    ++NumRejected;
+                    continue;
+                }
+                Names.Add(FName(*Name));
+            }
+            else if (Type == ERecordType::Call)
+            {
+                FCall Call;
+                const uint8 Direction = Reader.ReadByte();
+                Call.Direction = (FLuaBoundaryRecorder::EDirection)Direction;
+                Call.ClassIndex = (uint32)Reader.ReadVarInt();
+                Call.NameIndex = (uint32)Reader.ReadVarInt();
+                Call.DurationNs = Reader.ReadVarInt();
+                Call.Shapes.bAvailable = Reader.ReadByte() != 0;
+                const uint64 NumShapes = Reader.ReadVarInt();
+                for (uint64 i = 0; i < NumShapes && !Reader.bError; ++i)
+                {
+                    const uint32 Shape = (uint32)Reader.ReadVarInt();
+                    if (i < FLuaBoundaryRecorder::MaxShapes)
+                        Call.Shapes.Values[i] = Shape;
+                }
+                if (Reader.bError)
+                    break;
+                if (Direction > (uint8)FLuaBoundaryRecorder::EDirection::LuaToUE || NumShapes > FLuaBoundaryRecorder::MaxShapes
+                    || Call.ClassIndex >= (uint32)ClassPaths.Num() || Call.NameIndex >= (uint32)Names.Num())
+                {
+                    ++NumRejected;
+                    continue;
+                }
+                Call.Shapes.Num = (int32)NumShapes;
+                Calls.Add(Call);
+            }
+            else
+            {
+                Reader.bError = true;
+            }
+        }
+
+        // a recording not stopped properly is truncated, the complete records are still usable
+        if (Reader.bError)
+            UE_LOG(LogUnLua, Warning, TEXT("Boundary recording %s is truncated or corrupted at %d"), *FilePath, Reader.Pos);
+        if (NumRejected > 0)
+            UE_LOG(LogUnLua, Warning, TEXT("%d invalid records rejected from boundary recording %s"), NumRejected, *FilePath);
+        return Calls.Num() > 0;
+    }
+
+    static int ReplayCallUE(lua_State* L)
+    {
+        const auto FuncDesc = (FFunctionDesc*)lua_touserdata(L, lua_upvalueindex(1));
+        return FuncDesc->CallUE(L, lua_gettop(L));
+    }
+
+    static void ApplyShapes(const UFunction* Function, void* Params, const FLuaBoundaryRecorder::FShapes& Shapes)
+    {
+        int32 Index = 0;
+        for (TFieldIterator<FProperty> It(Function); It && Index < Shapes.Num; ++It)
+        {
+            const FProperty* Property = *It;
+            if (!FLuaBoundaryRecorder::IsRecordedParam(Property))
+                continue;
+
+            const uint32 Shape = Shapes.Values[Index++];
+            if (Shape == 0)
+                continue;
+
+            void* ValuePtr = Property->ContainerPtrToValuePtr<void>(Params);
+            if (const auto ArrayProperty = CastField<FArrayProperty>(Property))
+                FScriptArrayHelper(ArrayProperty, ValuePtr).AddValues(Shape);
+            else if (CastField<FStrProperty>(Property))
+                *static_cast<FString*>(ValuePtr) = FString::ChrN(Shape, TEXT('x'));
+        }
+    }
+
+    TArray<FLuaBoundaryReplay::FFunctionStats> FLuaBoundaryReplay::Run(UWorld* World, int32 Repeats, const TSet<FName>& AllowedLuaToUE)
+    {
+        struct FStub
+        {
+            UObject* Object = nullptr;
+            FLuaEnv* Env = nullptr;
+        };
+
+        struct FReplayFunction
+        {
+            UFunction* Function = nullptr;
+            TUniquePtr<FFunctionDesc> FuncDesc;
+            TArray<TUniquePtr<FPropertyDesc>> Params;
+            int32 StatsIndex = INDEX_NONE;
+        };
+
+        TArray<FStub> Stubs;
+        Stubs.SetNum(ClassPaths.Num());
+        for (int32 i = 0; i < ClassPaths.Num(); ++i)
+        {
+            UClass* Class = LoadObject<UClass>(nullptr, *ClassPaths[i]);
+            if (!Class)
+            {
+                UE_LOG(LogUnLua, Warning, TEXT("Failed to load class %s, its calls are skipped"), *ClassPaths[i]);
+                continue;
+            }
+
+            UObject* Object;
+            if (Class->HasAnyClassFlags(CLASS_Abstract))
+            {
+                Object = Class->GetDefaultObject();
+            }
+            else if (Class->IsChildOf<AActor>())
+            {
+                FActorSpawnParameters SpawnParameters;
+                SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+                SpawnParameters.ObjectFlags |= RF_Transient;
+                Object = World ? World->SpawnActor(Class, nullptr, nullptr, SpawnParameters) : nullptr;
+            }
+            else
+            {
+                Object = NewObject<UObject>(GetTransientPackage(), Class, NAME_None, RF_Transient);
+                Object->AddToRoot();
+            }
+
+            const auto Env = Object ? IUnLuaModule::Get().GetEnv(Object) : nullptr;
+            if (!Env)
+            {
+                UE_LOG(LogUnLua, Warning, TEXT("Failed to create stub of class %s, its calls are skipped"), *ClassPaths[i]);
+                continue;
+            }
+
+            // classes implementing UnLuaInterface are bound on creation, others were bound dynamically
+            const auto Manager = Env->GetManager();
+            if (!ModuleNames[i].IsEmpty() && Manager->GetBoundModuleName(Class).IsEmpty())
+                Manager->Bind(Object, *ModuleNames[i]);
+
+            Stubs[i].Object = Object;
+            Stubs[i].Env = Env;
+        }
+
+        TArray<FFunctionStats> Stats;
+        TMap<TTuple<uint8, uint32, uint32>, FReplayFunction> Functions;
+        const auto FindOrAddFunction = [&](const FCall& Call) -> FReplayFunction&
+        {
+            const auto Key = MakeTuple((uint8)Call.Direction, Call.ClassIndex, Call.NameIndex);
+            if (const auto Existing = Functions.Find(Key))
+                return *Existing;
+
+            auto& Replay = Functions.Add(Key);
+            Replay.StatsIndex = Stats.AddDefaulted();
+            Stats[Replay.StatsIndex].ClassPath = ClassPaths[Call.ClassIndex];
+            Stats[Replay.StatsIndex].FunctionName = Names[Call.NameIndex];
+            Stats[Replay.StatsIndex].Direction = Call.Direction;
+
+            const auto Object = Stubs[Call.ClassIndex].Object;
+            Replay.Function = Object ? Object->GetClass()->FindFunctionByName(Names[Call.NameIndex]) : nullptr;
+            if (!Replay.Function)
+                return Replay;
+
+            if (Call.Direction == FLuaBoundaryRecorder::EDirection::LuaToUE
+                && !Replay.Function->HasAnyFunctionFlags(FUNC_BlueprintPure | FUNC_Const)
+                && !AllowedLuaToUE.Contains(Replay.Function->GetFName()))
+            {
+                UE_LOG(LogUnLua, Log, TEXT("Lua to UE calls of %s are skipped, it is neither BlueprintPure nor const"), *Replay.Function->GetPathName());
+                Replay.Function = nullptr;
+                return Replay;
+            }
+
+            Replay.FuncDesc = MakeUnique<FFunctionDesc>(Replay.Function, nullptr);
+            for (TFieldIterator<FProperty> It(Replay.Function); It; ++It)
+            {
+                if (FLuaBoundaryRecorder::IsRecordedParam(*It))
+                    Replay.Params.Emplace(FPropertyDesc::Create(*It));
+            }
+            return Replay;
+        };
+
+        for (int32 Repeat = 0; Repeat < Repeats; ++Repeat)
+        {
+            for (const auto& Call : Calls)
+            {
+                auto& Replay = FindOrAddFunction(Call);
+                auto& Stat = Stats[Replay.StatsIndex];
+                const auto& Stub = Stubs[Call.ClassIndex];
+                if (Repeat == 0)
+                    Stat.RecordedNs += Call.DurationNs;
+
+                if (!Replay.Function)
+                {
+                    Stat.NumSkipped += Repeat == 0 ? 1 : 0;
+                    continue;
+                }
+                Stat.NumCalls += Repeat == 0 ? 1 : 0;
+                Stat.NumWithoutParams += Repeat == 0 && !Call.Shapes.bAvailable ? 1 : 0;
+
+                const auto Params = (uint8*)FMemory::Malloc(FMath::Max<int32>(Replay.Function->ParmsSize, 1), 16);
+                Replay.Function->InitializeStruct(Params);
+                ApplyShapes(Replay.Function, Params, Call.Shapes);
+
+                uint64 StartCycles;
+                if (Call.Direction == FLuaBoundaryRecorder::EDirection::UEToLua)
+                {
+                    StartCycles = FPlatformTime::Cycles64();
+                    Stub.Object->ProcessEvent(Replay.Function, Params);
+                }
+                else
+                {
+                    // through FFunctionDesc::CallUE with the parameters pushed as Lua values, as called from Lua
+                    const auto L = Stub.Env->GetMainState();
+                    const int32 Top = lua_gettop(L);
+                    lua_pushlightuserdata(L, Replay.FuncDesc.Get());
+                    lua_pushcclosure(L, ReplayCallUE, 1);
+                    if (!Replay.Function->HasAnyFunctionFlags(FUNC_Static))
+                        PushUObject(L, Stub.Object);
+                    for (const auto& Param : Replay.Params)
+                        Param->ReadValue_InContainer(L, Params, true);
+
+                    StartCycles = FPlatformTime::Cycles64();
+                    if (lua_pcall(L, lua_gettop(L) - Top - 1, 0, 0) != LUA_OK)
+                        UE_LOG(LogUnLua, Verbose, TEXT("Replayed call to %s failed: %s"), *Stat.FunctionName.ToString(), UTF8_TO_TCHAR(lua_tostring(L, -1)));
+                    lua_settop(L, Top);
+                }
+                Stat.ReplayedNs += (FPlatformTime::Cycles64() - StartCycles) * FPlatformTime::GetSecondsPerCycle64() * 1e9;
+
+                Replay.Function->DestroyStruct(Params);
+                FMemory::Free(Params);
+            }
+        }
+
+        for (auto& Stat : Stats)
+        {
+            Stat.RecordedNs /= FMath::Max(Stat.NumCalls + Stat.NumSkipped, 1);
+            Stat.ReplayedNs /= FMath::Max(Stat.NumCalls * Repeats, 1);
+        }
+        Stats.Sort([](const FFunctionStats& A, const FFunctionStats& B) { return A.ReplayedNs * A.NumCalls > B.ReplayedNs * B.NumCalls; });
+
+        for (const auto& Stub : Stubs)
+        {
+            if (!Stub.Object || Stub.Object->HasAnyFlags(RF_ClassDefaultObject))
+                continue;
+            if (const auto Actor = Cast<AActor>(Stub.Object))
+                Actor->Destroy();
+            else
+                Stub.Object->RemoveFromRoot();
+        }
+        return Stats;
+    }
+}
+
+#endif
@@ -22,6 +22,17 @@
 #include "Containers/LuaMap.h"
 #include "ReflectionUtils/FieldDesc.h"
 #include "ReflectionUtils/PropertyDesc.h"
+#include "ReflectionUtils/ClassDesc.h"
+#if ENGINE_MAJOR_VERSION > 4 || (ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION > 24)
+#include "Net/Core/PushModel/PushModel.h"
+#include "UObject/CoreNet.h"
+#endif
+
+#if defined(WITH_PUSH_MODEL) && WITH_PUSH_MODEL
+#define UNLUA_WITH_PUSH_MODEL 1
+#else
+#define UNLUA_WITH_PUSH_MODEL 0
+#endif
 
 #ifdef __cplusplus
 #if !LUA_COMPILE_AS_CPP
@@ -434,79 +445,11 @@ void* GetCppInstanceFast(lua_State *L, int32 Index)
 void* NewScriptContainer(lua_State *L, const FScriptContainerDesc &Desc)
 {
     void* Userdata = NewUserdataWithContainerTag(L, Desc.GetSize());
-    luaL_setmetatable(L, Desc.GetName());   // set metatable
+    if (UnLua::FClassRegistry::PushExportedMetatable(L, Desc.GetName()))     // set metatable
+        lua_setmetatable(L, -2);
     return Userdata;
 }
 
-/**
- * Find a cached script container or create a new one
- *
- * @return - null if container is already cached, or the new created userdata otherwise
- */
-void* CacheScriptContainer(lua_State *L, void *Key, const FScriptContainerDesc &Desc)
-{
-    if (!Key)
-    {
-        UNLUA_LOGERROR(L, LogUnLua, Warning, TEXT("%s, Invalid key!"), ANSI_TO_TCHAR(__FUNCTION__));
-        return nullptr;
-    }
-
-    // return null if container is already cached, or create/cache/return a new ud
-    void *Userdata = nullptr;
-    lua_getfield(L, LUA_REGISTRYINDEX, "ScriptContainerMap");
-    lua_pushlightuserdata(L, Key);
-    int32 Type = lua_rawget(L, -2);             
-    if (Type == LUA_TNIL)
-    {
-        lua_pop(L, 1);
-
-        Userdata = NewUserdataWithContainerTag(L, Desc.GetSize());      // create new userdata
-        luaL_setmetatable(L, Desc.GetName());               // set metatable
-        lua_pushlightuserdata(L, Key);
-        lua_pushvalue(L, -2);
-        lua_rawset(L, -4);                                  // cache it in 'ScriptContainerMap'
-        UnLua::FLuaEnv::FindEnv(L)->GetDanglingCheck()->CaptureContainer(L, Key);
-    }
-#if UE_BUILD_DEBUG
-    else
-    {
-        check(Type == LUA_TUSERDATA);
-    }
-#endif
-    lua_remove(L, -2);
-    return Userdata;            // return null if container is already cached, or the new created userdata otherwise
-}
-
-
-void* CacheScriptContainer(lua_State *L, void *Key, const FScriptContainerDesc &Desc, const TFunctionRef<bool (void*)>& Validator)
-{
-    if (!Key)
-    {
-        UNLUA_LOGERROR(L, LogUnLua, Warning, TEXT("%s, Invalid key!"), ANSI_TO_TCHAR(__FUNCTION__));
-        return nullptr;
-    }
-
-    // return null if container is already cached, or create/cache/return a new ud
-    void *Userdata = nullptr;
-    lua_getfield(L, LUA_REGISTRYINDEX, "ScriptContainerMap");
-    lua_pushlightuserdata(L, Key);
-    int32 Type = lua_rawget(L, -2);
-    if (Type == LUA_TNIL || !Validator(lua_touserdata(L, -1)))
-    {
-        lua_pop(L, 1);
-
-        Userdata = NewUserdataWithContainerTag(L, Desc.GetSize());      // create new userdata
-        luaL_setmetatable(L, Desc.GetName());               // set metatable
-        lua_pushlightuserdata(L, Key);
-        lua_pushvalue(L, -2);
-        lua_rawset(L, -4);                                  // cache it in 'ScriptContainerMap'
-        UnLua::FLuaEnv::FindEnv(L)->GetDanglingCheck()->CaptureContainer(L, Key);
-    }
-
-    lua_remove(L, -2);
-    return Userdata;            // return null if container is already cached, or the new created userdata otherwise
-}
-
 /**
  * Get a script container at the given stack index
  */
@@ -527,28 +470,6 @@ void* GetScriptContainer(lua_State *L, int32 Index)
     return nullptr;
 }
 
-/**
- * Remove a cached script container from 'ScriptContainerMap'
- */
-void RemoveCachedScriptContainer(lua_State *L, void *Key)
-{
-    if (!L || !Key)
-    {
-        return;
-    }
-
-    lua_getfield(L, LUA_REGISTRYINDEX, "ScriptContainerMap");
-    lua_pushlightuserdata(L, Key);
-    int32 Type = lua_rawget(L, -2);
-    if (Type != LUA_TNIL)
-    {
-        lua_pushlightuserdata(L, Key);
-        lua_pushnil(L);
-        lua_rawset(L, -4);
-    }
-    lua_pop(L, 2);
-}
-
 /**
  * Push a UObject to Lua stack
  */
@@ -849,16 +770,7 @@ bool GetObjectMapping(lua_State *L, UObjectBaseUtility *Object)
         return false;
     }
 
-    lua_getfield(L, LUA_REGISTRYINDEX, "UnLua_ObjectMap");
-    lua_pushlightuserdata(L, Object);
-    int32 Type = lua_rawget(L, -2);
-    if (Type != LUA_TNIL)
-    {
-        lua_remove(L, -2);
-        return true;
-    }
-    lua_pop(L, 2);
-    return false;
+    return UnLua::FLuaEnv::FindEnvChecked(L).GetObjectRegistry()->PushCached(L, (UObject*)Object);
 }
 
 /**
@@ -869,7 +781,9 @@ int32 PushFunction(lua_State *L, UObjectBaseUtility *Object, const char *Functio
     int32 N = lua_gettop(L);
     lua_pushcfunction(L, UnLua::ReportLuaCallError);
     const auto& Env = UnLua::FLuaEnv::FindEnv(L);
-    const auto Ref = Env->GetObjectRegistry()->GetBoundRef((UObject*)Object);
+    auto Ref = Env->GetObjectRegistry()->GetBoundRef((UObject*)Object);
+    if (Ref == LUA_NOREF && Env->GetObjectRegistry()->Materialize((UObject*)Object))
+        Ref = Env->GetObjectRegistry()->GetBoundRef((UObject*)Object);
     if (Ref != LUA_NOREF)
     {
         lua_rawgeti(L, LUA_REGISTRYINDEX, Ref);
@@ -1220,6 +1134,55 @@ int32 Class_Index(lua_State *L)
     return 1;
 }
 
+#if UNLUA_WITH_PUSH_MODEL
+/**
+ * Mark a replicated property dirty if it's push based in the class of the object. Push based rep indices are cached per class,
+ * replication is declared in C++ and Blueprint, nothing Lua does can change it.
+ *
+ * Only whole property assignments are marked, writing a field of a replicated struct (Actor.RepStruct.X = 1) goes through the
+ * struct's own __newindex and doesn't dirty the owner. Assign the whole struct, or mark it with MARK_PROPERTY_DIRTY in C++.
+ */
+static void MarkPropertyDirty(UObject* Object, FProperty* Property)
+{
+    if (!IS_PUSH_MODEL_ENABLED())
+        return;
+
+    static TMap<TWeakObjectPtr<UClass>, TBitArray<>> PushBasedRepIndices;
+
+    UClass* Class = Object->GetClass();
+    TBitArray<>* PushBased = PushBasedRepIndices.Find(Class);
+    if (!PushBased)
+    {
+        // drop classes collected since the last miss
+        for (auto It = PushBasedRepIndices.CreateIterator(); It; ++It)
+        {
+            if (!It.Key().IsValid())
+                It.RemoveCurrent();
+        }
+
+        PushBased = &PushBasedRepIndices.Add(Class);
+        TArray<FLifetimeProperty> LifetimeProps;
+        Class->GetDefaultObject()->GetLifetimeReplicatedProps(LifetimeProps);
+        for (const auto& LifetimeProp : LifetimeProps)
+        {
+            if (!LifetimeProp.bIsPushBased)
+                continue;
+            if (PushBased->Num() <= LifetimeProp.RepIndex)
+                PushBased->Add(false, LifetimeProp.RepIndex + 1 - PushBased->Num());
+            (*PushBased)[LifetimeProp.RepIndex] = true;
+        }
+    }
+
+    // static arrays take one rep index per element
+    for (int32 i = 0; i < Property->ArrayDim; ++i)
+    {
+        const int32 RepIndex = Property->RepIndex + i;
+        if (RepIndex < PushBased->Num() && (*PushBased)[RepIndex])
+            MARK_PROPERTY_DIRTY_UNSAFE(Object, RepIndex);
+    }
+}
+#endif
+
 /**
  * __newindex meta methods for class
  */
@@ -1243,6 +1206,11 @@ int32 Class_NewIndex(lua_State *L)
                     return 0;
 
                 (*Property)->WriteValue_InContainer(L, Self, 3);
+#if UNLUA_WITH_PUSH_MODEL
+                const auto PropertyDesc = static_cast<FPropertyDesc*>((*Property).Get());
+                if (PropertyDesc->GetProperty()->HasAnyPropertyFlags(CPF_Net))
+                    MarkPropertyDirty((UObject*)Self, PropertyDesc->GetProperty());
+#endif
             }
         }
     }
@@ -1371,11 +1339,58 @@ int32 Class_Cast(lua_State* L)
     return 1;
 }
 
+/**
+ * Find the accessor of the struct field named at index 2, resolved through the generic path the first time.
+ * Upvalue 1 is the table of accessors of the struct, upvalue 2 its FClassDesc.
+ */
+static const FScriptStructField* FindStructField(lua_State* L)
+{
+    lua_pushvalue(L, 2);
+    const int32 Type = lua_rawget(L, lua_upvalueindex(1));
+    const auto Field = (const FScriptStructField*)lua_touserdata(L, -1);
+    lua_pop(L, 1);
+    if (Type == LUA_TLIGHTUSERDATA)
+        return Field;
+    if (Type != LUA_TNIL || lua_type(L, 2) != LUA_TSTRING)
+        return nullptr;
+
+    const FScriptStructField* NewField = nullptr;
+    GetField(L);
+    if (lua_type(L, -1) == LUA_TUSERDATA)
+    {
+        const auto Registry = UnLua::FLuaEnv::FindEnvChecked(L).GetObjectRegistry();
+        const auto Property = Registry->Get<UnLua::ITypeOps>(L, -1);
+        const auto ClassDesc = (FClassDesc*)lua_touserdata(L, lua_upvalueindex(2));
+        if (Property.IsValid() && ClassDesc)
+            NewField = ClassDesc->AddStructField(Property->GetUProperty());
+    }
+    lua_pop(L, 1);
+
+    // functions and other properties are marked to skip the lookup next time
+    lua_pushvalue(L, 2);
+    if (NewField)
+        lua_pushlightuserdata(L, (void*)NewField);
+    else
+        lua_pushboolean(L, false);
+    lua_rawset(L, lua_upvalueindex(1));
+    return NewField;
+}
+
 /**
  * __index meta methods for struct
  */
 int32 ScriptStruct_Index(lua_State *L)
 {
+    if (const auto Field = FindStructField(L))
+    {
+        void* Self = GetCppInstanceFast(L, 1);
+        if (Self && !UnLua::LowLevel::IsReleasedPtr(Self))
+        {
+            Field->Read(L, Self);
+            return 1;
+        }
+    }
+
     GetField(L);
     if (lua_type(L, -1) != LUA_TUSERDATA)
         return 1;
@@ -1394,6 +1409,20 @@ int32 ScriptStruct_Index(lua_State *L)
     return 1;
 }
 
+/**
+ * __newindex meta methods for struct
+ */
+int32 ScriptStruct_NewIndex(lua_State *L)
+{
+    if (const auto Field = FindStructField(L))
+    {
+        void* Self = GetCppInstanceFast(L, 1);
+        if (Self && !UnLua::LowLevel::IsReleasedPtr(Self) && Field->Write(L, Self, 3))
+            return 0;
+    }
+    return Class_NewIndex(L);
+}
+
 FClassDesc* ScriptStruct_CheckParam(lua_State *L)
 {
     FClassDesc *ClassDesc = (FClassDesc*)lua_touserdata(L, lua_upvalueindex(1));
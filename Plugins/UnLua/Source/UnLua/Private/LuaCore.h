@@ -64,10 +64,7 @@ UNLUA_API void* GetCppInstanceFast(lua_State *L, int32 Index);
  * Functions to handle script containers
  */
 void* NewScriptContainer(lua_State *L, const FScriptContainerDesc &Desc);
-void* CacheScriptContainer(lua_State *L, void *Key, const FScriptContainerDesc &Desc);
-void* CacheScriptContainer(lua_State* L, void* Key, const FScriptContainerDesc& Desc, const TFunctionRef<bool (void*)>& Validator);
 void* GetScriptContainer(lua_State *L, int32 Index);
-void RemoveCachedScriptContainer(lua_State *L, void *Key);
 
 /**
  * Functions to push FProperty array
@@ -131,6 +128,7 @@ int32 Class_Cast(lua_State* L);
  * Functions to handle UScriptStruct
  */
 int32 ScriptStruct_Index(lua_State *L);
+int32 ScriptStruct_NewIndex(lua_State *L);
 int32 ScriptStruct_New(lua_State *L);
 int32 ScriptStruct_Delete(lua_State *L);
 int32 ScriptStruct_Copy(lua_State *L);
@@ -0,0 +1,408 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#include "LuaCoroutineScheduler.h"
+#include "LuaEnv.h"
+#include "UnLuaBase.h"
+
+namespace UnLua
+{
+    static constexpr int32 MaxFreeThreads = 128;
+
+    /** Yielded by the wait functions, other yields are not the scheduler's */
+    static int32 WaitSentinel;
+
+    FLuaCoroutineScheduler::FLuaCoroutineScheduler(FLuaEnv* InEnv)
+        : Env(InEnv)
+    {
+        TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FLuaCoroutineScheduler::Tick));
+    }
+
+    FLuaCoroutineScheduler::~FLuaCoroutineScheduler()
+    {
+        // thread and function refs are released along with the lua state
+        FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+    }
+
+    void FLuaCoroutineScheduler::Start(lua_State* L, int32 FunctionIndex)
+    {
+        FunctionIndex = lua_absindex(L, FunctionIndex);
+        const int32 NumArgs = lua_gettop(L) - FunctionIndex;
+
+        lua_State* Thread;
+        int32 ThreadRef;
+        if (FreeThreads.Num() > 0)
+        {
+            Thread = FreeThreads.Pop(false);
+            ThreadRef = OwnedThreads.FindChecked(Thread);
+        }
+        else
+        {
+            Thread = lua_newthread(L);
+            ThreadRef = luaL_ref(L, LUA_REGISTRYINDEX);
+            OwnedThreads.Add(Thread, ThreadRef);
+        }
+
+        if (!lua_checkstack(Thread, NumArgs + 1))
+        {
+            lua_settop(L, FunctionIndex - 1);
+            Recycle(L, Thread, ThreadRef);
+            luaL_error(L, "too many arguments to start a coroutine");
+            return;
+        }
+
+        lua_xmove(L, Thread, NumArgs + 1);
+        Resume(L, Thread, ThreadRef, true, NumArgs);
+    }
+
+    int FLuaCoroutineScheduler::WaitFrames(lua_State* L, int32 NumFrames)
+    {
+        const int32 Index = AddWaiter(L, EWaitList::Frames);
+        Waiters[Index].WakeFrame = FrameCount + FMath::Max(NumFrames, 1);
+        LinkSorted(Index);
+        return Suspend(L);
+    }
+
+    int FLuaCoroutineScheduler::WaitSeconds(lua_State* L, double Seconds)
+    {
+        const int32 Index = AddWaiter(L, EWaitList::Seconds);
+        Waiters[Index].WakeTime = ElapsedSeconds + FMath::Max(Seconds, 0.0);
+        LinkSorted(Index);
+        return Suspend(L);
+    }
+
+    int FLuaCoroutineScheduler::WaitUntil(lua_State* L, int32 PredicateIndex)
+    {
+        PredicateIndex = lua_absindex(L, PredicateIndex);
+        const int32 Index = AddWaiter(L, EWaitList::Until);
+        lua_pushvalue(L, PredicateIndex);
+        Waiters[Index].ArgRef = luaL_ref(L, LUA_REGISTRYINDEX);
+        LinkTail(Index);
+        return Suspend(L);
+    }
+
+    int FLuaCoroutineScheduler::WaitEvent(lua_State* L, FName EventName)
+    {
+        const int32 Index = AddWaiter(L, EWaitList::Event);
+        Waiters[Index].EventName = EventName;
+        LinkTail(Index);
+        return Suspend(L);
+    }
+
+    int32 FLuaCoroutineScheduler::SignalEvent(lua_State* L, FName EventName, int32 PayloadIndex)
+    {
+        const FWaitList* List = EventLists.Find(EventName);
+        if (!List)
+            return 0;
+
+        int32 Index = List->Head;
+        EventLists.Remove(EventName);
+
+        PayloadIndex = lua_absindex(L, PayloadIndex);
+        const bool bHasPayload = !lua_isnoneornil(L, PayloadIndex);
+        int32 Count = 0;
+        while (Index != INDEX_NONE)
+        {
+            const int32 Next = Waiters[Index].Next;
+            if (bHasPayload)
+            {
+                lua_pushvalue(L, PayloadIndex);
+                Waiters[Index].ArgRef = luaL_ref(L, LUA_REGISTRYINDEX);
+            }
+            Waiters[Index].List = EWaitList::Ready;
+            InsertAfter(ReadyList, Index, ReadyList.Tail);
+            ++Count;
+            Index = Next;
+        }
+        return Count;
+    }
+
+    int32 FLuaCoroutineScheduler::AddWaiter(lua_State* L, EWaitList List)
+    {
+        if (lua_pushthread(L))
+        {
+            lua_pop(L, 1);
+            luaL_error(L, "attempt to wait outside a coroutine");
+        }
+
+        if (!lua_isyieldable(L))
+        {
+            lua_pop(L, 1);
+            luaL_error(L, "attempt to wait across a C-call boundary");
+        }
+
+        const int32 Index = AllocWaiter();
+        FWaiter& Waiter = Waiters[Index];
+        Waiter.Thread = L;
+        Waiter.List = List;
+        if (const int32* ThreadRef = OwnedThreads.Find(L))
+        {
+            lua_pop(L, 1);
+            Waiter.ThreadRef = *ThreadRef;
+            Waiter.bOwned = true;
+        }
+        else
+        {
+            // coroutines created by scripts are kept alive only while they wait
+            Waiter.ThreadRef = luaL_ref(L, LUA_REGISTRYINDEX);
+            Waiter.bOwned = false;
+        }
+        WaitingThreads.Add(L);
+        ++NumWaiters;
+        return Index;
+    }
+
+    int32 FLuaCoroutineScheduler::AllocWaiter()
+    {
+        if (FreeWaiters.Num() > 0)
+            return FreeWaiters.Pop(false);
+        return Waiters.AddDefaulted();
+    }
+
+    int FLuaCoroutineScheduler::Suspend(lua_State* L)
+    {
+        lua_pushlightuserdata(L, &WaitSentinel);
+        return lua_yield(L, 1);
+    }
+
+    FLuaCoroutineScheduler::FWaitList& FLuaCoroutineScheduler::GetList(const FWaiter& Waiter)
+    {
+        switch (Waiter.List)
+        {
+        case EWaitList::Frames:
+            return FrameList;
+        case EWaitList::Seconds:
+            return TimeList;
+        case EWaitList::Until:
+            return UntilList;
+        case EWaitList::Event:
+            return EventLists.FindOrAdd(Waiter.EventName);
+        default:
+            check(Waiter.List == EWaitList::Ready);
+            return ReadyList;
+        }
+    }
+
+    void FLuaCoroutineScheduler::LinkSorted(int32 Index)
+    {
+        // most waits are longer than the ones already queued, so search from the tail
+        const FWaiter& Waiter = Waiters[Index];
+        FWaitList& List = GetList(Waiter);
+        int32 After = List.Tail;
+        if (Waiter.List == EWaitList::Frames)
+        {
+            while (After != INDEX_NONE && Waiters[After].WakeFrame > Waiter.WakeFrame)
+                After = Waiters[After].Prev;
+        }
+        else
+        {
+            while (After != INDEX_NONE && Waiters[After].WakeTime > Waiter.WakeTime)
+                After = Waiters[After].Prev;
+        }
+        InsertAfter(List, Index, After);
+    }
+
+    void FLuaCoroutineScheduler::LinkTail(int32 Index)
+    {
+        FWaitList& List = GetList(Waiters[Index]);
+        InsertAfter(List, Index, List.Tail);
+    }
+
+    void FLuaCoroutineScheduler::InsertAfter(FWaitList& List, int32 Index, int32 After)
+    {
+        FWaiter& Waiter = Waiters[Index];
+        Waiter.Prev = After;
+        Waiter.Next = After == INDEX_NONE ? List.Head : Waiters[After].Next;
+        if (Waiter.Prev != INDEX_NONE)
+            Waiters[Waiter.Prev].Next = Index;
+        else
+            List.Head = Index;
+        if (Waiter.Next != INDEX_NONE)
+            Waiters[Waiter.Next].Prev = Index;
+        else
+            List.Tail = Index;
+    }
+
+    void FLuaCoroutineScheduler::Unlink(int32 Index)
+    {
+        FWaiter& Waiter = Waiters[Index];
+        FWaitList& List = GetList(Waiter);
+        if (Waiter.Prev != INDEX_NONE)
+            Waiters[Waiter.Prev].Next = Waiter.Next;
+        else
+            List.Head = Waiter.Next;
+        if (Waiter.Next != INDEX_NONE)
+            Waiters[Waiter.Next].Prev = Waiter.Prev;
+        else
+            List.Tail = Waiter.Prev;
+
+        if (Waiter.List == EWaitList::Event && List.Head == INDEX_NONE)
+            EventLists.Remove(Waiter.EventName);
+
+        Waiter.Prev = INDEX_NONE;
+        Waiter.Next = INDEX_NONE;
+    }
+
+    void FLuaCoroutineScheduler::Dequeue(int32 Index)
+    {
+        Unlink(Index);
+
+        FWaiter& Waiter = Waiters[Index];
+        int32 ArgRef = Waiter.ArgRef;
+        if (Waiter.List == EWaitList::Until)
+        {
+            luaL_unref(Env->GetMainState(), LUA_REGISTRYINDEX, ArgRef);
+            ArgRef = LUA_NOREF;
+        }
+        DueWaiters.Add({Waiter.Thread, Waiter.ThreadRef, ArgRef, Waiter.bOwned});
+        WaitingThreads.Remove(Waiter.Thread);
+
+        Waiter = FWaiter();
+        FreeWaiters.Add(Index);
+        --NumWaiters;
+    }
+
+    void FLuaCoroutineScheduler::Resume(lua_State* From, lua_State* Thread, int32 ThreadRef, bool bOwned, int32 NumArgs)
+    {
+#if 504 == LUA_VERSION_NUM
+        int NResults = 0;
+        const int32 Status = lua_resume(Thread, From, NumArgs, &NResults);
+#else
+        const int32 Status = lua_resume(Thread, From, NumArgs);
+        const int NResults = lua_gettop(Thread);
+#endif
+
+        if (Status == LUA_YIELD)
+        {
+            const bool bWaiting = NResults > 0 && lua_touserdata(Thread, -1) == &WaitSentinel && WaitingThreads.Contains(Thread);
+            lua_pop(Thread, NResults);
+            if (bWaiting)
+            {
+                // a wait holds its own reference, the one of a script coroutine was taken again by the wait
+                if (!bOwned)
+                    luaL_unref(From, LUA_REGISTRYINDEX, ThreadRef);
+                return;
+            }
+
+            if (Env->FindThread(Thread) != LUA_REFNIL)
+            {
+                // latent functions resume the coroutine through the env, which holds its own reference
+                if (bOwned)
+                    OwnedThreads.Remove(Thread);
+                luaL_unref(From, LUA_REGISTRYINDEX, ThreadRef);
+                return;
+            }
+
+            // a plain coroutine.yield belongs to whoever resumes the coroutine itself, such as a generator,
+            // it's no longer scheduled
+            if (bOwned)
+            {
+                UE_LOG(LogUnLua, Warning, TEXT("A coroutine started by UnLua.StartCoroutine yielded outside the wait functions, it is no longer scheduled"));
+                OwnedThreads.Remove(Thread);
+            }
+            luaL_unref(From, LUA_REGISTRYINDEX, ThreadRef);
+            return;
+        }
+
+        if (Status != LUA_OK)
+        {
+            luaL_traceback(From, Thread, lua_tostring(Thread, -1), 0);
+            UE_LOG(LogUnLua, Error, TEXT("%s"), UTF8_TO_TCHAR(lua_tostring(From, -1)));
+            lua_pop(From, 1);
+        }
+
+        if (bOwned)
+            Recycle(From, Thread, ThreadRef);
+        else
+            luaL_unref(From, LUA_REGISTRYINDEX, ThreadRef);
+    }
+
+    void FLuaCoroutineScheduler::Recycle(lua_State* From, lua_State* Thread, int32 ThreadRef)
+    {
+#if 504 == LUA_VERSION_NUM
+        // also closes the pending to-be-closed variables of a failed coroutine
+        lua_resetthread(Thread);
+        const bool bReusable = true;
+#else
+        // a coroutine is dead once it raised an error
+        const bool bReusable = lua_status(Thread) == LUA_OK;
+        lua_settop(Thread, 0);
+#endif
+        if (bReusable && FreeThreads.Num() < MaxFreeThreads)
+        {
+            FreeThreads.Add(Thread);
+            return;
+        }
+
+        OwnedThreads.Remove(Thread);
+        luaL_unref(From, LUA_REGISTRYINDEX, ThreadRef);
+    }
+
+    bool FLuaCoroutineScheduler::Tick(float DeltaTime)
+    {
+        ++FrameCount;
+        ElapsedSeconds += DeltaTime;
+        if (NumWaiters == 0)
+            return true;
+
+        while (FrameList.Head != INDEX_NONE && Waiters[FrameList.Head].WakeFrame <= FrameCount)
+            Dequeue(FrameList.Head);
+
+        while (TimeList.Head != INDEX_NONE && Waiters[TimeList.Head].WakeTime <= ElapsedSeconds)
+            Dequeue(TimeList.Head);
+
+        while (ReadyList.Head != INDEX_NONE)
+            Dequeue(ReadyList.Head);
+
+        lua_State* L = Env->GetMainState();
+        if (UntilList.Head != INDEX_NONE)
+        {
+            // only poll the predicates queued before this pass, a failing predicate resumes its coroutine
+            const int32 Top = lua_gettop(L);
+            const int32 Last = UntilList.Tail;
+            int32 Index = UntilList.Head;
+            while (Index != INDEX_NONE)
+            {
+                const int32 Next = Waiters[Index].Next;
+                lua_pushcfunction(L, ReportLuaCallError);
+                lua_rawgeti(L, LUA_REGISTRYINDEX, Waiters[Index].ArgRef);
+                const bool bDone = lua_pcall(L, 0, 1, Top + 1) != LUA_OK || lua_toboolean(L, -1);
+                lua_settop(L, Top);
+                if (bDone)
+                    Dequeue(Index);
+                if (Index == Last)
+                    break;
+                Index = Next;
+            }
+        }
+
+        for (int32 i = 0; i < DueWaiters.Num(); ++i)
+        {
+            const FDue Due = DueWaiters[i];
+            int32 NumArgs = 0;
+            if (Due.ArgRef != LUA_NOREF)
+            {
+                lua_rawgeti(L, LUA_REGISTRYINDEX, Due.ArgRef);
+                luaL_unref(L, LUA_REGISTRYINDEX, Due.ArgRef);
+                lua_checkstack(Due.Thread, 1);
+                lua_xmove(L, Due.Thread, 1);
+                NumArgs = 1;
+            }
+            Resume(L, Due.Thread, Due.ThreadRef, Due.bOwned, NumArgs);
+        }
+        DueWaiters.Reset();
+        return true;
+    }
+}
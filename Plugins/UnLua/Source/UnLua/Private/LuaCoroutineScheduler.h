@@ -0,0 +1,147 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "UnLuaCompatibility.h"
+#include "lua.hpp"
+
+namespace UnLua
+{
+    class FLuaEnv;
+
+    /**
+     * Frame driven scheduler for Lua coroutines. Suspended coroutines are kept in intrusive lists sorted by
+     * wake frame/time, all due coroutines are resumed in a single pass per frame and the threads of finished
+     * coroutines are recycled. Only the yields of the wait functions are scheduled, a plain coroutine.yield is left
+     * to the script resuming the coroutine itself.
+     */
+    class FLuaCoroutineScheduler
+    {
+    public:
+        explicit FLuaCoroutineScheduler(FLuaEnv* InEnv);
+
+        ~FLuaCoroutineScheduler();
+
+        /**
+         * Run the function at the given stack index with all values above it as arguments in a pooled coroutine,
+         * until it waits or returns. The function and arguments are popped.
+         */
+        void Start(lua_State* L, int32 FunctionIndex);
+
+        /** Wait functions suspend the running coroutine, return their result from the lua_CFunction. */
+        int WaitFrames(lua_State* L, int32 NumFrames);
+
+        int WaitSeconds(lua_State* L, double Seconds);
+
+        int WaitUntil(lua_State* L, int32 PredicateIndex);
+
+        int WaitEvent(lua_State* L, FName EventName);
+
+        /**
+         * Wake all coroutines waiting for the event on the next pass, passing them the value at PayloadIndex.
+         * @return number of coroutines woken
+         */
+        int32 SignalEvent(lua_State* L, FName EventName, int32 PayloadIndex);
+
+        int32 NumWaiting() const { return NumWaiters; }
+
+    private:
+        enum class EWaitList : uint8
+        {
+            None,
+            Frames,
+            Seconds,
+            Until,
+            Event,
+            Ready,
+        };
+
+        struct FWaiter
+        {
+            lua_State* Thread = nullptr;
+            int32 ThreadRef = LUA_NOREF;
+            int32 ArgRef = LUA_NOREF; // predicate while waiting, payload once woken by an event
+            uint64 WakeFrame = 0;
+            double WakeTime = 0;
+            FName EventName;
+            EWaitList List = EWaitList::None;
+            bool bOwned = false;
+            int32 Prev = INDEX_NONE;
+            int32 Next = INDEX_NONE;
+        };
+
+        struct FWaitList
+        {
+            int32 Head = INDEX_NONE;
+            int32 Tail = INDEX_NONE;
+        };
+
+        struct FDue
+        {
+            lua_State* Thread;
+            int32 ThreadRef;
+            int32 ArgRef;
+            bool bOwned;
+        };
+
+        bool Tick(float DeltaTime);
+
+        int32 AllocWaiter();
+
+        int32 AddWaiter(lua_State* L, EWaitList List);
+
+        int Suspend(lua_State* L);
+
+        FWaitList& GetList(const FWaiter& Waiter);
+
+        void LinkSorted(int32 Index);
+
+        void LinkTail(int32 Index);
+
+        void InsertAfter(FWaitList& List, int32 Index, int32 After);
+
+        void Unlink(int32 Index);
+
+        void Dequeue(int32 Index);
+
+        void Resume(lua_State* From, lua_State* Thread, int32 ThreadRef, bool bOwned, int32 NumArgs);
+
+        void Recycle(lua_State* From, lua_State* Thread, int32 ThreadRef);
+
+        FLuaEnv* Env;
+        TArray<FWaiter> Waiters;
+        TArray<int32> FreeWaiters;
+        FWaitList FrameList;
+        FWaitList TimeList;
+        FWaitList UntilList;
+        FWaitList ReadyList;
+        TMap<FName, FWaitList> EventLists;
+        TMap<lua_State*, int32> OwnedThreads;
+        TArray<lua_State*> FreeThreads;
+        TSet<lua_State*> WaitingThreads;
+        TArray<FDue> DueWaiters;
+        uint64 FrameCount = 0;
+        double ElapsedSeconds = 0;
+        int32 NumWaiters = 0;
+#if ENGINE_MAJOR_VERSION >= 5
+        FTSTicker::FDelegateHandle TickerHandle;
+#else
+        FDelegateHandle TickerHandle;
+#endif
+    };
+}
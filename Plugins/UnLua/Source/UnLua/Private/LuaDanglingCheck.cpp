@@ -34,16 +34,11 @@ namespace UnLua
         if (Owner->CapturedStructs.Num() > 0)
         {
             const auto L = Owner->Env->GetMainState();
-            lua_getfield(L, LUA_REGISTRYINDEX, "StructMap");
+            const auto StructIndex = Owner->Env->GetStructIndex();
             for (const auto& StructPtr : Owner->CapturedStructs)
             {
-                lua_pushlightuserdata(L, StructPtr);
-                lua_rawget(L, -2);
-                if (lua_isnil(L, -1))
-                {
-                    lua_pop(L, 1);
+                if (!StructIndex->Push(L, StructPtr))
                     continue;
-                }
 
                 check(lua_isuserdata(L, -1))
                 bool TwoLevelPtr;
@@ -53,11 +48,8 @@ namespace UnLua
 
                 lua_pop(L, 1);
 
-                lua_pushlightuserdata(L, StructPtr);
-                lua_pushnil(L);
-                lua_rawset(L, -3);
+                StructIndex->Remove(StructPtr);
             }
-            lua_pop(L, 1);
             if (Owner->GuardCount == 0)
                 Owner->CapturedStructs.Empty();
         }
@@ -65,16 +57,11 @@ namespace UnLua
         if (Owner->CapturedContainers.Num() > 0)
         {
             const auto L = Owner->Env->GetMainState();
-            lua_getfield(L, LUA_REGISTRYINDEX, "ScriptContainerMap");
+            const auto Registry = Owner->Env->GetContainerRegistry();
             for (const auto& ContainerPtr : Owner->CapturedContainers)
             {
-                lua_pushlightuserdata(L, ContainerPtr);
-                lua_rawget(L, -2);
-                if (lua_isnil(L, -1))
-                {
-                    lua_pop(L, 1);
+                if (!Registry->PushCached(L, ContainerPtr))
                     continue;
-                }
 
                 bool TwoLevelPtr;
                 void* Userdata = GetUserdataFast(L, -1, &TwoLevelPtr);
@@ -83,11 +70,8 @@ namespace UnLua
 
                 lua_pop(L, 1);
 
-                lua_pushlightuserdata(L, ContainerPtr);
-                lua_pushnil(L);
-                lua_rawset(L, -3);
+                Registry->RemoveCached(ContainerPtr);
             }
-            lua_pop(L, 1);
             if (Owner->GuardCount == 0)
                 Owner->CapturedContainers.Empty();
         }
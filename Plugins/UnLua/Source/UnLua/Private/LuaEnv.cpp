@@ -22,6 +22,12 @@
 #include "Registries/ClassRegistry.h"
 #include "LuaCore.h"
 #include "LuaDynamicBinding.h"
+#include "LuaTimerWheel.h"
+#include "LuaCoroutineScheduler.h"
+#include "LuaJobPool.h"
+#include "LuaEventBus.h"
+#include "LuaRPCBatcher.h"
+#include "LuaActorPool.h"
 #include "UELib.h"
 #include "ObjectReferencer.h"
 #include "UnLuaDelegates.h"
@@ -36,8 +42,10 @@ namespace UnLua
     constexpr EInternalObjectFlags AsyncObjectFlags = EInternalObjectFlags::AsyncLoading | EInternalObjectFlags::Async;
 
     TMap<lua_State*, FLuaEnv*> FLuaEnv::AllEnvs;
+    static uint32 NextEnvId = 0;
     FLuaEnv::FOnCreated FLuaEnv::OnCreated;
     FLuaEnv::FOnDestroyed FLuaEnv::OnDestroyed;
+    FLuaEnv::FOnHotReloaded FLuaEnv::OnHotReloaded;
 
 #if ENABLE_UNREAL_INSIGHTS && CPUPROFILERTRACE_ENABLED
     void Hook(lua_State* L, lua_Debug* ar)
@@ -72,7 +80,13 @@ namespace UnLua
 #endif
 
     FLuaEnv::FLuaEnv()
-        : bStarted(false)
+        : FLuaEnv(nullptr)
+    {
+    }
+
+    FLuaEnv::FLuaEnv(TSharedPtr<const FLuaEnvTemplate, ESPMode::ThreadSafe> InTemplate)
+        : Template(MoveTemp(InTemplate)),
+          bStarted(false)
     {
         const auto Settings = GetDefault<UUnLuaSettings>();
         ModuleLocator = Settings->ModuleLocatorClass.GetDefaultObject();
@@ -92,6 +106,7 @@ namespace UnLua
 #endif
 
         AllEnvs.Add(L, this);
+        Id = ++NextEnvId;
 
         luaL_openlibs(L);
 
@@ -99,6 +114,14 @@ namespace UnLua
         AddSearcher(LoadFromFileSystem, 3);
         AddSearcher(LoadFromBuiltinLibs, 4);
 
+        if (Template)
+        {
+            // after custom loaders, which take precedence over the file system as usual
+            for (const auto& Module : Template->GetModules())
+                PendingTemplateModules.Add(Module.Name);
+            AddSearcher(LoadFromTemplate, 3);
+        }
+
         UELib::Open(L);
 
         ObjectRegistry = new FObjectRegistry(this);
@@ -118,9 +141,7 @@ namespace UnLua
         AutoObjectReference.SetName("UnLua_AutoReference");
         ManualObjectReference.SetName("UnLua_ManualReference");
 
-        lua_pushstring(L, "StructMap"); // create weak table 'StructMap'
-        LowLevel::CreateWeakValueTable(L);
-        lua_rawset(L, LUA_REGISTRYINDEX);
+        StructIndex = new FLuaProxyIndex(L, true);
 
         lua_pushstring(L, "ArrayMap"); // create weak table 'ArrayMap'
         LowLevel::CreateWeakValueTable(L);
@@ -143,21 +164,20 @@ namespace UnLua
 
         FUnLuaDelegates::OnPreStaticallyExport.Broadcast();
 
-        // register statically exported classes
-        auto ExportedNonReflectedClasses = GetExportedNonReflectedClasses();
-        for (const auto& Pair : ExportedNonReflectedClasses)
-            Pair.Value->Register(L);
+        // statically exported classes and enums are registered on their first access from UE namespace by default
+        if (Settings->bRegisterStaticExportsOnStartup)
+        {
+            for (const auto& Pair : GetExportedNonReflectedClasses())
+                Pair.Value->Register(L);
+
+            for (const auto& Enum : GetExportedEnums())
+                Enum->Register(L);
+        }
 
-        // register statically exported global functions
-        auto ExportedFunctions = GetExportedFunctions();
-        for (const auto& Function : ExportedFunctions)
+        // register statically exported global functions, they live in _G and can't be resolved lazily
+        for (const auto& Function : GetExportedFunctions())
             Function->Register(L);
 
-        // register statically exported enums
-        auto ExportedEnums = GetExportedEnums();
-        for (const auto& Enum : ExportedEnums)
-            Enum->Register(L);
-
         UnLuaLib::Open(L);
 
         OnCreated.Broadcast(*this);
@@ -174,6 +194,12 @@ namespace UnLua
     FLuaEnv::~FLuaEnv()
     {
         OnDestroyed.Broadcast(*this);
+        delete TimerWheel;
+        delete CoroutineScheduler;
+        delete JobPool;
+        delete EventBus;
+        delete RPCBatcher;
+        delete ActorPool;
         lua_close(L);
         AllEnvs.Remove(L);
 
@@ -186,6 +212,7 @@ namespace UnLua
         delete PropertyRegistry;
         delete DanglingCheck;
         delete DeadLoopCheck;
+        delete StructIndex;
 
         if (!IsEngineExitRequested() && Manager)
         {
@@ -232,6 +259,20 @@ namespace UnLua
         if (bStarted)
             return;
 
+        if (Template)
+        {
+            const auto Guard = GetDeadLoopCheck()->MakeGuard();
+            const auto Top = lua_gettop(L);
+            for (const auto& Module : Template->GetModules())
+            {
+                lua_pushcfunction(L, ReportLuaCallError);
+                lua_getglobal(L, "require");
+                lua_pushstring(L, TCHAR_TO_UTF8(*Module.Name));
+                lua_pcall(L, 1, 0, -3);
+                lua_settop(L, Top);
+            }
+        }
+
         if (StartupModuleName.IsEmpty())
         {
             bStarted = true;
@@ -447,9 +488,19 @@ namespace UnLua
 
     void FLuaEnv::HotReload()
     {
+        // UnLua.HotReload() calls NotifyHotReloaded
         DoString("UnLua.HotReload()");
     }
 
+    void FLuaEnv::NotifyHotReloaded()
+    {
+        ++HotReloadGeneration;
+        PendingTemplateModules.Empty();
+        if (JobPool)
+            JobPool->Invalidate();
+        OnHotReloaded.Broadcast(*this);
+    }
+
     int32 FLuaEnv::FindThread(const lua_State* Thread)
     {
         int32* ThreadRefPtr = ThreadToRef.Find(Thread);
@@ -483,6 +534,48 @@ namespace UnLua
         luaL_unref(L, LUA_REGISTRYINDEX, ThreadRef); // remove the reference if the coroutine finishes its execution
     }
 
+    FLuaTimerWheel& FLuaEnv::GetTimerWheel()
+    {
+        if (!TimerWheel)
+            TimerWheel = new FLuaTimerWheel(this);
+        return *TimerWheel;
+    }
+
+    FLuaCoroutineScheduler& FLuaEnv::GetCoroutineScheduler()
+    {
+        if (!CoroutineScheduler)
+            CoroutineScheduler = new FLuaCoroutineScheduler(this);
+        return *CoroutineScheduler;
+    }
+
+    FLuaJobPool& FLuaEnv::GetJobPool()
+    {
+        if (!JobPool)
+            JobPool = new FLuaJobPool(this);
+        return *JobPool;
+    }
+
+    FLuaEventBus& FLuaEnv::GetEventBus()
+    {
+        if (!EventBus)
+            EventBus = new FLuaEventBus(this);
+        return *EventBus;
+    }
+
+    FLuaRPCBatcher& FLuaEnv::GetRPCBatcher()
+    {
+        if (!RPCBatcher)
+            RPCBatcher = new FLuaRPCBatcher(this);
+        return *RPCBatcher;
+    }
+
+    FLuaActorPool& FLuaEnv::GetActorPool()
+    {
+        if (!ActorPool)
+            ActorPool = new FLuaActorPool(this);
+        return *ActorPool;
+    }
+
     UUnLuaManager* FLuaEnv::GetManager()
     {
         if (!Manager)
@@ -526,6 +619,27 @@ namespace UnLua
     void FLuaEnv::AddLoader(const FLuaFileLoader Loader)
     {
         CustomLoaders.Add(Loader);
+        if (JobPool)
+            JobPool->Invalidate();
+    }
+
+    bool FLuaEnv::HasCustomLoaders() const
+    {
+        return FUnLuaDelegates::CustomLoadLuaFile.IsBound() || CustomLoaders.Num() > 0;
+    }
+
+    bool FLuaEnv::LoadFromCustomLoaders(const FString& ModuleName, TArray<uint8>& Data, FString& ChunkName)
+    {
+        // legacy support
+        if (FUnLuaDelegates::CustomLoadLuaFile.IsBound())
+            return FUnLuaDelegates::CustomLoadLuaFile.Execute(*this, ModuleName, Data, ChunkName);
+
+        for (auto& Loader : CustomLoaders)
+        {
+            if (Loader.Execute(*this, ModuleName, Data, ChunkName))
+                return true;
+        }
+        return false;
     }
 
     void FLuaEnv::AddBuiltInLoader(const FString InName, const lua_CFunction Loader)
@@ -596,37 +710,57 @@ namespace UnLua
 
     int FLuaEnv::LoadFromFileSystem(lua_State* L)
     {
-        FString FileName(UTF8_TO_TCHAR(lua_tostring(L, 1)));
-        FileName.ReplaceInline(TEXT("."), TEXT("/"));
+        const FString FileName(UTF8_TO_TCHAR(lua_tostring(L, 1)));
 
         auto& Env = *(FLuaEnv*)lua_touserdata(L, lua_upvalueindex(1));
         TArray<uint8> Data;
         FString FullPath;
+        if (!FindModuleFile(UnLuaLib::GetPackagePath(L), FileName, Data, FullPath))
+            return 0;
 
-        auto LoadIt = [&]
-        {
-            if (Env.LoadString(L, Data, FullPath))
-                return 1;
-            const auto Msg = FString::Printf(TEXT("file loading from file system error.\nfull path:%s"), *FullPath);
-            return luaL_error(L, TCHAR_TO_UTF8(*Msg));
-        };
+        if (Env.LoadString(L, Data, FullPath))
+            return 1;
+        const auto Msg = FString::Printf(TEXT("file loading from file system error.\nfull path:%s"), *FullPath);
+        return luaL_error(L, TCHAR_TO_UTF8(*Msg));
+    }
 
-        const auto PackagePath = UnLuaLib::GetPackagePath(L);
-        if (PackagePath.IsEmpty())
+    int FLuaEnv::LoadFromTemplate(lua_State* L)
+    {
+        auto& Env = *(FLuaEnv*)lua_touserdata(L, lua_upvalueindex(1));
+        const FString ModuleName(UTF8_TO_TCHAR(lua_tostring(L, 1)));
+        if (!Env.PendingTemplateModules.Remove(ModuleName))
             return 0;
 
+        const auto Module = Env.Template->Find(ModuleName);
+        const auto Bytes = (const char*)Module->Bytecode.GetData();
+        if (luaL_loadbufferx(L, Bytes, Module->Bytecode.Num(), lua_tostring(L, 1), "b") == LUA_OK)
+            return 1;
+
+        // e.g. a serialized template written by another lua build, fall back to the file system
+        UE_LOG(LogUnLua, Warning, TEXT("Failed to load module '%s' from env template: %s"), *ModuleName, UTF8_TO_TCHAR(lua_tostring(L, -1)));
+        lua_pop(L, 1);
+        return 0;
+    }
+
+    bool FLuaEnv::FindModuleFile(const FString& PackagePath, FString ModuleName, TArray<uint8>& Data, FString& FullPath)
+    {
+        if (PackagePath.IsEmpty())
+            return false;
+
         TArray<FString> Patterns;
         if (PackagePath.ParseIntoArray(Patterns, TEXT(";"), false) == 0)
-            return 0;
+            return false;
+
+        ModuleName.ReplaceInline(TEXT("."), TEXT("/"));
 
         // 优先加载下载目录下的单文件
         for (auto& Pattern : Patterns)
         {
-            Pattern.ReplaceInline(TEXT("?"), *FileName);
+            Pattern.ReplaceInline(TEXT("?"), *ModuleName);
             const auto PathWithPersistentDir = FPaths::Combine(FPaths::ProjectPersistentDownloadDir(), Pattern);
             FullPath = FPaths::ConvertRelativePathToFull(PathWithPersistentDir);
             if (FFileHelper::LoadFileToArray(Data, *FullPath, FILEREAD_Silent))
-                return LoadIt();
+                return true;
         }
 
         // 其次是打包目录下的文件
@@ -635,10 +769,10 @@ namespace UnLua
             const auto PathWithProjectDir = FPaths::Combine(FPaths::ProjectDir(), Pattern);
             FullPath = FPaths::ConvertRelativePathToFull(PathWithProjectDir);
             if (FFileHelper::LoadFileToArray(Data, *FullPath, FILEREAD_Silent))
-                return LoadIt();
+                return true;
         }
 
-        return 0;
+        return false;
     }
 
     void FLuaEnv::AddSearcher(lua_CFunction Searcher, int Index) const
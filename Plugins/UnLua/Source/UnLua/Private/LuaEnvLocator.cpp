@@ -14,6 +14,7 @@
 
 #include "Engine/World.h"
 #include "LuaEnvLocator.h"
+#include "UnLuaSettings.h"
 
 UnLua::FLuaEnv* ULuaEnvLocator::Locate(const UObject* Object)
 {
@@ -66,8 +67,17 @@ UnLua::FLuaEnv* ULuaEnvLocator_ByGameInstance::Locate(const UObject* Object)
     if (Exists)
         return (*Exists).Get();
 
-    const TSharedPtr<UnLua::FLuaEnv, ESPMode::ThreadSafe> Ret = MakeShared<UnLua::FLuaEnv, ESPMode::ThreadSafe>();
+    const TSharedPtr<UnLua::FLuaEnv, ESPMode::ThreadSafe> Ret = MakeShared<UnLua::FLuaEnv, ESPMode::ThreadSafe>(Template);
     Ret->SetName(FString::Printf(TEXT("Env_%d"), Envs.Num() + 1));
+
+    const auto& WarmStartModules = ::GetDefault<UUnLuaSettings>()->WarmStartModules;
+    if (!Template && WarmStartModules.Num() > 0)
+    {
+        // compile along the package path of a real env, as customized by its OnCreated handlers
+        Template = MakeShared<UnLua::FLuaEnvTemplate, ESPMode::ThreadSafe>();
+        Template->Build(*Ret, WarmStartModules);
+    }
+
     Ret->Start();
     Envs.Add(GameInstance, Ret);
     return Ret.Get();
@@ -79,6 +89,9 @@ void ULuaEnvLocator_ByGameInstance::HotReload()
         Env->HotReload();
     for (const auto& Pair : Envs)
         Pair.Value->HotReload();
+
+    // compiled again from the reloaded files for envs created later
+    Template.Reset();
 }
 
 void ULuaEnvLocator_ByGameInstance::Reset()
@@ -87,6 +100,7 @@ void ULuaEnvLocator_ByGameInstance::Reset()
     for (auto Pair : Envs)
         Pair.Value.Reset();
     Envs.Empty();
+    Template.Reset();
 }
 
 UnLua::FLuaEnv* ULuaEnvLocator_ByGameInstance::GetDefault()
@@ -0,0 +1,92 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#include "LuaEnvTemplate.h"
+#include "LuaEnv.h"
+#include "UnLuaBase.h"
+#include "UnLuaLib.h"
+
+namespace UnLua
+{
+    int32 FLuaEnvTemplate::Build(FLuaEnv& Env, const TArray<FString>& ModuleNames)
+    {
+        Reset();
+
+        TArray<FString> AllModuleNames;
+#if UNLUA_WITH_HOT_RELOAD
+        AllModuleNames.Add(TEXT("UnLua.HotReload"));
+#endif
+        for (const auto& ModuleName : ModuleNames)
+            AllModuleNames.AddUnique(ModuleName);
+
+        lua_State* L = Env.GetMainState();
+        const auto PackagePath = UnLuaLib::GetPackagePath(L);
+        for (const auto& ModuleName : AllModuleNames)
+        {
+            TArray<uint8> Data;
+            FString FullPath;
+            if (!FLuaEnv::FindModuleFile(PackagePath, ModuleName, Data, FullPath))
+            {
+                UE_LOG(LogUnLua, Warning, TEXT("Module '%s' of env template not found, it will be loaded normally."), *ModuleName);
+                continue;
+            }
+
+            // only compiles the chunk, the module is executed in each env created from the template
+            if (!Env.LoadString(L, Data, FullPath))
+            {
+                lua_pop(L, 2);
+                continue;
+            }
+
+            FModule Module;
+            Module.Name = ModuleName;
+            lua_dump(L, WriteBytecode, &Module.Bytecode, 0);
+            lua_pop(L, 1);
+            ModuleIndices.Add(ModuleName, Modules.Add(MoveTemp(Module)));
+        }
+
+        return Modules.Num();
+    }
+
+    const FLuaEnvTemplate::FModule* FLuaEnvTemplate::Find(const FString& ModuleName) const
+    {
+        const auto Index = ModuleIndices.Find(ModuleName);
+        return Index ? &Modules[*Index] : nullptr;
+    }
+
+    void FLuaEnvTemplate::Reset()
+    {
+        Modules.Empty();
+        ModuleIndices.Empty();
+    }
+
+    int FLuaEnvTemplate::WriteBytecode(lua_State* L, const void* Data, size_t Size, void* UserData)
+    {
+        static_cast<TArray<uint8>*>(UserData)->Append(static_cast<const uint8*>(Data), Size);
+        return 0;
+    }
+
+    FArchive& operator<<(FArchive& Ar, FLuaEnvTemplate& Template)
+    {
+        Ar << Template.Modules;
+        if (Ar.IsLoading())
+        {
+            Template.ModuleIndices.Empty(Template.Modules.Num());
+            for (int32 i = 0; i < Template.Modules.Num(); ++i)
+                Template.ModuleIndices.Add(Template.Modules[i].Name, i);
+        }
+        return Ar;
+    }
+}
@@ -0,0 +1,206 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+
+#include "LuaEventBus.h"
+#include "Algo/BinarySearch.h"
+#include "LuaEnv.h"
+#include "UnLuaBase.h"
+
+namespace UnLua
+{
+    FLuaEventBus::FLuaEventBus(FLuaEnv* InEnv)
+        : Env(InEnv)
+    {
+        // listener refs are released along with the lua state
+    }
+
+    lua_Integer FLuaEventBus::Subscribe(lua_State* L, int32 TopicIndex, int32 FunctionIndex)
+    {
+        FunctionIndex = lua_absindex(L, FunctionIndex);
+        const int32 Topic = FindTopic(L, TopicIndex, true);
+        const uint32 Id = NextId++;
+        lua_pushvalue(L, FunctionIndex);
+        Topics[Topic].Listeners.Add({luaL_ref(L, LUA_REGISTRYINDEX), Id});
+        return ((lua_Integer)(Topic + 1) << 32) | (lua_Integer)Id;
+    }
+
+    bool FLuaEventBus::Unsubscribe(lua_State* L, lua_Integer Handle)
+    {
+        const int64 Topic = (Handle >> 32) - 1;
+        if (Topic < 0 || Topic >= Topics.Num())
+            return false;
+
+        // ids are increasing and removal keeps the order
+        auto& Listeners = Topics[Topic].Listeners;
+        const uint32 Id = (uint32)(Handle & 0xffffffff);
+        const int32 Index = Algo::LowerBoundBy(Listeners, Id, &FListener::Id);
+        if (Index == Listeners.Num() || Listeners[Index].Id != Id || Listeners[Index].FunctionRef == LUA_NOREF)
+            return false;
+
+        luaL_unref(L, LUA_REGISTRYINDEX, Listeners[Index].FunctionRef);
+        Listeners[Index].FunctionRef = LUA_NOREF;
+        Topics[Topic].bHasRemoved = true;
+        if (Topics[Topic].DispatchDepth == 0)
+            Compact(Topics[Topic]);
+        return true;
+    }
+
+    int32 FLuaEventBus::Publish(lua_State* L, int32 TopicIndex)
+    {
+        TopicIndex = lua_absindex(L, TopicIndex);
+        const int32 NumArgs = lua_gettop(L) - TopicIndex;
+        const int32 Topic = FindTopic(L, TopicIndex, false);
+        if (Topic == INDEX_NONE)
+        {
+            lua_pop(L, NumArgs);
+            return 0;
+        }
+        return Dispatch(L, Topic, NumArgs);
+    }
+
+    int32 FLuaEventBus::NumListeners(FName Topic) const
+    {
+        const int32* Index = TopicIndices.Find(Topic);
+        if (!Index)
+            return 0;
+
+        int32 Num = 0;
+        for (const auto& Listener : Topics[*Index].Listeners)
+        {
+            if (Listener.FunctionRef != LUA_NOREF)
+                ++Num;
+        }
+        return Num;
+    }
+
+    int32 FLuaEventBus::FindTopic(lua_State* L, int32 NameIndex, bool bAdd)
+    {
+        NameIndex = lua_absindex(L, NameIndex);
+        if (TopicNamesRef == LUA_NOREF)
+        {
+            lua_newtable(L);
+            TopicNamesRef = luaL_ref(L, LUA_REGISTRYINDEX);
+        }
+
+        // lua strings are interned already, cache their topic index to skip the FName lookup
+        lua_rawgeti(L, LUA_REGISTRYINDEX, TopicNamesRef);
+        lua_pushvalue(L, NameIndex);
+        if (lua_rawget(L, -2) == LUA_TNUMBER)
+        {
+            const int32 Topic = (int32)lua_tointeger(L, -1);
+            lua_pop(L, 2);
+            return Topic;
+        }
+        lua_pop(L, 1);
+
+        const FName Name(UTF8_TO_TCHAR(lua_tostring(L, NameIndex)));
+        int32 Topic;
+        if (bAdd)
+        {
+            Topic = FindOrAddTopic(Name);
+        }
+        else
+        {
+            const int32* Found = TopicIndices.Find(Name);
+            if (!Found)
+            {
+                lua_pop(L, 1);
+                return INDEX_NONE;
+            }
+            Topic = *Found;
+        }
+
+        lua_pushvalue(L, NameIndex);
+        lua_pushinteger(L, Topic);
+        lua_rawset(L, -3);
+        lua_pop(L, 1);
+        return Topic;
+    }
+
+    int32 FLuaEventBus::FindOrAddTopic(FName Name)
+    {
+        if (const int32* Found = TopicIndices.Find(Name))
+            return *Found;
+
+        const int32 Topic = Topics.AddDefaulted();
+        Topics[Topic].Name = Name;
+        TopicIndices.Add(Name, Topic);
+        return Topic;
+    }
+
+    int32 FLuaEventBus::Dispatch(lua_State* L, int32 Topic, int32 NumArgs)
+    {
+        FDispatch State = {this, Topic, 0, Topics[Topic].Listeners.Num(), 0};
+        if (State.End == 0)
+        {
+            lua_pop(L, NumArgs);
+            return 0;
+        }
+
+        const int32 ArgsIndex = lua_gettop(L) - NumArgs + 1;
+        lua_pushcfunction(L, ReportLuaCallError);
+        const int32 HandlerIndex = lua_gettop(L);
+
+        ++Topics[Topic].DispatchDepth;
+        while (State.Cursor < State.End)
+        {
+            // the cursor is past the failed listener if one raises an error, go on from there
+            if (!lua_checkstack(L, NumArgs + 2))
+                break;
+            lua_pushcfunction(L, DispatchListeners);
+            lua_pushlightuserdata(L, &State);
+            for (int32 i = 0; i < NumArgs; ++i)
+                lua_pushvalue(L, ArgsIndex + i);
+            lua_pcall(L, NumArgs + 1, 0, HandlerIndex);
+            lua_settop(L, HandlerIndex);
+        }
+
+        // topics may have been added by the listeners
+        FTopic& Dispatched = Topics[Topic];
+        if (--Dispatched.DispatchDepth == 0 && Dispatched.bHasRemoved)
+            Compact(Dispatched);
+
+        lua_settop(L, ArgsIndex - 1);
+        return State.NumCalled;
+    }
+
+    int FLuaEventBus::DispatchListeners(lua_State* L)
+    {
+        const auto State = (FDispatch*)lua_touserdata(L, 1);
+        const int32 NumArgs = lua_gettop(L) - 1;
+        while (State->Cursor < State->End)
+        {
+            // listeners added during the dispatch may grow the array, never keep a pointer into it
+            const int32 FunctionRef = State->Bus->Topics[State->Topic].Listeners[State->Cursor++].FunctionRef;
+            if (FunctionRef == LUA_NOREF)
+                continue;
+
+            luaL_checkstack(L, NumArgs + 1, nullptr);
+            lua_rawgeti(L, LUA_REGISTRYINDEX, FunctionRef);
+            for (int32 i = 2; i <= NumArgs + 1; ++i)
+                lua_pushvalue(L, i);
+            ++State->NumCalled;
+            lua_call(L, NumArgs, 0);
+        }
+        return 0;
+    }
+
+    void FLuaEventBus::Compact(FTopic& Topic)
+    {
+        Topic.Listeners.RemoveAll([](const FListener& Listener) { return Listener.FunctionRef == LUA_NOREF; });
+        Topic.bHasRemoved = false;
+    }
+}
@@ -0,0 +1,660 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#include "LuaJobPool.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "LuaEnv.h"
+#include "LuaCoroutineScheduler.h"
+#include "UnLuaBase.h"
+#include "UnLuaLib.h"
+#include "UnLuaSettings.h"
+
+namespace UnLua
+{
+    static constexpr int32 MaxSerializeDepth = 32;
+
+    /** Instructions run between two checks of the cancel flag */
+    static constexpr int32 CancelCheckInterval = 1000;
+
+    /** Seconds the pool waits for its running jobs to cancel when destroyed */
+    static constexpr double CancelTimeout = 5.0;
+
+    struct FJobCall
+    {
+        const char* ModuleName;
+        const char* FunctionName;
+        const TArray<uint8>* Args;
+    };
+
+    enum class ESerializedTag : uint8
+    {
+        Nil,
+        False,
+        True,
+        Integer,
+        Number,
+        String,
+        Table,
+        End,
+    };
+
+    static const FName NAME_LuaJob("LuaJob");
+
+    static int Traceback(lua_State* L)
+    {
+        const char* Msg = lua_tostring(L, 1);
+        luaL_traceback(L, L, Msg ? Msg : "(error object is not a string)", 1);
+        return 1;
+    }
+
+    template <typename T>
+    static void Write(TArray<uint8>& Buffer, const T& Value)
+    {
+        Buffer.Append(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+    }
+
+    template <typename T>
+    static T Read(const TArray<uint8>& Buffer, int32& Offset)
+    {
+        T Value;
+        FMemory::Memcpy(&Value, Buffer.GetData() + Offset, sizeof(T));
+        Offset += sizeof(T);
+        return Value;
+    }
+
+    static bool SerializeValue(lua_State* L, int32 Index, TArray<uint8>& Buffer, FString& Error, int32 Depth)
+    {
+        switch (lua_type(L, Index))
+        {
+        case LUA_TNONE:
+        case LUA_TNIL:
+            Buffer.Add((uint8)ESerializedTag::Nil);
+            return true;
+        case LUA_TBOOLEAN:
+            Buffer.Add((uint8)(lua_toboolean(L, Index) ? ESerializedTag::True : ESerializedTag::False));
+            return true;
+        case LUA_TNUMBER:
+            if (lua_isinteger(L, Index))
+            {
+                Buffer.Add((uint8)ESerializedTag::Integer);
+                Write<lua_Integer>(Buffer, lua_tointeger(L, Index));
+            }
+            else
+            {
+                Buffer.Add((uint8)ESerializedTag::Number);
+                Write<lua_Number>(Buffer, lua_tonumber(L, Index));
+            }
+            return true;
+        case LUA_TSTRING:
+            {
+                size_t Len;
+                const char* Str = lua_tolstring(L, Index, &Len);
+                Buffer.Add((uint8)ESerializedTag::String);
+                Write<uint32>(Buffer, (uint32)Len);
+                Buffer.Append(reinterpret_cast<const uint8*>(Str), Len);
+                return true;
+            }
+        case LUA_TTABLE:
+            {
+                if (Depth >= MaxSerializeDepth)
+                {
+                    Error = TEXT("table is cyclic or nested too deep");
+                    return false;
+                }
+                if (!lua_checkstack(L, 3))
+                {
+                    Error = TEXT("stack overflow");
+                    return false;
+                }
+
+                Index = lua_absindex(L, Index);
+                Buffer.Add((uint8)ESerializedTag::Table);
+                lua_pushnil(L);
+                while (lua_next(L, Index) != 0)
+                {
+                    if (!SerializeValue(L, -2, Buffer, Error, Depth + 1) || !SerializeValue(L, -1, Buffer, Error, Depth + 1))
+                    {
+                        lua_pop(L, 2);
+                        return false;
+                    }
+                    lua_pop(L, 1);
+                }
+                Buffer.Add((uint8)ESerializedTag::End);
+                return true;
+            }
+        default:
+            Error = FString::Printf(TEXT("can't pass a %s value to a job"), UTF8_TO_TCHAR(luaL_typename(L, Index)));
+            return false;
+        }
+    }
+
+    static void DeserializeValue(lua_State* L, const TArray<uint8>& Buffer, int32& Offset)
+    {
+        const auto Tag = (ESerializedTag)Buffer[Offset++];
+        switch (Tag)
+        {
+        case ESerializedTag::False:
+            lua_pushboolean(L, false);
+            break;
+        case ESerializedTag::True:
+            lua_pushboolean(L, true);
+            break;
+        case ESerializedTag::Integer:
+            lua_pushinteger(L, Read<lua_Integer>(Buffer, Offset));
+            break;
+        case ESerializedTag::Number:
+            lua_pushnumber(L, Read<lua_Number>(Buffer, Offset));
+            break;
+        case ESerializedTag::String:
+            {
+                const uint32 Len = Read<uint32>(Buffer, Offset);
+                lua_pushlstring(L, reinterpret_cast<const char*>(Buffer.GetData() + Offset), Len);
+                Offset += Len;
+                break;
+            }
+        case ESerializedTag::Table:
+            lua_checkstack(L, 3);
+            lua_newtable(L);
+            while ((ESerializedTag)Buffer[Offset] != ESerializedTag::End)
+            {
+                DeserializeValue(L, Buffer, Offset);
+                DeserializeValue(L, Buffer, Offset);
+                lua_rawset(L, -3);
+            }
+            ++Offset;
+            break;
+        default:
+            lua_pushnil(L);
+            break;
+        }
+    }
+
+    FLuaJobEnv::FLuaJobEnv(FLuaJobPoolState* InState, const FString& InPackagePath, uint32 InGeneration)
+        : State(InState), PackagePath(InPackagePath), Generation(InGeneration)
+    {
+        // the allocator ignores its userdata, it gives the hook access to the job env
+        L = lua_newstate(FLuaEnv::DefaultLuaAllocator, this);
+        if (!L)
+        {
+            UE_LOG(LogUnLua, Error, TEXT("failed to create the lua state of a job env"));
+            return;
+        }
+        lua_atpanic(L, Panic);
+
+        static const luaL_Reg Libs[] = {
+            {"_G", luaopen_base},
+            {LUA_COLIBNAME, luaopen_coroutine},
+            {LUA_TABLIBNAME, luaopen_table},
+            {LUA_STRLIBNAME, luaopen_string},
+            {LUA_MATHLIBNAME, luaopen_math},
+            {LUA_UTF8LIBNAME, luaopen_utf8},
+            {nullptr, nullptr}
+        };
+        for (const luaL_Reg* Lib = Libs; Lib->func; ++Lib)
+        {
+            luaL_requiref(L, Lib->name, Lib->func, 1);
+            lua_pop(L, 1);
+        }
+
+        // no file system access except loading modules
+        lua_pushnil(L);
+        lua_setglobal(L, "dofile");
+        lua_pushnil(L);
+        lua_setglobal(L, "loadfile");
+
+        lua_pushlightuserdata(L, this);
+        lua_pushcclosure(L, Require, 1);
+        lua_setglobal(L, "require");
+        lua_register(L, "print", Print);
+    }
+
+    FLuaJobEnv::~FLuaJobEnv()
+    {
+        if (L)
+            lua_close(L);
+    }
+
+    void FLuaJobEnv::Run(FLuaJob& Job)
+    {
+        // converted before the protected call, lua errors may longjmp
+        const FTCHARToUTF8 ModuleName(*Job.ModuleName);
+        const FTCHARToUTF8 FunctionName(*Job.FunctionName);
+        FJobCall Call{ModuleName.Get(), FunctionName.Get(), &Job.Args};
+
+        lua_settop(L, 0);
+        lua_pushcfunction(L, Traceback);
+        lua_pushcfunction(L, RunProtected);
+        lua_pushlightuserdata(L, &Call);
+        lua_sethook(L, CancelHook, LUA_MASKCOUNT, CancelCheckInterval);
+        const int32 Code = lua_pcall(L, 1, 1, 1);
+        lua_sethook(L, nullptr, 0, 0);
+        if (Code != LUA_OK)
+        {
+            Job.Error = UTF8_TO_TCHAR(lua_tostring(L, -1));
+            lua_settop(L, 0);
+            return;
+        }
+
+        Job.bSucceeded = FLuaJobPool::Serialize(L, -1, Job.Result, Job.Error);
+        lua_settop(L, 0);
+    }
+
+    int FLuaJobEnv::RunProtected(lua_State* L)
+    {
+        const auto& Call = *(FJobCall*)lua_touserdata(L, 1);
+        lua_getglobal(L, "require");
+        lua_pushstring(L, Call.ModuleName);
+        lua_call(L, 1, 1);
+
+        if (lua_istable(L, -1))
+            lua_getfield(L, -1, Call.FunctionName);
+        if (!lua_isfunction(L, -1))
+            return luaL_error(L, "function %s not found in module %s", Call.FunctionName, Call.ModuleName);
+
+        FLuaJobPool::Deserialize(L, *Call.Args);
+        lua_call(L, 1, 1);
+        return 1;
+    }
+
+    void FLuaJobEnv::CancelHook(lua_State* L, lua_Debug* ar)
+    {
+        void* JobEnv;
+        lua_getallocf(L, &JobEnv);
+        if (((FLuaJobEnv*)JobEnv)->State->bCancelled)
+            luaL_error(L, "job cancelled");
+    }
+
+    int FLuaJobEnv::Panic(lua_State* L)
+    {
+        const char* Msg = lua_tostring(L, -1);
+        UE_LOG(LogUnLua, Fatal, TEXT("unprotected error in lua job: %s"), Msg ? UTF8_TO_TCHAR(Msg) : TEXT("(error object is not a string)"));
+        return 0;
+    }
+
+    int FLuaJobEnv::Require(lua_State* L)
+    {
+        const char* ModuleName = luaL_checkstring(L, 1);
+        lua_settop(L, 1);
+        luaL_getsubtable(L, LUA_REGISTRYINDEX, LUA_LOADED_TABLE);
+        lua_getfield(L, 2, ModuleName);
+        if (lua_toboolean(L, -1))
+            return 1;
+        lua_pop(L, 1);
+
+        // raise errors after the buffers are released, lua errors may longjmp
+        const auto& JobEnv = *(FLuaJobEnv*)lua_touserdata(L, lua_upvalueindex(1));
+        int32 Code = LUA_ERRFILE;
+        {
+            TArray<uint8> Data;
+            FString FullPath(TEXT("chunk"));
+            if (JobEnv.State->LoadFromCustomLoaders(UTF8_TO_TCHAR(ModuleName), Data, FullPath)
+                || FLuaEnv::FindModuleFile(JobEnv.PackagePath, UTF8_TO_TCHAR(ModuleName), Data, FullPath))
+            {
+                const char* Chunk = (const char*)Data.GetData();
+                size_t Size = Data.Num();
+                if (Size >= 3 && Chunk[0] == static_cast<char>(0xEF) && Chunk[1] == static_cast<char>(0xBB) && Chunk[2] == static_cast<char>(0xBF))
+                {
+                    Chunk += 3;
+                    Size -= 3;
+                }
+                Code = luaL_loadbufferx(L, Chunk, Size, TCHAR_TO_UTF8(*FullPath), nullptr);
+            }
+        }
+        if (Code == LUA_ERRFILE)
+            return luaL_error(L, "module '%s' not found", ModuleName);
+        if (Code != LUA_OK)
+            return lua_error(L);
+
+        lua_pushvalue(L, 1);
+        lua_call(L, 1, 1);
+        if (lua_isnil(L, -1))
+        {
+            lua_pop(L, 1);
+            lua_pushboolean(L, true);
+        }
+        lua_pushvalue(L, -1);
+        lua_setfield(L, 2, ModuleName);
+        return 1;
+    }
+
+    int FLuaJobEnv::Print(lua_State* L)
+    {
+        FString Message;
+        const int32 ArgCount = lua_gettop(L);
+        for (int32 ArgIndex = 1; ArgIndex <= ArgCount; ++ArgIndex)
+        {
+            if (ArgIndex > 1)
+                Message += TEXT("\t");
+            Message += UTF8_TO_TCHAR(luaL_tolstring(L, ArgIndex, nullptr));
+            lua_pop(L, 1);
+        }
+        UE_LOG(LogUnLua, Log, TEXT("%s"), *Message);
+        return 0;
+    }
+
+    FLuaJobPoolState::~FLuaJobPoolState()
+    {
+        // callback refs are released along with the lua state
+        FLuaJob* Job;
+        while (Pending.Dequeue(Job))
+            delete Job;
+        while (Completed.Dequeue(Job))
+            delete Job;
+
+        for (const auto JobEnv : FreeEnvs)
+            delete JobEnv;
+    }
+
+    bool FLuaJobPoolState::LoadFromCustomLoaders(const FString& ModuleName, TArray<uint8>& Data, FString& ChunkName)
+    {
+        FLoadRequest Request;
+        Request.ModuleName = ModuleName;
+        {
+            FScopeLock ScopeLock(&Lock);
+            if (!bCustomLoaders || bCancelled)
+                return false;
+            Request.Done = FPlatformProcess::GetSynchEventFromPool();
+            LoadRequests.Add(&Request);
+        }
+
+        Request.Done->Wait();
+        FPlatformProcess::ReturnSynchEventToPool(Request.Done);
+        if (!Request.bFound)
+            return false;
+
+        Data = MoveTemp(Request.Data);
+        ChunkName = MoveTemp(Request.ChunkName);
+        return true;
+    }
+
+    FLuaJobPool::FLuaJobPool(FLuaEnv* InEnv)
+        : Env(InEnv), State(MakeShared<FLuaJobPoolState, ESPMode::ThreadSafe>())
+    {
+        const int32 MaxJobEnvs = GetDefault<UUnLuaSettings>()->MaxJobEnvs;
+        MaxEnvs = MaxJobEnvs > 0 ? MaxJobEnvs : FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1);
+        State->PackagePath = UnLuaLib::GetPackagePath(Env->GetMainState());
+        State->bCustomLoaders = Env->HasCustomLoaders();
+        TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FLuaJobPool::Tick));
+    }
+
+    FLuaJobPool::~FLuaJobPool()
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+        // running jobs raise an error at their next hook
+        State->bCancelled = true;
+
+        // running workers still use their job envs, the modules they wait for are not loaded anymore
+        const double StartTime = FPlatformTime::Seconds();
+        int32 NumRunning;
+        while (true)
+        {
+            {
+                FScopeLock ScopeLock(&State->Lock);
+                FLuaJob* Job;
+                while (State->Pending.Dequeue(Job))
+                    delete Job;
+                for (const auto Request : State->LoadRequests)
+                    Request->Done->Trigger();
+                State->LoadRequests.Empty();
+                NumRunning = State->NumWorkers;
+            }
+            if (NumRunning == 0 || FPlatformTime::Seconds() - StartTime > CancelTimeout)
+                break;
+            FPlatformProcess::Sleep(0.001f);
+        }
+
+        // a job stuck in a C function never reaches the hook, its worker drops it and releases the state once done
+        if (NumRunning > 0)
+            UE_LOG(LogUnLua, Warning, TEXT("%d lua job(s) not cancelled after %.0f seconds, left to finish in the background"), NumRunning, CancelTimeout);
+    }
+
+    uint32 FLuaJobPool::Submit(const FString& ModuleName, const FString& FunctionName, TArray<uint8>&& Args, FOnCompleted&& OnCompleted)
+    {
+        check(IsInGameThread());
+
+        if (++LastId == 0)
+            ++LastId;
+
+        const auto Job = new FLuaJob;
+        Job->Id = LastId;
+        Job->ModuleName = ModuleName;
+        Job->FunctionName = FunctionName;
+        Job->Args = MoveTemp(Args);
+        Job->OnCompleted = MoveTemp(OnCompleted);
+
+        bool bDispatch = false;
+        {
+            FScopeLock ScopeLock(&State->Lock);
+            State->Pending.Enqueue(Job);
+            if (State->NumWorkers < MaxEnvs)
+            {
+                ++State->NumWorkers;
+                bDispatch = true;
+            }
+        }
+
+        if (bDispatch)
+            FFunctionGraphTask::CreateAndDispatchWhenReady([StateRef = State] { RunWorker(StateRef); }, TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask);
+
+        return LastId;
+    }
+
+    uint32 FLuaJobPool::Submit(lua_State* L, int32 ModuleIndex)
+    {
+        const int32 CallbackIndex = lua_absindex(L, ModuleIndex + 3);
+        const bool bHasCallback = !lua_isnoneornil(L, CallbackIndex);
+        if (bHasCallback)
+            luaL_checktype(L, CallbackIndex, LUA_TFUNCTION);
+
+        return Submit(L, ModuleIndex, [&]() -> FOnCompleted
+        {
+            int32 CallbackRef = LUA_NOREF;
+            if (bHasCallback)
+            {
+                lua_pushvalue(L, CallbackIndex);
+                CallbackRef = luaL_ref(L, LUA_REGISTRYINDEX);
+            }
+            return [this, CallbackRef](FLuaJob& Job)
+            {
+                if (CallbackRef == LUA_NOREF)
+                {
+                    if (!Job.bSucceeded)
+                        UE_LOG(LogUnLua, Warning, TEXT("job %s.%s failed: %s"), *Job.ModuleName, *Job.FunctionName, *Job.Error);
+                    return;
+                }
+
+                const auto MainState = Env->GetMainState();
+                const int32 Top = lua_gettop(MainState);
+                lua_pushcfunction(MainState, ReportLuaCallError);
+                lua_rawgeti(MainState, LUA_REGISTRYINDEX, CallbackRef);
+                luaL_unref(MainState, LUA_REGISTRYINDEX, CallbackRef);
+                PushResult(MainState, Job);
+                lua_pcall(MainState, 2, 0, Top + 1);
+                lua_settop(MainState, Top);
+            };
+        });
+    }
+
+    int FLuaJobPool::Await(lua_State* L, int32 ModuleIndex)
+    {
+        if (!lua_isyieldable(L))
+            return luaL_error(L, "attempt to wait outside a coroutine");
+
+        const uint32 Id = Submit(L, ModuleIndex, [this]() -> FOnCompleted
+        {
+            return [this](FLuaJob& Job)
+            {
+                const auto MainState = Env->GetMainState();
+                if (Job.bSucceeded)
+                {
+                    Deserialize(MainState, Job.Result);
+                }
+                else
+                {
+                    UE_LOG(LogUnLua, Warning, TEXT("job %s.%s failed: %s"), *Job.ModuleName, *Job.FunctionName, *Job.Error);
+                    lua_pushnil(MainState);
+                }
+                Env->GetCoroutineScheduler().SignalEvent(MainState, FName(NAME_LuaJob, (int32)Job.Id), -1);
+                lua_pop(MainState, 1);
+            };
+        });
+        return Env->GetCoroutineScheduler().WaitEvent(L, FName(NAME_LuaJob, (int32)Id));
+    }
+
+    uint32 FLuaJobPool::Submit(lua_State* L, int32 ModuleIndex, TFunctionRef<FOnCompleted()> MakeOnCompleted)
+    {
+        const char* ModuleName = luaL_checkstring(L, ModuleIndex);
+        const char* FunctionName = luaL_checkstring(L, ModuleIndex + 1);
+        {
+            TArray<uint8> Args;
+            FString Error;
+            if (Serialize(L, ModuleIndex + 2, Args, Error))
+                return Submit(UTF8_TO_TCHAR(ModuleName), UTF8_TO_TCHAR(FunctionName), MoveTemp(Args), MakeOnCompleted());
+            lua_pushfstring(L, "invalid job arguments, %s", TCHAR_TO_UTF8(*Error));
+        }
+        lua_error(L);
+        return 0;
+    }
+
+    int32 FLuaJobPool::Flush()
+    {
+        int32 Count = 0;
+        FLuaJob* Job;
+        while (State->Completed.Dequeue(Job))
+        {
+            if (Job->OnCompleted)
+                Job->OnCompleted(*Job);
+            delete Job;
+            ++Count;
+        }
+        return Count;
+    }
+
+    void FLuaJobPool::Invalidate()
+    {
+        const FString NewPackagePath = UnLuaLib::GetPackagePath(Env->GetMainState());
+        FScopeLock ScopeLock(&State->Lock);
+        State->PackagePath = NewPackagePath;
+        State->bCustomLoaders = Env->HasCustomLoaders();
+        ++State->Generation;
+    }
+
+    void FLuaJobPool::ServeLoadRequests()
+    {
+        TArray<FLuaJobPoolState::FLoadRequest*> Requests;
+        {
+            FScopeLock ScopeLock(&State->Lock);
+            Requests = MoveTemp(State->LoadRequests);
+        }
+
+        for (const auto Request : Requests)
+        {
+            Request->ChunkName = TEXT("chunk");
+            Request->bFound = Env->LoadFromCustomLoaders(Request->ModuleName, Request->Data, Request->ChunkName);
+            Request->Done->Trigger();
+        }
+    }
+
+    bool FLuaJobPool::Serialize(lua_State* L, int32 Index, TArray<uint8>& Buffer, FString& Error)
+    {
+        return SerializeValue(L, Index, Buffer, Error, 0);
+    }
+
+    void FLuaJobPool::Deserialize(lua_State* L, const TArray<uint8>& Buffer)
+    {
+        if (Buffer.Num() == 0)
+        {
+            lua_pushnil(L);
+            return;
+        }
+        int32 Offset = 0;
+        DeserializeValue(L, Buffer, Offset);
+    }
+
+    bool FLuaJobPool::Tick(float DeltaTime)
+    {
+        ServeLoadRequests();
+        Flush();
+        return true;
+    }
+
+    void FLuaJobPool::RunWorker(const FStateRef& State)
+    {
+        FLuaJobEnv* JobEnv = nullptr;
+        while (true)
+        {
+            FLuaJob* Job;
+            FLuaJobEnv* StaleEnv = nullptr;
+            FString NewPackagePath;
+            uint32 NewGeneration = 0;
+            bool bCreateEnv = false;
+            {
+                FScopeLock ScopeLock(&State->Lock);
+                if (!State->Pending.Dequeue(Job))
+                {
+                    if (JobEnv)
+                        State->FreeEnvs.Add(JobEnv);
+                    --State->NumWorkers;
+                    return;
+                }
+
+                if (!JobEnv && State->FreeEnvs.Num() > 0)
+                    JobEnv = State->FreeEnvs.Pop(false);
+
+                if (!JobEnv || JobEnv->GetGeneration() != State->Generation)
+                {
+                    StaleEnv = JobEnv;
+                    NewPackagePath = State->PackagePath;
+                    NewGeneration = State->Generation;
+                    bCreateEnv = true;
+                }
+            }
+
+            if (bCreateEnv)
+            {
+                delete StaleEnv;
+                JobEnv = new FLuaJobEnv(&State.Get(), NewPackagePath, NewGeneration);
+            }
+
+            if (JobEnv->IsValid())
+            {
+                JobEnv->Run(*Job);
+            }
+            else
+            {
+                // out of memory, the next job tries again with a new env
+                Job->Error = TEXT("failed to create the lua state of a job env");
+                delete JobEnv;
+                JobEnv = nullptr;
+            }
+            State->Completed.Enqueue(Job);
+        }
+    }
+
+    void FLuaJobPool::PushResult(lua_State* L, FLuaJob& Job)
+    {
+        if (Job.bSucceeded)
+        {
+            Deserialize(L, Job.Result);
+            lua_pushnil(L);
+        }
+        else
+        {
+            lua_pushnil(L);
+            lua_pushstring(L, TCHAR_TO_UTF8(*Job.Error));
+        }
+    }
+}
@@ -0,0 +1,184 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "Containers/Ticker.h"
+#include "UnLuaCompatibility.h"
+#include "lua.hpp"
+
+namespace UnLua
+{
+    class FLuaEnv;
+    class FLuaJobEnv;
+
+    /**
+     * A job submitted to the worker Lua states. Arguments and result are Lua values serialized by
+     * FLuaJobPool::Serialize, the job runs require(ModuleName)[FunctionName](Args).
+     */
+    struct FLuaJob
+    {
+        uint32 Id = 0;
+        FString ModuleName;
+        FString FunctionName;
+        TArray<uint8> Args;
+        TArray<uint8> Result;
+        FString Error;
+        bool bSucceeded = false;
+        TUniqueFunction<void(FLuaJob&)> OnCompleted;
+    };
+
+    /**
+     * State shared by a job pool and its workers. A job stuck in a C function never reaches the cancel hook, its worker
+     * keeps the state alive after the pool is destroyed and drops the job once it returns.
+     */
+    struct FLuaJobPoolState
+    {
+        struct FLoadRequest
+        {
+            FString ModuleName;
+            TArray<uint8> Data;
+            FString ChunkName;
+            bool bFound = false;
+            FEvent* Done = nullptr;
+        };
+
+        ~FLuaJobPoolState();
+
+        /**
+         * Load a module with the custom loaders of the env, called by workers and served on the game thread.
+         * @return false if no custom loader found the module or the pool is being destroyed
+         */
+        bool LoadFromCustomLoaders(const FString& ModuleName, TArray<uint8>& Data, FString& ChunkName);
+
+        FCriticalSection Lock;
+        TQueue<FLuaJob*> Pending;
+        TQueue<FLuaJob*, EQueueMode::Mpsc> Completed;
+        TArray<FLuaJobEnv*> FreeEnvs;
+        TArray<FLoadRequest*> LoadRequests;
+        FThreadSafeBool bCancelled;
+        bool bCustomLoaders = false;
+        FString PackagePath;
+        uint32 Generation = 0;
+        int32 NumWorkers = 0;
+    };
+
+    /**
+     * Sandboxed Lua state running jobs on a worker thread. Only the pure Lua libraries are opened, there is no
+     * access to UObjects, and modules are loaded by the custom loaders or from the package path of the owner env.
+     */
+    class FLuaJobEnv
+    {
+    public:
+        FLuaJobEnv(FLuaJobPoolState* InState, const FString& InPackagePath, uint32 InGeneration);
+
+        ~FLuaJobEnv();
+
+        /** @return false if the Lua state couldn't be allocated */
+        bool IsValid() const { return L != nullptr; }
+
+        void Run(FLuaJob& Job);
+
+        uint32 GetGeneration() const { return Generation; }
+
+    private:
+        /** Load, call and pass the arguments to the job function, arguments are deserialized under the protected call */
+        static int RunProtected(lua_State* L);
+
+        /** Abort the running job once the pool is being destroyed */
+        static void CancelHook(lua_State* L, lua_Debug* ar);
+
+        static int Panic(lua_State* L);
+
+        static int Require(lua_State* L);
+
+        static int Print(lua_State* L);
+
+        lua_State* L;
+        FLuaJobPoolState* State;
+        FString PackagePath;
+        uint32 Generation;
+    };
+
+    /**
+     * Pool of worker Lua states. Jobs are queued and run on task graph workers, each worker owns one job env
+     * while it drains the queue. Completion callbacks and custom loaders are always called on the game thread.
+     */
+    class FLuaJobPool
+    {
+    public:
+        explicit FLuaJobPool(FLuaEnv* InEnv);
+
+        ~FLuaJobPool();
+
+        typedef TUniqueFunction<void(FLuaJob&)> FOnCompleted;
+
+        uint32 Submit(const FString& ModuleName, const FString& FunctionName, TArray<uint8>&& Args, FOnCompleted&& OnCompleted);
+
+        /**
+         * Submit a job with the module name, function name, arguments and an optional callback at the given stack index,
+         * the callback is called with the result, or with nil and the error message.
+         * @return id of the job
+         */
+        uint32 Submit(lua_State* L, int32 ModuleIndex);
+
+        /** Submit a job like Submit, suspend the running coroutine until the job is completed and return its result. */
+        int Await(lua_State* L, int32 ModuleIndex);
+
+        /** Call the callbacks of all completed jobs. */
+        int32 Flush();
+
+        /** Drop the modules loaded by worker states, each state is recreated before running its next job. */
+        void Invalidate();
+
+        /**
+         * Load the modules workers are waiting for with the custom loaders, done by the core ticker. Call it when
+         * waiting for jobs on the game thread, the jobs requiring a module would never complete otherwise.
+         */
+        void ServeLoadRequests();
+
+        int32 GetMaxEnvs() const { return MaxEnvs; }
+
+        /** Serialize nil, booleans, numbers, strings and tables of them. Cyclic or too deep tables are rejected. */
+        static bool Serialize(lua_State* L, int32 Index, TArray<uint8>& Buffer, FString& Error);
+
+        /** Push the value serialized in the buffer. */
+        static void Deserialize(lua_State* L, const TArray<uint8>& Buffer);
+
+    private:
+        typedef TSharedRef<FLuaJobPoolState, ESPMode::ThreadSafe> FStateRef;
+
+        bool Tick(float DeltaTime);
+
+        /** The completion callback is made only once the arguments are serialized, lua errors may longjmp. */
+        uint32 Submit(lua_State* L, int32 ModuleIndex, TFunctionRef<FOnCompleted()> MakeOnCompleted);
+
+        static void RunWorker(const FStateRef& State);
+
+        static void PushResult(lua_State* L, FLuaJob& Job);
+
+        FLuaEnv* Env;
+        FStateRef State;
+        int32 MaxEnvs;
+        uint32 LastId = 0;
+#if ENGINE_MAJOR_VERSION >= 5
+        FTSTicker::FDelegateHandle TickerHandle;
+#else
+        FDelegateHandle TickerHandle;
+#endif
+    };
+}
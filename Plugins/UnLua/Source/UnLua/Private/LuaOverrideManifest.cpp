@@ -0,0 +1,208 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#include "LuaOverrideManifest.h"
+#include "Animation/AnimInstance.h"
+#include "Dom/JsonObject.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "LowLevel.h"
+#include "LuaEnv.h"
+#include "LuaFunction.h"
+#include "UnLuaManager.h"
+#include "UnLuaSettings.h"
+
+namespace UnLua
+{
+    static const FName NAME_ReceiveTick("ReceiveTick");
+
+    FLuaOverrideManifest& FLuaOverrideManifest::Get()
+    {
+        static FLuaOverrideManifest Manifest;
+        static bool bLoaded = false;
+        if (!bLoaded)
+        {
+            bLoaded = true;
+            // scripts may differ from the manifest while editing
+            if (FPlatformProperties::RequiresCookedData() && GetDefault<UUnLuaSettings>()->bUseOverrideManifest)
+                Manifest.Load(GetDefaultPath());
+        }
+        return Manifest;
+    }
+
+    FString FLuaOverrideManifest::GetDefaultPath()
+    {
+        return FPaths::ProjectContentDir() / TEXT("Script/UnLuaOverrides.json");
+    }
+
+    bool FLuaOverrideManifest::Load(const FString& FilePath)
+    {
+        FString Content;
+        if (!FFileHelper::LoadFileToString(Content, *FilePath))
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("Failed to load override manifest %s"), *FilePath);
+            return false;
+        }
+
+        TSharedPtr<FJsonObject> Root;
+        const auto Reader = TJsonReaderFactory<>::Create(Content);
+        const TArray<TSharedPtr<FJsonValue>>* Classes;
+        if (!FJsonSerializer::Deserialize(Reader, Root) || !Root.IsValid() || !Root->TryGetArrayField(TEXT("classes"), Classes))
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("Invalid override manifest %s"), *FilePath);
+            return false;
+        }
+
+        for (const auto& Value : *Classes)
+        {
+            const auto Object = Value->AsObject();
+            if (!Object.IsValid())
+                continue;
+
+            auto& Entry = Entries.Add(Object->GetStringField(TEXT("class")));
+            Entry.ModuleName = Object->GetStringField(TEXT("module"));
+            for (const auto& Function : Object->GetArrayField(TEXT("functions")))
+                Entry.Functions.Add(FName(*Function->AsString()));
+        }
+        return true;
+    }
+
+    bool FLuaOverrideManifest::Save(const FString& FilePath) const
+    {
+        TArray<FString> ClassPaths;
+        Entries.GenerateKeyArray(ClassPaths);
+        ClassPaths.Sort();
+
+        TArray<TSharedPtr<FJsonValue>> Classes;
+        for (const auto& ClassPath : ClassPaths)
+        {
+            const auto& Entry = Entries[ClassPath];
+            TArray<TSharedPtr<FJsonValue>> Functions;
+            for (const auto& Function : Entry.Functions)
+                Functions.Add(MakeShared<FJsonValueString>(Function.ToString()));
+
+            const auto Object = MakeShared<FJsonObject>();
+            Object->SetStringField(TEXT("class"), ClassPath);
+            Object->SetStringField(TEXT("module"), Entry.ModuleName);
+            Object->SetArrayField(TEXT("functions"), Functions);
+            Classes.Add(MakeShared<FJsonValueObject>(Object));
+        }
+
+        const auto Root = MakeShared<FJsonObject>();
+        Root->SetArrayField(TEXT("classes"), Classes);
+
+        FString Content;
+        const auto Writer = TJsonWriterFactory<>::Create(&Content);
+        FJsonSerializer::Serialize(Root, Writer);
+        if (!FFileHelper::SaveStringToFile(Content, *FilePath))
+        {
+            UE_LOG(LogUnLua, Error, TEXT("Failed to save override manifest to %s"), *FilePath);
+            return false;
+        }
+        return true;
+    }
+
+    bool FLuaOverrideManifest::Add(FLuaEnv& Env, UClass* Class, const FString& ModuleName)
+    {
+        const auto L = Env.GetMainState();
+        const auto Top = lua_gettop(L);
+        lua_getglobal(L, "require");
+        lua_pushstring(L, TCHAR_TO_UTF8(*ModuleName));
+        if (lua_pcall(L, 1, 1, 0) != LUA_OK || !lua_istable(L, -1))
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("Failed to require %s for class %s: %s"), *ModuleName, *Class->GetPathName(),
+                   lua_isstring(L, -1) ? UTF8_TO_TCHAR(lua_tostring(L, -1)) : TEXT("table needed"));
+            lua_settop(L, Top);
+            return false;
+        }
+
+        const auto Ref = luaL_ref(L, LUA_REGISTRYINDEX);
+        TSet<FName> LuaFunctions;
+        LowLevel::GetFunctionNames(L, Ref, LuaFunctions, Class);
+        luaL_unref(L, LUA_REGISTRYINDEX, Ref);
+        lua_settop(L, Top);
+
+        // same rules as UUnLuaManager::BindClass
+        TMap<FName, UFunction*> UEFunctions;
+        ULuaFunction::GetOverridableFunctions(Class, UEFunctions);
+        const bool bAnimInstance = Class->IsChildOf<UAnimInstance>();
+
+        auto& Entry = Entries.Add(Class->GetPathName());
+        Entry.ModuleName = ModuleName;
+        for (const auto& FunctionName : LuaFunctions)
+        {
+            if (UEFunctions.Contains(FunctionName) || (bAnimInstance && FunctionName.ToString().StartsWith(TEXT("AnimNotify_"))))
+                Entry.Functions.Add(FunctionName);
+        }
+        Entry.Functions.Sort(FNameLexicalLess());
+        return true;
+    }
+
+    const FLuaOverrideManifest::FEntry* FLuaOverrideManifest::Find(const UClass* Class) const
+    {
+        if (Entries.Num() == 0)
+            return nullptr;
+        return Entries.Find(Class->GetPathName());
+    }
+
+    int32 FLuaOverrideManifest::Prebind(bool bLoadClasses)
+    {
+        int32 NumClasses = 0;
+        for (const auto& Pair : Entries)
+        {
+            const auto Class = bLoadClasses ? LoadObject<UClass>(nullptr, *Pair.Key) : FindObject<UClass>(nullptr, *Pair.Key);
+            if (!Class || Class->HasAnyFlags(RF_NeedPostLoad | RF_NeedPostLoadSubobjects))
+                continue;
+
+            Override(Class, Pair.Value);
+            ++NumClasses;
+        }
+        return NumClasses;
+    }
+
+    int32 FLuaOverrideManifest::Override(UClass* Class, const FEntry& Entry)
+    {
+        static UFunction* AnimNotifyFunc = UUnLuaManager::StaticClass()->FindFunctionByName(TEXT("TriggerAnimNotify"));
+        const bool bAnimInstance = Class->IsChildOf<UAnimInstance>();
+
+        int32 NumFunctions = 0;
+        for (const auto& FunctionName : Entry.Functions)
+        {
+            // left to the binding, which knows whether the module uses batched tick
+            if (FunctionName == NAME_ReceiveTick)
+                continue;
+
+            auto Function = FindOverridableFunction(Class, FunctionName);
+            if (!Function && bAnimInstance && FunctionName.ToString().StartsWith(TEXT("AnimNotify_")))
+                Function = AnimNotifyFunc;
+            if (!Function)
+                continue;
+
+            ULuaFunction::Override(Function, Class, FunctionName);
+            ++NumFunctions;
+        }
+        return NumFunctions;
+    }
+
+    UFunction* FLuaOverrideManifest::FindOverridableFunction(UClass* Class, FName FunctionName)
+    {
+        const auto Function = Class->FindFunctionByName(FunctionName);
+        const auto LuaFunction = Cast<ULuaFunction>(Function);
+        if (LuaFunction && LuaFunction->GetOuter() != Class)
+            return LuaFunction->GetSuperFunction();
+        return Function;
+    }
+}
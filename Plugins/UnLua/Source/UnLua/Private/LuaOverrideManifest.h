@@ -0,0 +1,74 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace UnLua
+{
+    class FLuaEnv;
+
+    /**
+     * Functions overridden by Lua on each bound class, recorded before cooking with -run=UnLuaOverrideManifest and
+     * staged with the scripts. Cooked builds use it to create the overrides of many classes in one pass, on startup or
+     * on a loading screen, instead of on the first spawn of each class.
+     */
+    class UNLUA_API FLuaOverrideManifest
+    {
+    public:
+        struct FEntry
+        {
+            FString ModuleName;
+            TArray<FName> Functions;
+        };
+
+        /** The manifest staged with the scripts, empty unless 'bUseOverrideManifest' is set in a cooked build */
+        static FLuaOverrideManifest& Get();
+
+        static FString GetDefaultPath();
+
+        bool Load(const FString& FilePath);
+
+        bool Save(const FString& FilePath) const;
+
+        /**
+         * Record the functions of the class overridden by its module, the module is required in the env
+         *
+         * @return - false if the module could not be required
+         */
+        bool Add(FLuaEnv& Env, UClass* Class, const FString& ModuleName);
+
+        const FEntry* Find(const UClass* Class) const;
+
+        /**
+         * Create the overrides of all classes in the manifest, classes not loaded yet are skipped unless bLoadClasses
+         *
+         * @return - number of classes overridden
+         */
+        int32 Prebind(bool bLoadClasses);
+
+        /** Create the overrides of the entry on the class, existing overrides are kept */
+        static int32 Override(UClass* Class, const FEntry& Entry);
+
+        /** The overridable function of the class, overrides added to the class by Lua resolve to the original */
+        static UFunction* FindOverridableFunction(UClass* Class, FName FunctionName);
+
+        int32 Num() const { return Entries.Num(); }
+
+    private:
+        TMap<FString, FEntry> Entries; // by path name of the class
+    };
+}
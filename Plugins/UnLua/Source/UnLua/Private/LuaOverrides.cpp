@@ -53,6 +53,11 @@ namespace UnLua
                 LuaFunction->Initialize();
                 return;
             }
+
+            // 已经覆写过，比如由覆写清单预先创建
+            const auto Exists = ULuaFunction::Get(Function);
+            if (Exists && Exists->GetOuter() == OverridesClass)
+                return;
         }
 
         const auto OriginalFunctionFlags = Function->FunctionFlags;
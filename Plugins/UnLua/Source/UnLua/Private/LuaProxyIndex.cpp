@@ -0,0 +1,194 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+
+#include "LuaProxyIndex.h"
+
+namespace UnLua
+{
+    static constexpr int32 MinSlots = 1024;
+
+    FLuaProxyIndex::FLuaProxyIndex(lua_State* L, bool bInWeak)
+        : State(L), bWeak(bInWeak), NumHandles(0), Count(0)
+    {
+        Slots.SetNumZeroed(MinSlots);
+
+        // handles are allocated densely from 1 so the values stay in the array part
+        lua_createtable(L, MinSlots, 0);
+        if (bWeak)
+        {
+            lua_createtable(L, 0, 1);
+            lua_pushstring(L, "__mode");
+            lua_pushstring(L, "v");
+            lua_rawset(L, -3);
+            lua_setmetatable(L, -2);
+        }
+        ValuesRef = luaL_ref(L, LUA_REGISTRYINDEX);
+    }
+
+    bool FLuaProxyIndex::Push(lua_State* L, const void* Key)
+    {
+        const int32 SlotIndex = Find(Key);
+        if (SlotIndex == INDEX_NONE)
+            return false;
+
+        lua_rawgeti(L, LUA_REGISTRYINDEX, ValuesRef);
+        if (lua_rawgeti(L, -1, Slots[SlotIndex].Handle) == LUA_TNIL)
+        {
+            // collected without a finalizer, only in a weak index
+            lua_pop(L, 2);
+            RemoveAt(SlotIndex);
+            return false;
+        }
+        lua_remove(L, -2);
+        return true;
+    }
+
+    void FLuaProxyIndex::Set(lua_State* L, const void* Key, int32 Index)
+    {
+        Index = lua_absindex(L, Index);
+        lua_rawgeti(L, LUA_REGISTRYINDEX, ValuesRef);
+
+        int32 SlotIndex = Find(Key);
+        if (SlotIndex == INDEX_NONE)
+        {
+            if ((Count + 1) * 4 > Slots.Num() * 3)
+            {
+                // grow unless a quarter of the slots were freed, or the next insertions would sweep again
+                if (bWeak)
+                    RemoveCollected(L);
+                if ((Count + 1) * 2 > Slots.Num())
+                    Grow();
+            }
+
+            SlotIndex = GetSlot(Key);
+            while (Slots[SlotIndex].Key)
+                SlotIndex = (SlotIndex + 1) & (Slots.Num() - 1);
+            Slots[SlotIndex].Key = Key;
+            Slots[SlotIndex].Handle = FreeHandles.Num() > 0 ? FreeHandles.Pop(false) : ++NumHandles;
+            ++Count;
+        }
+
+        lua_pushvalue(L, Index);
+        lua_rawseti(L, -2, Slots[SlotIndex].Handle);
+        lua_pop(L, 1);
+    }
+
+    bool FLuaProxyIndex::Remove(const void* Key)
+    {
+        const int32 SlotIndex = Find(Key);
+        if (SlotIndex == INDEX_NONE)
+            return false;
+        RemoveAt(SlotIndex);
+        return true;
+    }
+
+    bool FLuaProxyIndex::NotifyFinalized(lua_State* L, const void* Key, int32 Index)
+    {
+        const int32 SlotIndex = Find(Key);
+        if (SlotIndex == INDEX_NONE)
+            return true;
+
+        // the collector clears a weak value before running its finalizer, strong values are only finalized by lua_close
+        Index = lua_absindex(L, Index);
+        lua_rawgeti(L, LUA_REGISTRYINDEX, ValuesRef);
+        lua_rawgeti(L, -1, Slots[SlotIndex].Handle);
+        const bool bReplaced = !lua_isnil(L, -1) && !lua_rawequal(L, -1, Index);
+        lua_pop(L, 2);
+        if (bReplaced)
+            return false;
+
+        RemoveAt(SlotIndex);
+        return true;
+    }
+
+    int32 FLuaProxyIndex::Find(const void* Key) const
+    {
+        const int32 Mask = Slots.Num() - 1;
+        int32 SlotIndex = GetSlot(Key);
+        while (true)
+        {
+            const void* SlotKey = Slots[SlotIndex].Key;
+            if (SlotKey == Key)
+                return SlotIndex;
+            if (!SlotKey)
+                return INDEX_NONE;
+            SlotIndex = (SlotIndex + 1) & Mask;
+        }
+    }
+
+    void FLuaProxyIndex::RemoveAt(int32 SlotIndex)
+    {
+        // a stale weak value is left until the handle is reused, a strong one would keep the proxy alive
+        const int32 Handle = Slots[SlotIndex].Handle;
+        FreeHandles.Add(Handle);
+        if (!bWeak)
+        {
+            lua_rawgeti(State, LUA_REGISTRYINDEX, ValuesRef);
+            lua_pushnil(State);
+            lua_rawseti(State, -2, Handle);
+            lua_pop(State, 1);
+        }
+
+        // backward shift deletion keeps probe sequences intact without tombstones
+        const int32 Mask = Slots.Num() - 1;
+        int32 Hole = SlotIndex;
+        int32 Next = (Hole + 1) & Mask;
+        while (Slots[Next].Key)
+        {
+            const int32 Home = GetSlot(Slots[Next].Key);
+            if (((Next - Home) & Mask) >= ((Next - Hole) & Mask))
+            {
+                Slots[Hole] = Slots[Next];
+                Hole = Next;
+            }
+            Next = (Next + 1) & Mask;
+        }
+        Slots[Hole] = FSlot();
+        --Count;
+    }
+
+    void FLuaProxyIndex::RemoveCollected(lua_State* L)
+    {
+        TArray<const void*> Collected;
+        for (const auto& Slot : Slots)
+        {
+            if (!Slot.Key)
+                continue;
+            if (lua_rawgeti(L, -1, Slot.Handle) == LUA_TNIL)
+                Collected.Add(Slot.Key);
+            lua_pop(L, 1);
+        }
+
+        for (const auto Key : Collected)
+            Remove(Key);
+    }
+
+    void FLuaProxyIndex::Grow()
+    {
+        TArray<FSlot> OldSlots = MoveTemp(Slots);
+        Slots.SetNumZeroed(OldSlots.Num() * 2);
+        const int32 Mask = Slots.Num() - 1;
+        for (const auto& OldSlot : OldSlots)
+        {
+            if (!OldSlot.Key)
+                continue;
+            int32 SlotIndex = GetSlot(OldSlot.Key);
+            while (Slots[SlotIndex].Key)
+                SlotIndex = (SlotIndex + 1) & Mask;
+            Slots[SlotIndex] = OldSlot;
+        }
+    }
+}
@@ -0,0 +1,92 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "lua.hpp"
+
+namespace UnLua
+{
+    /**
+     * Open addressing index from native pointers to the Lua userdata/tables representing them. The values live in the
+     * array part of a table indexed by a handle per entry.
+     *
+     * A strong index keeps its values alive until their entry is removed, by the owner when the native side goes away
+     * (the UObject index on NotifyUObjectDeleted). The collector marks the values incrementally like any other table,
+     * there is nothing left for it to clear in the atomic phase.
+     *
+     * A weak index is for the values nothing tells us about (containers and structs pointing into native memory). Its
+     * table is weak valued, so the collector still clears it in the atomic phase, in time linear to its size. Values
+     * are cleared before their finalizer runs, so a proxy pending finalization is never handed out again. Entries are
+     * removed from the __gc of the value through NotifyFinalized, entries of values without a finalizer are dropped
+     * once they are found collected.
+     */
+    class FLuaProxyIndex
+    {
+    public:
+        FLuaProxyIndex(lua_State* L, bool bInWeak);
+
+        /**
+         * Push the value cached for the key.
+         * @return false if nothing is cached, the stack is left untouched
+         */
+        bool Push(lua_State* L, const void* Key);
+
+        /**
+         * Cache the table or userdata at the given stack index, replacing the current one.
+         */
+        void Set(lua_State* L, const void* Key, int32 Index);
+
+        /** @return true if an entry was removed */
+        bool Remove(const void* Key);
+
+        /**
+         * Called from the __gc of a userdata cached for the key at the given stack index.
+         * @return false if another value has been cached for the key since, the entry is kept
+         */
+        bool NotifyFinalized(lua_State* L, const void* Key, int32 Index);
+
+        int32 Num() const { return Count; }
+
+    private:
+        struct FSlot
+        {
+            const void* Key;
+            int32 Handle;
+        };
+
+        int32 Find(const void* Key) const;
+
+        void RemoveAt(int32 SlotIndex);
+
+        /** Drop the entries of a weak index whose value has been collected, the values table is on the top of the stack */
+        void RemoveCollected(lua_State* L);
+
+        void Grow();
+
+        FORCEINLINE uint32 GetSlot(const void* Key) const
+        {
+            return (uint32)((((uint64)(UPTRINT)Key >> 3) * 0x9E3779B97F4A7C15ull) >> 32) & (Slots.Num() - 1);
+        }
+
+        lua_State* State;
+        bool bWeak;
+        TArray<FSlot> Slots;
+        TArray<int32> FreeHandles;
+        int32 NumHandles;
+        int32 Count;
+        int32 ValuesRef;
+    };
+}
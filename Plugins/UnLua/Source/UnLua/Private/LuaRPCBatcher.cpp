@@ -0,0 +1,121 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+
+#include "LuaRPCBatcher.h"
+#include "LuaEnv.h"
+#include "UnLuaBase.h"
+#include "ReflectionUtils/FunctionDesc.h"
+
+namespace UnLua
+{
+    FLuaRPCBatcher::FLuaRPCBatcher(FLuaEnv* InEnv)
+        : Env(InEnv)
+    {
+        TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FLuaRPCBatcher::Tick));
+    }
+
+    FLuaRPCBatcher::~FLuaRPCBatcher()
+    {
+        // pending batches are released along with the lua state
+        FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+    }
+
+    int32 FLuaRPCBatcher::AddBatch(int32 HandlerRef)
+    {
+        const int32 Index = FreeBatches.Num() > 0 ? FreeBatches.Pop(false) : Batches.AddDefaulted();
+        Batches[Index].HandlerRef = HandlerRef;
+        return Index;
+    }
+
+    void FLuaRPCBatcher::RemoveBatch(lua_State* L, int32 Index)
+    {
+        FBatch& Batch = Batches[Index];
+        if (Batch.TableRef != LUA_NOREF)
+        {
+            luaL_unref(L, LUA_REGISTRYINDEX, Batch.TableRef);
+            PendingBatches.Remove(Index);
+        }
+
+        // removed by a handler during a flush, the array is still iterated
+        const int32 DeliveringIndex = DeliveringBatches.Find(Index);
+        if (DeliveringIndex != INDEX_NONE)
+            DeliveringBatches[DeliveringIndex] = INDEX_NONE;
+
+        Batch = FBatch();
+        FreeBatches.Add(Index);
+    }
+
+    void FLuaRPCBatcher::Enqueue(lua_State* L, int32 Index, int32 SelfRef, FFunctionDesc* Desc, FFrame& Stack)
+    {
+        FBatch& Batch = Batches[Index];
+        if (Batch.TableRef == LUA_NOREF)
+        {
+            lua_newtable(L);
+            Batch.TableRef = luaL_ref(L, LUA_REGISTRYINDEX);
+            PendingBatches.Add(Index);
+        }
+
+        lua_rawgeti(L, LUA_REGISTRYINDEX, Batch.TableRef);
+        const int32 TableIndex = lua_gettop(L);
+        lua_rawgeti(L, LUA_REGISTRYINDEX, SelfRef);
+        const int32 NumValues = Desc->PushParams(L, Stack) + 1;
+        for (int32 i = NumValues; i > 0; --i)
+            lua_rawseti(L, TableIndex, Batch.NumValues + i);
+        Batch.NumValues += NumValues;
+        ++Batch.NumCalls;
+        lua_settop(L, TableIndex - 1);
+    }
+
+    void FLuaRPCBatcher::Flush()
+    {
+        // the batches being delivered are iterated, a nested flush would swap them away
+        if (bFlushing || PendingBatches.Num() == 0)
+            return;
+
+        TGuardValue<bool> FlushingGuard(bFlushing, true);
+        lua_State* L = Env->GetMainState();
+        const int32 Top = lua_gettop(L);
+        lua_pushcfunction(L, ReportLuaCallError);
+
+        Swap(PendingBatches, DeliveringBatches);
+        const auto Guard = Env->GetDeadLoopCheck()->MakeGuard();
+        for (const int32 Index : DeliveringBatches)
+        {
+            if (Index == INDEX_NONE || Batches[Index].TableRef == LUA_NOREF)
+                continue;
+
+            FBatch& Batch = Batches[Index];
+            lua_rawgeti(L, LUA_REGISTRYINDEX, Batch.HandlerRef);
+            lua_rawgeti(L, LUA_REGISTRYINDEX, Batch.TableRef);
+            lua_pushinteger(L, Batch.NumCalls);
+            luaL_unref(L, LUA_REGISTRYINDEX, Batch.TableRef);
+            Batch.TableRef = LUA_NOREF;
+            Batch.NumCalls = 0;
+            Batch.NumValues = 0;
+
+            lua_pcall(L, 2, 0, Top + 1);
+            lua_settop(L, Top + 1);
+        }
+        DeliveringBatches.Reset();
+        lua_settop(L, Top);
+    }
+
+    bool FLuaRPCBatcher::Tick(float DeltaTime)
+    {
+        Flush();
+        return true;
+    }
+}
@@ -0,0 +1,82 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "UnLuaCompatibility.h"
+#include "lua.hpp"
+
+class FFunctionDesc;
+
+namespace UnLua
+{
+    class FLuaEnv;
+
+    /**
+     * Queues the calls of RPCs overridden by '<Name>_Batch' in Lua and delivers them once per frame, with a single
+     * call into Lua per function: Handler(Batch, Count). Batch holds self followed by the parameters of each call,
+     * flattened in arrival order, self may have been destroyed since. The calls of a batch come from any number of
+     * objects so the handler is called without self, it is declared as 'function M.<Name>_Batch(Batch, Count)'.
+     */
+    class UNLUA_API FLuaRPCBatcher
+    {
+    public:
+        explicit FLuaRPCBatcher(FLuaEnv* InEnv);
+
+        ~FLuaRPCBatcher();
+
+        /** @return index of a new batch delivered to the function, the function ref is still owned by the caller */
+        int32 AddBatch(int32 HandlerRef);
+
+        /** Drop the batch and its pending calls */
+        void RemoveBatch(lua_State* L, int32 Index);
+
+        /** Append self and copies of the parameters of the call on the stack to the batch */
+        void Enqueue(lua_State* L, int32 Index, int32 SelfRef, FFunctionDesc* Desc, FFrame& Stack);
+
+        /**
+         * Deliver all pending calls now, calls queued by the handlers are delivered on the next flush.
+         * A flush from a handler does nothing, its calls are delivered by the next flush.
+         */
+        void Flush();
+
+        int32 NumPending() const { return PendingBatches.Num(); }
+
+    private:
+        struct FBatch
+        {
+            int32 HandlerRef = LUA_NOREF;
+            int32 TableRef = LUA_NOREF;
+            int32 NumCalls = 0;
+            int32 NumValues = 0;
+        };
+
+        bool Tick(float DeltaTime);
+
+        FLuaEnv* Env;
+        TArray<FBatch> Batches;
+        TArray<int32> FreeBatches;
+        TArray<int32> PendingBatches;
+        TArray<int32> DeliveringBatches;
+        bool bFlushing = false;
+#if ENGINE_MAJOR_VERSION >= 5
+        FTSTicker::FDelegateHandle TickerHandle;
+#else
+        FDelegateHandle TickerHandle;
+#endif
+    };
+}
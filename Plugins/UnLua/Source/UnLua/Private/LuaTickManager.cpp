@@ -0,0 +1,267 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#include "LuaTickManager.h"
+#include "Components/ActorComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "LuaEnv.h"
+#include "UnLuaBase.h"
+
+namespace UnLua
+{
+    static FTickFunction* GetTickFunction(UObject* Object)
+    {
+        if (const auto Actor = Cast<AActor>(Object))
+            return &Actor->PrimaryActorTick;
+        if (const auto Component = Cast<UActorComponent>(Object))
+            return &Component->PrimaryComponentTick;
+        return nullptr;
+    }
+
+    static bool HasBegunPlay(UObject* Object)
+    {
+        if (const auto Actor = Cast<AActor>(Object))
+            return Actor->HasActorBegunPlay();
+        if (const auto Component = Cast<UActorComponent>(Object))
+            return Component->HasBegunPlay();
+        return false;
+    }
+
+    static float GetTimeDilation(UObject* Object)
+    {
+        if (const auto Actor = Cast<AActor>(Object))
+            return Actor->CustomTimeDilation;
+        if (const auto Component = Cast<UActorComponent>(Object))
+        {
+            const auto Owner = Component->GetOwner();
+            return Owner ? Owner->CustomTimeDilation : 1.0f;
+        }
+        return 1.0f;
+    }
+
+    FLuaTickManager::FLuaTickManager(FLuaEnv* InEnv)
+        : Env(InEnv)
+    {
+        OnWorldTickStartHandle = FWorldDelegates::OnWorldTickStart.AddRaw(this, &FLuaTickManager::OnWorldTickStart);
+        OnWorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddRaw(this, &FLuaTickManager::OnWorldCleanup);
+    }
+
+    FLuaTickManager::~FLuaTickManager()
+    {
+        FWorldDelegates::OnWorldTickStart.Remove(OnWorldTickStartHandle);
+        FWorldDelegates::OnWorldCleanup.Remove(OnWorldCleanupHandle);
+        Cleanup();
+    }
+
+    void FLuaTickManager::Add(UObject* Object)
+    {
+        if (GetTickFunction(Object))
+            PendingObjects.Add(Object);
+    }
+
+    void FLuaTickManager::Cleanup()
+    {
+        // the lua state may already be closed, refs are dropped with it
+        DispatcherRef = LUA_NOREF;
+        PendingObjects.Empty();
+        Batches.Empty();
+    }
+
+    void FLuaTickManager::OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaTime)
+    {
+        // objects start ticking after BeginPlay, same as their own tick functions
+        for (int32 Index = PendingObjects.Num() - 1; Index >= 0; --Index)
+        {
+            UObject* Object = PendingObjects[Index].Get();
+            if (!Object)
+            {
+                PendingObjects.RemoveAtSwap(Index);
+                continue;
+            }
+
+            if (Object->GetWorld() != World || !HasBegunPlay(Object))
+                continue;
+
+            PendingObjects.RemoveAtSwap(Index);
+
+            FTickFunction* TickFunction = GetTickFunction(Object);
+            auto& Batch = Batches.FindOrAdd(TPair<UWorld*, ETickingGroup>(World, TickFunction->TickGroup));
+            if (!Batch)
+            {
+                Batch = MakeUnique<FBatchTickFunction>();
+                Batch->Owner = this;
+                Batch->World = World;
+                Batch->TickGroup = TickFunction->TickGroup;
+                Batch->bCanEverTick = true;
+                Batch->bStartWithTickEnabled = true;
+                // pause is checked per object
+                Batch->bTickEvenWhenPaused = true;
+                Batch->RegisterTickFunction(World->PersistentLevel);
+            }
+
+            // run after the object's own tick, which also carries its prerequisites
+            Batch->AddPrerequisite(Object, *TickFunction);
+            Batch->Entries.Add({Object, 0});
+        }
+    }
+
+    void FLuaTickManager::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+    {
+        lua_State* L = Env ? Env->GetMainState() : nullptr;
+        for (auto It = Batches.CreateIterator(); It; ++It)
+        {
+            if (It->Key.Key != World)
+                continue;
+            if (L)
+            {
+                luaL_unref(L, LUA_REGISTRYINDEX, It->Value->ObjectsRef);
+                luaL_unref(L, LUA_REGISTRYINDEX, It->Value->DeltasRef);
+            }
+            It.RemoveCurrent();
+        }
+    }
+
+    void FLuaTickManager::RemoveExpired(FBatchTickFunction& Batch)
+    {
+        Batch.Entries.RemoveAll([&Batch](const FEntry& Entry)
+        {
+            UObject* Object = Entry.Object.Get();
+            if (Object && HasBegunPlay(Object))
+                return false;
+            if (Object)
+                Batch.RemovePrerequisite(Object, *GetTickFunction(Object));
+            return true;
+        });
+
+        // prerequisites on destroyed objects can't be matched by their object any more
+        Batch.GetPrerequisites().RemoveAll([](const FTickPrerequisite& Prerequisite)
+        {
+            return !Prerequisite.PrerequisiteObject.IsValid();
+        });
+    }
+
+    void FLuaTickManager::Dispatch(FBatchTickFunction& Batch, float DeltaTime)
+    {
+        UWorld* World = Batch.World.Get();
+        if (!World || !Env)
+            return;
+
+        lua_State* L = Env->GetMainState();
+        if (DispatcherRef == LUA_NOREF)
+        {
+            static const char* Chunk = R"(
+                local xpcall, traceback, LogError = xpcall, debug.traceback, UnLua.LogError
+                local function handler(err)
+                    LogError(traceback(err, 2))
+                end
+                return function(objects, deltas, n)
+                    for i = 1, n do
+                        local object = objects[i]
+                        local tick = object.ReceiveTick
+                        if tick then
+                            xpcall(tick, handler, object, deltas[i])
+                        end
+                    end
+                end
+            )";
+            if (luaL_dostring(L, Chunk) != LUA_OK)
+            {
+                UE_LOG(LogUnLua, Error, TEXT("failed to create batched tick dispatcher: %s"), UTF8_TO_TCHAR(lua_tostring(L, -1)));
+                lua_pop(L, 1);
+                return;
+            }
+            DispatcherRef = luaL_ref(L, LUA_REGISTRYINDEX);
+        }
+
+        if (Batch.ObjectsRef == LUA_NOREF)
+        {
+            lua_createtable(L, Batch.Entries.Num(), 0);
+            Batch.ObjectsRef = luaL_ref(L, LUA_REGISTRYINDEX);
+            lua_createtable(L, Batch.Entries.Num(), 0);
+            Batch.DeltasRef = luaL_ref(L, LUA_REGISTRYINDEX);
+        }
+
+        const int32 Top = lua_gettop(L);
+        lua_pushcfunction(L, ReportLuaCallError);
+        lua_rawgeti(L, LUA_REGISTRYINDEX, DispatcherRef);
+        lua_rawgeti(L, LUA_REGISTRYINDEX, Batch.ObjectsRef);
+        lua_rawgeti(L, LUA_REGISTRYINDEX, Batch.DeltasRef);
+
+        const bool bPaused = World->IsPaused();
+        int32 Count = 0;
+        bool bHasExpired = false;
+        for (FEntry& Entry : Batch.Entries)
+        {
+            UObject* Object = Entry.Object.Get();
+            if (!Object || !HasBegunPlay(Object))
+            {
+                bHasExpired = true;
+                continue;
+            }
+
+            const FTickFunction* TickFunction = GetTickFunction(Object);
+            if (!TickFunction->IsTickFunctionEnabled() || (bPaused && !TickFunction->bTickEvenWhenPaused))
+                continue;
+
+            float ObjectDeltaTime = DeltaTime * GetTimeDilation(Object);
+            if (TickFunction->TickInterval > 0)
+            {
+                Entry.AccumulatedTime += ObjectDeltaTime;
+                if (Entry.AccumulatedTime < TickFunction->TickInterval)
+                    continue;
+                ObjectDeltaTime = Entry.AccumulatedTime;
+                Entry.AccumulatedTime = 0;
+            }
+
+            ++Count;
+            PushUObject(L, Object);
+            lua_rawseti(L, -3, Count);
+            lua_pushnumber(L, ObjectDeltaTime);
+            lua_rawseti(L, -2, Count);
+        }
+
+        // don't keep the objects of a previous frame alive past this one
+        for (int32 Index = Count + 1; Index <= Batch.LastCount; ++Index)
+        {
+            lua_pushnil(L);
+            lua_rawseti(L, -3, Index);
+        }
+        Batch.LastCount = Count;
+
+        if (bHasExpired)
+            RemoveExpired(Batch);
+
+        if (Count == 0)
+        {
+            lua_settop(L, Top);
+            return;
+        }
+
+        lua_pushinteger(L, Count);
+        lua_pcall(L, 3, 0, Top + 1);
+        lua_settop(L, Top);
+    }
+
+    void FLuaTickManager::FBatchTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+    {
+        Owner->Dispatch(*this, DeltaTime);
+    }
+
+    FString FLuaTickManager::FBatchTickFunction::DiagnosticMessage()
+    {
+        return FString::Printf(TEXT("UnLua batched tick [%d objects]"), Entries.Num());
+    }
+}
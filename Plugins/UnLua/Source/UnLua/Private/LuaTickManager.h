@@ -0,0 +1,79 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "lua.hpp"
+
+namespace UnLua
+{
+    class FLuaEnv;
+
+    /**
+     * Ticks Lua 'ReceiveTick' of bound actors and components in batches, one Lua call per world and tick
+     * group each frame instead of one per object. Opt-in per module with 'BatchedTick = true'.
+     */
+    class FLuaTickManager
+    {
+    public:
+        explicit FLuaTickManager(FLuaEnv* InEnv);
+
+        ~FLuaTickManager();
+
+        /** Start ticking the object once it has begun play */
+        void Add(UObject* Object);
+
+        void Cleanup();
+
+    private:
+        struct FEntry
+        {
+            TWeakObjectPtr<UObject> Object;
+            float AccumulatedTime = 0;
+        };
+
+        struct FBatchTickFunction : public FTickFunction
+        {
+            FLuaTickManager* Owner = nullptr;
+            TWeakObjectPtr<UWorld> World;
+            TArray<FEntry> Entries;
+            /** objects and delta times passed to the dispatcher, refilled every frame */
+            int32 ObjectsRef = LUA_NOREF;
+            int32 DeltasRef = LUA_NOREF;
+            int32 LastCount = 0;
+
+            virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+
+            virtual FString DiagnosticMessage() override;
+        };
+
+        void OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaTime);
+
+        void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+
+        void Dispatch(FBatchTickFunction& Batch, float DeltaTime);
+
+        void RemoveExpired(FBatchTickFunction& Batch);
+
+        FLuaEnv* Env;
+        int32 DispatcherRef = LUA_NOREF;
+        TArray<TWeakObjectPtr<UObject>> PendingObjects;
+        TMap<TPair<UWorld*, ETickingGroup>, TUniquePtr<FBatchTickFunction>> Batches;
+        FDelegateHandle OnWorldTickStartHandle;
+        FDelegateHandle OnWorldCleanupHandle;
+    };
+}
@@ -0,0 +1,299 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#include "LuaTimerWheel.h"
+#include "LuaEnv.h"
+#include "UnLuaBase.h"
+
+namespace UnLua
+{
+    static constexpr double TicksPerSecond = 1000.0;
+    // about 73 million years, far enough that the expire tick can't overflow
+    static constexpr double MaxDelay = (double)(MAX_int64 / 4) / TicksPerSecond;
+
+    FLuaTimerWheel::FLuaTimerWheel(FLuaEnv* InEnv)
+        : Env(InEnv)
+    {
+        for (int32& Head : Slots)
+            Head = INDEX_NONE;
+        TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FLuaTimerWheel::Tick));
+    }
+
+    FLuaTimerWheel::~FLuaTimerWheel()
+    {
+        // function refs are released along with the lua state
+        FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+    }
+
+    lua_Integer FLuaTimerWheel::SetTimer(lua_State* L, int32 FunctionIndex, double Delay, bool bLoop)
+    {
+        // negative and NaN delays fire on the next tick, the conversion to ticks is undefined out of range
+        if (FMath::IsFinite(Delay))
+            Delay = FMath::Clamp(Delay, 0.0, MaxDelay);
+        else
+            Delay = Delay > 0 ? MaxDelay : 0.0;
+        const uint64 DelayTicks = FMath::Max((uint64)FMath::RoundToDouble(Delay * TicksPerSecond), (uint64)1);
+
+        int32 Index;
+        if (FreeTimers.Num() > 0)
+        {
+            Index = FreeTimers.Pop(false);
+        }
+        else
+        {
+            Index = Timers.AddDefaulted();
+        }
+
+        FTimer& Timer = Timers[Index];
+        lua_pushvalue(L, FunctionIndex);
+        Timer.FunctionRef = luaL_ref(L, LUA_REGISTRYINDEX);
+        Timer.Expire = CurrentTick + DelayTicks;
+        Timer.Interval = bLoop ? DelayTicks : 0;
+        Link(Index);
+        ++NumActive;
+
+        return MakeHandle(Index);
+    }
+
+    lua_Integer FLuaTimerWheel::MakeHandle(int32 Index) const
+    {
+        return ((lua_Integer)(Timers[Index].Generation & 0x7fffffff) << 32) | (lua_Integer)(Index + 1);
+    }
+
+    bool FLuaTimerWheel::ClearTimer(lua_State* L, lua_Integer Handle)
+    {
+        const int32 Index = FindTimer(Handle);
+        if (Index == INDEX_NONE)
+            return false;
+
+        if (Timers[Index].Slot != INDEX_NONE)
+            Unlink(Index);
+        Release(L, Index);
+        return true;
+    }
+
+    int32 FLuaTimerWheel::FindTimer(lua_Integer Handle) const
+    {
+        const int64 Index = (Handle & 0xffffffff) - 1;
+        if (Index < 0 || Index >= Timers.Num())
+            return INDEX_NONE;
+
+        const FTimer& Timer = Timers[Index];
+        if (Timer.FunctionRef == LUA_NOREF || (lua_Integer)(Timer.Generation & 0x7fffffff) != (Handle >> 32))
+            return INDEX_NONE;
+        return (int32)Index;
+    }
+
+    void FLuaTimerWheel::Link(int32 Index)
+    {
+        FTimer& Timer = Timers[Index];
+        const uint64 Delta = Timer.Expire - CurrentTick;
+
+        int32 Slot;
+        if (Delta < RootSize)
+        {
+            Slot = Timer.Expire & (RootSize - 1);
+        }
+        else
+        {
+            int32 Level = 1;
+            while (Level < NumLevels - 1 && Delta >= (uint64)1 << (RootBits + Level * LevelBits))
+                ++Level;
+
+            // beyond the last level, park at its farthest slot and re-evaluate when cascaded
+            const uint64 MaxDelta = ((uint64)1 << (RootBits + Level * LevelBits)) - 1;
+            const uint64 Expire = Delta > MaxDelta ? CurrentTick + MaxDelta : Timer.Expire;
+            const int32 Shift = RootBits + (Level - 1) * LevelBits;
+            Slot = RootSize + (Level - 1) * LevelSize + (int32)((Expire >> Shift) & (LevelSize - 1));
+        }
+
+        Timer.Slot = Slot;
+        Timer.Prev = INDEX_NONE;
+        Timer.Next = Slots[Slot];
+        if (Timer.Next != INDEX_NONE)
+            Timers[Timer.Next].Prev = Index;
+        Slots[Slot] = Index;
+        ++NumLinked;
+    }
+
+    void FLuaTimerWheel::Unlink(int32 Index)
+    {
+        FTimer& Timer = Timers[Index];
+        if (Timer.Prev != INDEX_NONE)
+            Timers[Timer.Prev].Next = Timer.Next;
+        else
+            Slots[Timer.Slot] = Timer.Next;
+        if (Timer.Next != INDEX_NONE)
+            Timers[Timer.Next].Prev = Timer.Prev;
+
+        Timer.Slot = INDEX_NONE;
+        Timer.Prev = INDEX_NONE;
+        Timer.Next = INDEX_NONE;
+        --NumLinked;
+    }
+
+    void FLuaTimerWheel::Release(lua_State* L, int32 Index)
+    {
+        FTimer& Timer = Timers[Index];
+        luaL_unref(L, LUA_REGISTRYINDEX, Timer.FunctionRef);
+        Timer.FunctionRef = LUA_NOREF;
+        ++Timer.Generation;
+        FreeTimers.Add(Index);
+        --NumActive;
+    }
+
+    int32 FLuaTimerWheel::Cascade(int32 Level)
+    {
+        const int32 Shift = RootBits + (Level - 1) * LevelBits;
+        const int32 LevelIndex = (int32)((CurrentTick >> Shift) & (LevelSize - 1));
+        const int32 Slot = RootSize + (Level - 1) * LevelSize + LevelIndex;
+
+        int32 Index = Slots[Slot];
+        Slots[Slot] = INDEX_NONE;
+        while (Index != INDEX_NONE)
+        {
+            const int32 Next = Timers[Index].Next;
+            --NumLinked;
+            Link(Index);
+            Index = Next;
+        }
+        return LevelIndex;
+    }
+
+    void FLuaTimerWheel::Advance(uint64 Target)
+    {
+        while (CurrentTick < Target)
+        {
+            if (NumLinked == 0)
+            {
+                CurrentTick = Target;
+                break;
+            }
+
+            ++CurrentTick;
+            const int32 RootIndex = (int32)(CurrentTick & (RootSize - 1));
+            if (RootIndex == 0)
+            {
+                for (int32 Level = 1; Level < NumLevels && Cascade(Level) == 0; ++Level)
+                {
+                }
+            }
+
+            int32 Index = Slots[RootIndex];
+            Slots[RootIndex] = INDEX_NONE;
+            while (Index != INDEX_NONE)
+            {
+                FTimer& Timer = Timers[Index];
+                const int32 Next = Timer.Next;
+                Timer.Slot = INDEX_NONE;
+                Timer.Prev = INDEX_NONE;
+                Timer.Next = INDEX_NONE;
+                --NumLinked;
+                DueTimers.Add(Index);
+                Index = Next;
+            }
+        }
+    }
+
+    bool FLuaTimerWheel::Tick(float DeltaTime)
+    {
+        ElapsedSeconds += DeltaTime;
+        Advance((uint64)(ElapsedSeconds * TicksPerSecond));
+        if (DueTimers.Num() == 0)
+            return true;
+
+        lua_State* L = Env->GetMainState();
+        if (DispatcherRef == LUA_NOREF)
+        {
+            static const char* Chunk = R"(
+                local xpcall, traceback, LogError = xpcall, debug.traceback, UnLua.LogError
+                local function handler(err)
+                    LogError(traceback(err, 2))
+                end
+                return function(take, handles, n)
+                    for i = 1, n do
+                        local callback = take(handles[i])
+                        if callback then
+                            xpcall(callback, handler)
+                        end
+                    end
+                end
+            )";
+            if (luaL_dostring(L, Chunk) != LUA_OK)
+            {
+                UE_LOG(LogUnLua, Error, TEXT("failed to create timer dispatcher: %s"), UTF8_TO_TCHAR(lua_tostring(L, -1)));
+                lua_pop(L, 1);
+                return true;
+            }
+            DispatcherRef = luaL_ref(L, LUA_REGISTRYINDEX);
+        }
+
+        const int32 Top = lua_gettop(L);
+        lua_pushcfunction(L, ReportLuaCallError);
+        lua_rawgeti(L, LUA_REGISTRYINDEX, DispatcherRef);
+        lua_pushlightuserdata(L, this);
+        lua_pushcclosure(L, TakeDueTimer, 1);
+        lua_createtable(L, DueTimers.Num(), 0);
+        const int32 Count = DueTimers.Num();
+        TArray<lua_Integer, TInlineAllocator<16>> OneShotHandles;
+        for (int32 i = 0; i < Count; ++i)
+        {
+            // callbacks may clear the timers due after them, they are looked up by handle when fired
+            const int32 Index = DueTimers[i];
+            FTimer& Timer = Timers[Index];
+            lua_pushinteger(L, MakeHandle(Index));
+            lua_rawseti(L, -2, i + 1);
+
+            if (Timer.Interval == 0)
+            {
+                OneShotHandles.Add(MakeHandle(Index));
+                continue;
+            }
+
+            // fire at most once per frame, skipping the intervals missed by a long frame
+            Timer.Expire += Timer.Interval;
+            if (Timer.Expire <= CurrentTick)
+                Timer.Expire += ((CurrentTick - Timer.Expire) / Timer.Interval + 1) * Timer.Interval;
+            Link(Index);
+        }
+        DueTimers.Reset();
+
+        lua_pushinteger(L, Count);
+        lua_pcall(L, 3, 0, Top + 1);
+        lua_settop(L, Top);
+
+        // one-shot timers not taken if the dispatcher failed
+        for (const lua_Integer Handle : OneShotHandles)
+        {
+            const int32 Index = FindTimer(Handle);
+            if (Index != INDEX_NONE && Timers[Index].Slot == INDEX_NONE)
+                Release(L, Index);
+        }
+        return true;
+    }
+
+    int FLuaTimerWheel::TakeDueTimer(lua_State* L)
+    {
+        const auto Wheel = (FLuaTimerWheel*)lua_touserdata(L, lua_upvalueindex(1));
+        const int32 Index = Wheel->FindTimer(lua_tointeger(L, 1));
+        if (Index == INDEX_NONE)
+            return 0;
+
+        lua_rawgeti(L, LUA_REGISTRYINDEX, Wheel->Timers[Index].FunctionRef);
+        if (Wheel->Timers[Index].Interval == 0)
+            Wheel->Release(L, Index);
+        return 1;
+    }
+}
@@ -0,0 +1,106 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "UnLuaCompatibility.h"
+#include "lua.hpp"
+
+namespace UnLua
+{
+    class FLuaEnv;
+
+    /**
+     * Hierarchical timing wheel for Lua callbacks, with a resolution of one millisecond. Insert and cancel
+     * are O(1), all timers due in a frame are fired with a single call into Lua. Timers cleared by a callback
+     * of the same frame are not fired.
+     *
+     * Driven by FTSTicker in real time, timers keep running while the game is paused and ignore time dilation.
+     */
+    class FLuaTimerWheel
+    {
+    public:
+        explicit FLuaTimerWheel(FLuaEnv* InEnv);
+
+        ~FLuaTimerWheel();
+
+        /**
+         * Schedule the function at the given stack index.
+         * @return handle of the timer, never zero
+         */
+        lua_Integer SetTimer(lua_State* L, int32 FunctionIndex, double Delay, bool bLoop);
+
+        /** @return false if the handle is unknown, already fired or cleared */
+        bool ClearTimer(lua_State* L, lua_Integer Handle);
+
+        int32 Num() const { return NumActive; }
+
+    private:
+        static constexpr int32 NumLevels = 4;
+        static constexpr int32 RootBits = 8;
+        static constexpr int32 LevelBits = 6;
+        static constexpr int32 RootSize = 1 << RootBits;
+        static constexpr int32 LevelSize = 1 << LevelBits;
+        static constexpr int32 NumSlots = RootSize + (NumLevels - 1) * LevelSize;
+
+        struct FTimer
+        {
+            uint64 Expire = 0;
+            uint64 Interval = 0;
+            int32 FunctionRef = LUA_NOREF;
+            int32 Slot = INDEX_NONE;
+            int32 Prev = INDEX_NONE;
+            int32 Next = INDEX_NONE;
+            uint32 Generation = 0;
+        };
+
+        bool Tick(float DeltaTime);
+
+        void Advance(uint64 Target);
+
+        void Link(int32 Index);
+
+        void Unlink(int32 Index);
+
+        void Release(lua_State* L, int32 Index);
+
+        int32 Cascade(int32 Level);
+
+        int32 FindTimer(lua_Integer Handle) const;
+
+        lua_Integer MakeHandle(int32 Index) const;
+
+        /** take(Handle) in the dispatcher, @return the function of the timer if still live, one-shot timers are released */
+        static int TakeDueTimer(lua_State* L);
+
+        FLuaEnv* Env;
+        TArray<FTimer> Timers;
+        TArray<int32> FreeTimers;
+        int32 Slots[NumSlots];
+        TArray<int32> DueTimers;
+        uint64 CurrentTick = 0;
+        double ElapsedSeconds = 0;
+        int32 NumActive = 0;
+        int32 NumLinked = 0;
+        int32 DispatcherRef = LUA_NOREF;
+#if ENGINE_MAJOR_VERSION >= 5
+        FTSTicker::FDelegateHandle TickerHandle;
+#else
+        FDelegateHandle TickerHandle;
+#endif
+    };
+}
@@ -256,6 +256,87 @@ namespace UnLua
         }
     }
 
+    FLuaFunctionHandle::FLuaFunctionHandle(FLuaEnv* Env, const char* GlobalFuncName)
+        : FLuaFunctionHandle(Env, nullptr, GlobalFuncName)
+    {
+    }
+
+    FLuaFunctionHandle::FLuaFunctionHandle(FLuaEnv* Env, const char* GlobalTableName, const char* FuncName)
+        : L(Env->GetMainState()), EnvId(Env->GetId()), TableName(GlobalTableName ? UTF8_TO_TCHAR(GlobalTableName) : TEXT("")),
+          FuncName(FuncName ? UTF8_TO_TCHAR(FuncName) : TEXT("")), FunctionRef(LUA_REFNIL), Generation(Env->GetHotReloadGeneration())
+    {
+        Resolve(Env);
+    }
+
+    FLuaFunctionHandle::~FLuaFunctionHandle()
+    {
+        // the ref is gone with the env if it was destroyed first
+        if (FunctionRef != LUA_REFNIL && GetEnv())
+            luaL_unref(L, LUA_REGISTRYINDEX, FunctionRef);
+    }
+
+    FLuaEnv* FLuaFunctionHandle::GetEnv() const
+    {
+        // a new env may be created at the address of a destroyed one, the id tells them apart
+        FLuaEnv* Env = FLuaEnv::GetAll().FindRef(L);
+        return Env && Env->GetId() == EnvId ? Env : nullptr;
+    }
+
+    bool FLuaFunctionHandle::IsValid()
+    {
+        FLuaEnv* Env = GetEnv();
+        if (!Env)
+        {
+            FunctionRef = LUA_REFNIL;
+            return false;
+        }
+
+        if (Generation != Env->GetHotReloadGeneration())
+            Resolve(Env);
+        return FunctionRef != LUA_REFNIL;
+    }
+
+    void FLuaFunctionHandle::PushFunction()
+    {
+        lua_pushcfunction(L, ReportLuaCallError);
+        lua_rawgeti(L, LUA_REGISTRYINDEX, FunctionRef);
+    }
+
+    void FLuaFunctionHandle::Resolve(FLuaEnv* Env)
+    {
+        Generation = Env->GetHotReloadGeneration();
+        if (FunctionRef != LUA_REFNIL)
+        {
+            luaL_unref(L, LUA_REGISTRYINDEX, FunctionRef);
+            FunctionRef = LUA_REFNIL;
+        }
+
+        if (FuncName.IsEmpty())
+            return;
+
+        const int32 Top = lua_gettop(L);
+        if (TableName.IsEmpty())
+        {
+            lua_pushglobaltable(L);
+        }
+        else if (lua_getglobal(L, TCHAR_TO_UTF8(*TableName)) != LUA_TTABLE)
+        {
+            UE_LOG(LogUnLua, Verbose, TEXT("Global table %s doesn't exist!"), *TableName);
+            lua_settop(L, Top);
+            return;
+        }
+
+        if (lua_getfield(L, -1, TCHAR_TO_UTF8(*FuncName)) == LUA_TFUNCTION)
+        {
+            FunctionRef = luaL_ref(L, LUA_REGISTRYINDEX);
+        }
+        else
+        {
+            UE_LOG(LogUnLua, Verbose, TEXT("Function %s doesn't exist!"), *FuncName);
+        }
+        lua_settop(L, Top);
+    }
+
     FLuaRetValues::FLuaRetValues(lua_State* L, int32 NumResults)
         : L(L), bValid(NumResults > -1)
     {
@@ -143,6 +143,17 @@ TSharedPtr<FFieldDesc> FClassDesc::RegisterField(FName FieldName, FClassDesc* Qu
     return FieldDesc;
 }
 
+const FScriptStructField* FClassDesc::AddStructField(FProperty* Property)
+{
+    if (!bIsScriptStruct || !bIsNative)
+        return nullptr;
+
+    auto Field = FScriptStructField::Create(Property);
+    if (!Field)
+        return nullptr;
+    return StructFields.Add_GetRef(MoveTemp(Field)).Get();
+}
+
 void FClassDesc::GetInheritanceChain(TArray<FClassDesc*>& DescChain)
 {
     DescChain.Add(this);
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "CoreUObject.h"
+#include "ScriptStructField.h"
 
 namespace UnLua
 {
@@ -79,6 +80,13 @@ public:
 
     TSharedPtr<FFieldDesc> RegisterField(FName FieldName, FClassDesc *QueryClass = nullptr);
 
+    /**
+     * Create the accessor of a field of a native script struct, it lives as long as this descriptor
+     *
+     * @return - null if the field has no fast accessor
+     */
+    const FScriptStructField* AddStructField(FProperty* Property);
+
     void GetInheritanceChain(TArray<FClassDesc*>& Chain);
 
     void Load();
@@ -102,6 +110,7 @@ private:
     TMap<FName, TSharedPtr<FFieldDesc>> Fields;
     TArray<TSharedPtr<FPropertyDesc>> Properties;
     TArray<TSharedPtr<FFunctionDesc>> Functions;
+    TArray<TUniquePtr<FScriptStructField>> StructFields; // referenced by the metatable, kept when unloaded
     TArray<FClassDesc*> SuperClasses;
     UnLua::FLuaEnv* Env;
 
@@ -24,6 +24,7 @@
 #include "Kismet/KismetSystemLibrary.h"
 #include "LuaDeadLoopCheck.h"
 #include "Containers/StaticBitArray.h"
+#include "LuaBoundaryRecorder.h"
 
 /**
  * Function descriptor constructor
@@ -165,6 +166,40 @@ bool FFunctionDesc::CallLua(lua_State* L, int32 LuaRef, void* Params, UObject* S
     return bOk;
 }
 
+int32 FFunctionDesc::PushParams(lua_State* L, FFrame& Stack)
+{
+    void* Params = Stack.Locals;
+    const bool bUnpackParams = Stack.CurrentNativeFunction && Stack.Node != Stack.CurrentNativeFunction;
+    if (bUnpackParams)
+    {
+        Params = Buffer->Get();
+        for (FProperty* Property = (FProperty*)(Function->ChildProperties);
+             *Stack.Code != EX_EndFunctionParms;
+             Property = (FProperty*)(Property->Next))
+        {
+            Stack.Step(Stack.Object, Property->ContainerPtrToValuePtr<uint8>(Params));
+        }
+
+        check(Stack.PeekCode() == EX_EndFunctionParms);
+        Stack.SkipCode(1); // skip EX_EndFunctionParms
+    }
+
+    int32 NumParams = 0;
+    for (const auto& Property : Properties)
+    {
+        if (Property->IsReturnParameter())
+            continue;
+
+        // the values outlive the call
+        Property->ReadValue_InContainer(L, Params, true);
+        ++NumParams;
+    }
+
+    if (bUnpackParams && Params)
+        Buffer->Pop(Params);
+    return NumParams;
+}
+
 /**
  * Call the UFunction
  */
@@ -176,6 +211,10 @@ int32 FFunctionDesc::CallUE(lua_State *L, int32 NumParams, void *Userdata)
 
     check(Function.IsValid());
 
+#if UNLUA_WITH_BOUNDARY_RECORDER
+    const uint64 StartCycles = UNLIKELY(UnLua::FLuaBoundaryRecorder::IsRecording()) ? FPlatformTime::Cycles64() : 0;
+#endif
+
     UObject* Object;
     int32 FirstParamIndex;
     if (bStaticFunc)
@@ -206,6 +245,13 @@ int32 FFunctionDesc::CallUE(lua_State *L, int32 NumParams, void *Userdata)
     FFlagArray CleanupFlags;
     const auto Params = Buffer->Get(); 
     PreCall(L, NumParams, FirstParamIndex, CleanupFlags, Params, Userdata);      // prepare values of properties
+
+#if UNLUA_WITH_BOUNDARY_RECORDER
+    UnLua::FLuaBoundaryRecorder::FShapes Shapes;
+    if (StartCycles)
+        UnLua::FLuaBoundaryRecorder::GetShapes(Function.Get(), Params, Shapes);
+#endif
+
     auto FinalFunction = bInterfaceFunc
                              ? Object->GetClass()->FindFunctionByName(Function->GetFName())
                              : Function.Get();
@@ -233,6 +279,12 @@ int32 FFunctionDesc::CallUE(lua_State *L, int32 NumParams, void *Userdata)
 
     int32 NumReturnValues = PostCall(L, NumParams, FirstParamIndex, Params, CleanupFlags);      // push 'out' properties to Lua stack
     Buffer->Pop(Params);
+
+#if UNLUA_WITH_BOUNDARY_RECORDER
+    if (StartCycles)
+        UnLua::FLuaBoundaryRecorder::Record(UnLua::FLuaBoundaryRecorder::EDirection::LuaToUE, UnLua::FLuaEnv::FindEnv(L), Object, Function.Get(), Shapes, StartCycles);
+#endif
+
     return NumReturnValues;
 }
 
@@ -309,7 +361,7 @@ void FFunctionDesc::PreCall(lua_State* L, int32 NumParams, int32 FirstParamIndex
         if (ParamIndex < NumParams)
         {   
 #if ENABLE_TYPE_CHECK == 1
-            FString ErrorMsg = "";
+            FString ErrorMsg;
             if (Property->CheckPropertyType(L, FirstParamIndex + ParamIndex, ErrorMsg))
                 CleanupFlags[i] = Property->WriteValue_InContainer(L, Params, FirstParamIndex + ParamIndex, false);
             else
@@ -334,7 +386,7 @@ void FFunctionDesc::PreCall(lua_State* L, int32 NumParams, int32 FirstParamIndex
             else
             {
 #if ENABLE_TYPE_CHECK == 1
-                FString ErrorMsg = "";
+                FString ErrorMsg;
                 if (!Property->CheckPropertyType(L, FirstParamIndex + ParamIndex, ErrorMsg))
                 {
                     UNLUA_LOGERROR(L, LogUnLua, Warning, TEXT("Invalid parameter type calling ufunction : %s,parameter : %d, error msg : %s"), *FuncName, ParamIndex, *ErrorMsg);
@@ -77,6 +77,13 @@ public:
     void CallLua(lua_State* L, lua_Integer FunctionRef, lua_Integer SelfRef, FFrame& Stack, RESULT_DECL);
  
     bool CallLua(lua_State* L, int32 LuaRef, void* Params, UObject* Self);
+
+    /**
+     * Push copies of the parameters of a call to this function, unpacked from the script code if needed
+     *
+     * @return - the number of values pushed on the stack
+     */
+    int32 PushParams(lua_State* L, FFrame& Stack);
  
     /**
      * Call this UFunction
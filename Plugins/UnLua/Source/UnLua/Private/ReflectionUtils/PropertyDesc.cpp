@@ -848,12 +848,13 @@ public:
                     return false;
                 }
 
-                lua_pushstring(L, "__name");
-                lua_rawget(L, -2);
-                FString MetatableName = lua_tostring(L, -1);
-                if (MetatableName.IsEmpty() || !MetatableName.Equals("TArray"))
+                luaL_getmetatable(L, "TArray");
+                if (!lua_rawequal(L, -1, -2))
                 {
-                    ErrorMsg = FString::Printf(TEXT("metatable name of userdata TArray needed but got %s"), *MetatableName);
+                    lua_pushstring(L, "__name");
+                    lua_rawget(L, -3);
+                    const char* MetatableName = lua_tostring(L, -1);
+                    ErrorMsg = FString::Printf(TEXT("metatable name of userdata TArray needed but got %s"), MetatableName ? UTF8_TO_TCHAR(MetatableName) : TEXT(""));
                     return false;
                 }
             }
@@ -983,12 +984,13 @@ public:
                     return false;
                 }
 
-                lua_pushstring(L, "__name");
-                lua_rawget(L, -2);
-                FString MetatableName = lua_tostring(L, -1);
-                if (MetatableName.IsEmpty() || !MetatableName.Equals("TMap"))
+                luaL_getmetatable(L, "TMap");
+                if (!lua_rawequal(L, -1, -2))
                 {
-                    ErrorMsg = FString::Printf(TEXT("metatable name of userdata TMap needed but got %s"), *MetatableName);
+                    lua_pushstring(L, "__name");
+                    lua_rawget(L, -3);
+                    const char* MetatableName = lua_tostring(L, -1);
+                    ErrorMsg = FString::Printf(TEXT("metatable name of userdata TMap needed but got %s"), MetatableName ? UTF8_TO_TCHAR(MetatableName) : TEXT(""));
                     return false;
                 }
             }
@@ -1121,12 +1123,13 @@ public:
                     return false;
                 }
 
-                lua_pushstring(L, "__name");
-                lua_rawget(L, -2);
-                FString MetatableName = lua_tostring(L, -1);
-                if (MetatableName.IsEmpty() || !MetatableName.Equals("TSet"))
+                luaL_getmetatable(L, "TSet");
+                if (!lua_rawequal(L, -1, -2))
                 {
-                    ErrorMsg = FString::Printf(TEXT("metatable name of userdata TSet needed but got %s"), *MetatableName);
+                    lua_pushstring(L, "__name");
+                    lua_rawget(L, -3);
+                    const char* MetatableName = lua_tostring(L, -1);
+                    ErrorMsg = FString::Printf(TEXT("metatable name of userdata TSet needed but got %s"), MetatableName ? UTF8_TO_TCHAR(MetatableName) : TEXT(""));
                     return false;
                 }
             }
@@ -1274,16 +1277,23 @@ public:
                 return false;
             }
 
-            lua_pushstring(L, "__name");
+            // metatables are unique per struct, so the last accepted one can be compared by identity
+            const void* Metatable = lua_topointer(L, -1);
+            const uint32 Generation = UnLua::FClassRegistry::GetMetatableGeneration();
+            if (Metatable == CheckedMetatable && Generation == CheckedGeneration)
+                return true;
+
+            lua_pushstring(L, "ClassDesc");
             lua_rawget(L, -2);
-            const char* MetatableName = lua_tostring(L, -1);
-            if (!MetatableName)
+            FClassDesc* CurrentClassDesc = (FClassDesc*)lua_touserdata(L, -1);
+            if (!CurrentClassDesc)
             {
-                ErrorMsg = FString::Printf(TEXT("metatable name of userdata needed but got nil"));
-                return false;
+                lua_pushstring(L, "__name");
+                lua_rawget(L, -3);
+                const char* MetatableName = lua_tostring(L, -1);
+                if (MetatableName)
+                    CurrentClassDesc = UnLua::FLuaEnv::FindEnv(L)->GetClassRegistry()->Find(MetatableName);
             }
-
-            FClassDesc* CurrentClassDesc = UnLua::FLuaEnv::FindEnv(L)->GetClassRegistry()->Find(MetatableName);
             if (!CurrentClassDesc)
             {
                 ErrorMsg = FString::Printf(TEXT("metatable of userdata needed in registry but got no found"));
@@ -1296,6 +1306,9 @@ public:
                 ErrorMsg = FString::Printf(TEXT("struct %s needed but got %s"), *StructProperty->Struct->GetName(), ScriptStruct? *ScriptStruct->GetName(): TEXT("nil"));
                 return false;
             }
+
+            CheckedMetatable = Metatable;
+            CheckedGeneration = Generation;
         }
 
         return true;
@@ -1306,6 +1319,10 @@ private:
     FTCHARToUTF8 StructName;
     int32 StructSize;
     uint8 UserdataPadding;
+#if ENABLE_TYPE_CHECK == 1
+    const void* CheckedMetatable = nullptr;
+    uint32 CheckedGeneration = 0;
+#endif
 };
 
 /**
@@ -0,0 +1,117 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#include "ScriptStructField.h"
+#include "LowLevel.h"
+#include "Registries/ClassRegistry.h"
+
+FScriptStructField::FScriptStructField(EKind InKind, FProperty* InProperty)
+    : Offset(InProperty->GetOffset_ForInternal()), Kind(InKind), BoolProperty(nullptr),
+      MetatableName(InKind == EKind::Struct ? *UnLua::LowLevel::GetMetatableName(CastFieldChecked<FStructProperty>(InProperty)->Struct) : TEXT(""))
+{
+    if (Kind == EKind::Bool)
+    {
+        BoolProperty = CastFieldChecked<FBoolProperty>(InProperty);
+    }
+    else if (Kind == EKind::Struct)
+    {
+        StructProperty = CastFieldChecked<FStructProperty>(InProperty);
+        StructSize = StructProperty->GetSize();
+        bPlainOldData = StructProperty->HasAnyPropertyFlags(CPF_IsPlainOldData);
+    }
+}
+
+bool FScriptStructField::CheckStruct(lua_State* L, int32 Index) const
+{
+    if (!lua_getmetatable(L, Index))
+        return false;
+
+    // metatables are unique per struct, so the last accepted one can be compared by identity
+    const void* Metatable = lua_topointer(L, -1);
+    const uint32 Generation = UnLua::FClassRegistry::GetMetatableGeneration();
+    if (Metatable == CheckedMetatable && Generation == CheckedGeneration)
+    {
+        lua_pop(L, 1);
+        return true;
+    }
+
+    luaL_getmetatable(L, MetatableName.Get());
+    const bool bSameStruct = lua_rawequal(L, -1, -2) != 0;
+    lua_pop(L, 2);
+    if (!bSameStruct)
+        return false;
+
+    CheckedMetatable = Metatable;
+    CheckedGeneration = Generation;
+    return true;
+}
+
+static bool GetNumericKind(const FProperty* Property, FScriptStructField::EKind& OutKind)
+{
+    using EKind = FScriptStructField::EKind;
+    if (Property->IsA<FInt8Property>())
+        OutKind = EKind::Int8;
+    else if (Property->IsA<FInt16Property>())
+        OutKind = EKind::Int16;
+    else if (Property->IsA<FIntProperty>())
+        OutKind = EKind::Int32;
+    else if (Property->IsA<FInt64Property>())
+        OutKind = EKind::Int64;
+    else if (Property->IsA<FByteProperty>())
+        OutKind = EKind::UInt8;
+    else if (Property->IsA<FUInt16Property>())
+        OutKind = EKind::UInt16;
+    else if (Property->IsA<FUInt32Property>())
+        OutKind = EKind::UInt32;
+    else if (Property->IsA<FUInt64Property>())
+        OutKind = EKind::UInt64;
+    else if (Property->IsA<FFloatProperty>())
+        OutKind = EKind::Float;
+    else if (Property->IsA<FDoubleProperty>())
+        OutKind = EKind::Double;
+    else
+        return false;
+    return true;
+}
+
+TUniquePtr<FScriptStructField> FScriptStructField::Create(FProperty* Property)
+{
+    if (!Property || Property->ArrayDim > 1)
+        return nullptr;
+
+    EKind Kind;
+    if (const auto EnumProperty = CastField<FEnumProperty>(Property))
+    {
+        if (!GetNumericKind(EnumProperty->GetUnderlyingProperty(), Kind))
+            return nullptr;
+    }
+    else if (Property->IsA<FBoolProperty>())
+    {
+        Kind = EKind::Bool;
+    }
+    else if (const auto StructProperty = CastField<FStructProperty>(Property))
+    {
+        // nested structs are pushed by reference like FScriptStructPropertyDesc does
+        if (!StructProperty->Struct->IsA<UScriptStruct>())
+            return nullptr;
+        Kind = EKind::Struct;
+    }
+    else if (!GetNumericKind(Property, Kind))
+    {
+        return nullptr;
+    }
+
+    return MakeUnique<FScriptStructField>(Kind, Property);
+}
@@ -0,0 +1,134 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#pragma once
+
+#include "CoreUObject.h"
+#include "lua.hpp"
+#include "LuaCore.h"
+#include "UnLuaBase.h"
+
+/**
+ * Precomputed accessor of a field of a native script struct. Numbers, bools, enums and nested structs are read
+ * and written at their offset, without a virtual call or a property descriptor.
+ */
+struct FScriptStructField
+{
+    enum class EKind : uint8
+    {
+        Int8,
+        Int16,
+        Int32,
+        Int64,
+        UInt8,
+        UInt16,
+        UInt32,
+        UInt64,
+        Float,
+        Double,
+        Bool,
+        Struct,
+    };
+
+    /**
+     * Create the accessor of a property
+     *
+     * @return - null if the property has no fast accessor
+     */
+    static TUniquePtr<FScriptStructField> Create(FProperty* Property);
+
+    FORCEINLINE void Read(lua_State* L, void* Container) const
+    {
+        uint8* Ptr = (uint8*)Container + Offset;
+        switch (Kind)
+        {
+        case EKind::Int8: lua_pushinteger(L, *(int8*)Ptr); break;
+        case EKind::Int16: lua_pushinteger(L, *(int16*)Ptr); break;
+        case EKind::Int32: lua_pushinteger(L, *(int32*)Ptr); break;
+        case EKind::Int64: lua_pushinteger(L, *(int64*)Ptr); break;
+        case EKind::UInt8: lua_pushinteger(L, *(uint8*)Ptr); break;
+        case EKind::UInt16: lua_pushinteger(L, *(uint16*)Ptr); break;
+        case EKind::UInt32: lua_pushinteger(L, *(uint32*)Ptr); break;
+        case EKind::UInt64: lua_pushinteger(L, (lua_Integer)*(uint64*)Ptr); break;
+        case EKind::Float: lua_pushnumber(L, *(float*)Ptr); break;
+        case EKind::Double: lua_pushnumber(L, *(double*)Ptr); break;
+        case EKind::Bool: lua_pushboolean(L, BoolProperty->GetPropertyValue(Ptr)); break;
+        case EKind::Struct: UnLua::PushPointer(L, Ptr, MetatableName.Get(), Offset == 0); break;
+        }
+    }
+
+    /**
+     * Write the value at the given stack index
+     *
+     * @return - false if the value has an unexpected type, nothing is written
+     */
+    FORCEINLINE bool Write(lua_State* L, void* Container, int32 Index) const
+    {
+        const int32 Type = lua_type(L, Index);
+        if (Type != (Kind == EKind::Bool ? LUA_TBOOLEAN : Kind == EKind::Struct ? LUA_TUSERDATA : LUA_TNUMBER))
+            return false;
+
+        uint8* Ptr = (uint8*)Container + Offset;
+        switch (Kind)
+        {
+        case EKind::Int8: *(int8*)Ptr = (int8)lua_tointeger(L, Index); break;
+        case EKind::Int16: *(int16*)Ptr = (int16)lua_tointeger(L, Index); break;
+        case EKind::Int32: *(int32*)Ptr = (int32)lua_tointeger(L, Index); break;
+        case EKind::Int64: *(int64*)Ptr = (int64)lua_tointeger(L, Index); break;
+        case EKind::UInt8: *(uint8*)Ptr = (uint8)lua_tointeger(L, Index); break;
+        case EKind::UInt16: *(uint16*)Ptr = (uint16)lua_tointeger(L, Index); break;
+        case EKind::UInt32: *(uint32*)Ptr = (uint32)lua_tointeger(L, Index); break;
+        case EKind::UInt64: *(uint64*)Ptr = (uint64)lua_tointeger(L, Index); break;
+        case EKind::Float: *(float*)Ptr = (float)lua_tonumber(L, Index); break;
+        case EKind::Double: *(double*)Ptr = (double)lua_tonumber(L, Index); break;
+        case EKind::Bool: BoolProperty->SetPropertyValue(Ptr, lua_toboolean(L, Index) != 0); break;
+        case EKind::Struct:
+            {
+                if (!CheckStruct(L, Index))
+                    return false;
+                const void* Value = GetCppInstanceFast(L, Index);
+                if (!Value)
+                    return false;
+                if (bPlainOldData)
+                    FMemory::Memcpy(Ptr, Value, StructSize);
+                else
+                    StructProperty->CopySingleValue(Ptr, Value);
+            }
+            break;
+        }
+        return true;
+    }
+
+    FScriptStructField(EKind InKind, FProperty* InProperty);
+
+    /**
+     * Whether the userdata at the given index is an instance of the struct of the field itself, by metatable identity.
+     * Derived and unrelated structs are left to the generic path, which checks and reports them.
+     */
+    bool CheckStruct(lua_State* L, int32 Index) const;
+
+    int32 Offset;
+    EKind Kind;
+    bool bPlainOldData = false;
+    int32 StructSize = 0;
+    union
+    {
+        FBoolProperty* BoolProperty;
+        FStructProperty* StructProperty;
+    };
+    FTCHARToUTF8 MetatableName;
+    mutable const void* CheckedMetatable = nullptr;
+    mutable uint32 CheckedGeneration = 0;
+};
@@ -26,6 +26,8 @@ extern int32 UObject_Delete(lua_State* L);
 
 namespace UnLua
 {
+    uint32 FClassRegistry::MetatableGeneration = 0;
+
     FClassRegistry::FClassRegistry(FLuaEnv* Env)
         : Env(Env)
     {
@@ -33,6 +35,7 @@ namespace UnLua
 
     FClassRegistry::~FClassRegistry()
     {
+        ++MetatableGeneration;
         for (const auto Pair : Name2Classes)
             delete Pair.Value;
     }
@@ -124,7 +127,7 @@ namespace UnLua
         lua_pop(L, 1);
 
         if (FindExportedNonReflectedClass(MetatableName))
-            return false;
+            return PushExportedMetatable(L, MetatableName);
 
         FClassDesc* ClassDesc = RegisterReflectedType(MetatableName);
         if (!ClassDesc)
@@ -151,9 +154,22 @@ namespace UnLua
         UScriptStruct* ScriptStruct = ClassDesc->AsScriptStruct();
         if (ScriptStruct)
         {
+            // accessors of the struct fields, shared by __index and __newindex
+            lua_newtable(L);
+
             lua_pushstring(L, "__index");
-            lua_pushcfunction(L, ScriptStruct_Index);
-            lua_rawset(L, -3);
+            lua_pushvalue(L, -2);
+            lua_pushlightuserdata(L, ClassDesc);
+            lua_pushcclosure(L, ScriptStruct_Index, 2);
+            lua_rawset(L, -4);
+
+            lua_pushstring(L, "__newindex");
+            lua_pushvalue(L, -2);
+            lua_pushlightuserdata(L, ClassDesc);
+            lua_pushcclosure(L, ScriptStruct_NewIndex, 2);
+            lua_rawset(L, -4);
+
+            lua_pop(L, 1);
 
             lua_pushlightuserdata(L, ClassDesc);
 
@@ -235,6 +251,23 @@ namespace UnLua
         return true;
     }
 
+    bool FClassRegistry::PushExportedMetatable(lua_State* L, const char* MetatableName)
+    {
+        if (luaL_getmetatable(L, MetatableName) == LUA_TTABLE)
+            return true;
+        lua_pop(L, 1);
+
+        const auto Exported = FindExportedNonReflectedClass(MetatableName);
+        if (!Exported)
+            return false;
+
+        Exported->Register(L);
+        if (luaL_getmetatable(L, MetatableName) == LUA_TTABLE)
+            return true;
+        lua_pop(L, 1);
+        return false;
+    }
+
     bool FClassRegistry::TrySetMetatable(lua_State* L, const char* MetatableName)
     {
         if (!PushMetatable(L, MetatableName))
@@ -319,5 +352,6 @@ namespace UnLua
         const auto MetatableName = ClassDesc->GetName();
         lua_pushnil(L);
         lua_setfield(L, LUA_REGISTRYINDEX, TCHAR_TO_UTF8(*MetatableName));
+        ++MetatableGeneration;
     }
 }
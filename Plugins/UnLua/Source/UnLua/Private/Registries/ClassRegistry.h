@@ -44,6 +44,9 @@ namespace UnLua
 
         bool PushMetatable(lua_State* L, const char* MetatableName);
 
+        /** Push the metatable of a statically exported class, the class is registered on first use. */
+        static bool PushExportedMetatable(lua_State* L, const char* MetatableName);
+
         bool TrySetMetatable(lua_State* L, const char* MetatableName);
 
         FClassDesc* Register(const char* MetatableName);
@@ -52,11 +55,19 @@ namespace UnLua
 
         void Unregister(const UStruct* Class);
 
+        /**
+         * Bumped whenever a metatable is dropped, so metatable pointers cached by type checks can't be mistaken for a
+         * new table allocated at the same address.
+         */
+        static uint32 GetMetatableGeneration() { return MetatableGeneration; }
+
     private:
         FClassDesc* RegisterInternal(UStruct* Type, const FString& Name);
 
         void Unregister(const FClassDesc* ClassDesc, const bool bForce);
 
+        static uint32 MetatableGeneration;
+
         TMap<UStruct*, FClassDesc*> Classes;
         TMap<FName, FClassDesc*> Name2Classes;
 
@@ -21,14 +21,8 @@ namespace UnLua
 {
     FContainerRegistry::FContainerRegistry(FLuaEnv* Env)
         : Env(Env)
+        , ContainerIndex(Env->GetMainState(), true)
     {
-        // <FScriptArray, FLuaArray/FLuaMap/FLuaSet>
-        const auto L = Env->GetMainState();
-        lua_pushstring(L, "ScriptContainerMap");
-        LowLevel::CreateWeakValueTable(L);
-        lua_pushvalue(L, -1);
-        MapRef = luaL_ref(L, -1);
-        lua_rawset(L, LUA_REGISTRYINDEX);
     }
 
     FLuaArray* FContainerRegistry::NewArray(lua_State* L, TSharedPtr<ITypeInterface> ElementType, FLuaArray::EScriptArrayFlag Flag)
@@ -57,7 +51,7 @@ namespace UnLua
 
     void FContainerRegistry::FindOrAdd(lua_State* L, FScriptArray* ContainerPtr, TSharedPtr<ITypeInterface> ElementType)
     {
-        void* Userdata = CacheScriptContainer(L, ContainerPtr, FScriptContainerDesc::Array, [&](void* Cached)
+        void* Userdata = FindOrAddUserdata(L, ContainerPtr, FScriptContainerDesc::Array, [&](void* Cached)
         {
             const auto Array = (FLuaArray*)Cached;
             return Array->Inner == ElementType;
@@ -69,7 +63,7 @@ namespace UnLua
 
     void FContainerRegistry::FindOrAdd(lua_State* L, FScriptSet* ContainerPtr, TSharedPtr<ITypeInterface> ElementType)
     {
-        void* Userdata = CacheScriptContainer(L, ContainerPtr, FScriptContainerDesc::Set, [&](void* Cached)
+        void* Userdata = FindOrAddUserdata(L, ContainerPtr, FScriptContainerDesc::Set, [&](void* Cached)
         {
             const auto Set = (FLuaSet*)Cached;
             return Set->ElementInterface == ElementType;
@@ -81,7 +75,7 @@ namespace UnLua
 
     void FContainerRegistry::FindOrAdd(lua_State* L, FScriptMap* ContainerPtr, TSharedPtr<ITypeInterface> KeyType, TSharedPtr<ITypeInterface> ValueType)
     {
-        void* Userdata = CacheScriptContainer(L, ContainerPtr, FScriptContainerDesc::Map, [&](void* Cached)
+        void* Userdata = FindOrAddUserdata(L, ContainerPtr, FScriptContainerDesc::Map, [&](void* Cached)
         {
             const auto Map = (FLuaMap*)Cached;
             return Map->KeyInterface == KeyType && Map->ValueInterface == ValueType;
@@ -91,28 +85,57 @@ namespace UnLua
             new(Userdata) FLuaMap(ContainerPtr, KeyType, ValueType, FLuaMap::OwnedByOther);
     }
 
-    void FContainerRegistry::Remove(const FLuaArray* Container)
+    void FContainerRegistry::Remove(lua_State* L, int Index, const FLuaArray* Container)
     {
-        const auto L = Env->GetMainState();
-        RemoveCachedScriptContainer(L, Container->GetContainerPtr());
+        ContainerIndex.NotifyFinalized(L, Container->GetContainerPtr(), Index);
     }
 
-    void FContainerRegistry::Remove(const FLuaSet* Container)
+    void FContainerRegistry::Remove(lua_State* L, int Index, const FLuaSet* Container)
     {
-        const auto L = Env->GetMainState();
-        RemoveCachedScriptContainer(L, Container->GetContainerPtr());
+        ContainerIndex.NotifyFinalized(L, Container->GetContainerPtr(), Index);
     }
 
-    void FContainerRegistry::Remove(const FLuaMap* Container)
+    void FContainerRegistry::Remove(lua_State* L, int Index, const FLuaMap* Container)
     {
-        const auto L = Env->GetMainState();
-        RemoveCachedScriptContainer(L, Container->GetContainerPtr());
+        ContainerIndex.NotifyFinalized(L, Container->GetContainerPtr(), Index);
+    }
+
+    bool FContainerRegistry::PushCached(lua_State* L, const void* ContainerPtr)
+    {
+        return ContainerIndex.Push(L, ContainerPtr);
+    }
+
+    void FContainerRegistry::RemoveCached(const void* ContainerPtr)
+    {
+        ContainerIndex.Remove(ContainerPtr);
     }
 
     void* FContainerRegistry::NewUserdata(lua_State* L, const FScriptContainerDesc& Desc)
     {
         void* Userdata = NewUserdataWithContainerTag(L, Desc.GetSize());
-        luaL_setmetatable(L, Desc.GetName());
+        if (FClassRegistry::PushExportedMetatable(L, Desc.GetName()))
+            lua_setmetatable(L, -2);
+        return Userdata;
+    }
+
+    void* FContainerRegistry::FindOrAddUserdata(lua_State* L, void* ContainerPtr, const FScriptContainerDesc& Desc, const TFunctionRef<bool (void*)>& Validator)
+    {
+        if (!ContainerPtr)
+        {
+            UNLUA_LOGERROR(L, LogUnLua, Warning, TEXT("%s, Invalid key!"), ANSI_TO_TCHAR(__FUNCTION__));
+            return nullptr;
+        }
+
+        if (ContainerIndex.Push(L, ContainerPtr))
+        {
+            if (Validator(lua_touserdata(L, -1)))
+                return nullptr;
+            lua_pop(L, 1);
+        }
+
+        void* Userdata = NewUserdata(L, Desc);
+        ContainerIndex.Set(L, ContainerPtr, -1);
+        Env->GetDanglingCheck()->CaptureContainer(L, ContainerPtr);
         return Userdata;
     }
 }
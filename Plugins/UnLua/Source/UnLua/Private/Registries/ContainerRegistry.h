@@ -19,6 +19,7 @@
 #include "Containers/LuaArray.h"
 #include "Containers/LuaSet.h"
 #include "Containers/LuaMap.h"
+#include "LuaProxyIndex.h"
 
 namespace UnLua
 {
@@ -41,16 +42,33 @@ namespace UnLua
 
         void FindOrAdd(lua_State* L, FScriptMap* ContainerPtr, TSharedPtr<ITypeInterface> KeyType, TSharedPtr<ITypeInterface> ValueType);
 
-        void Remove(const FLuaArray* Container);
+        /**
+         * Called from the __gc of the container userdata at the given stack index.
+         */
+        void Remove(lua_State* L, int Index, const FLuaArray* Container);
 
-        void Remove(const FLuaSet* Container);
+        void Remove(lua_State* L, int Index, const FLuaSet* Container);
 
-        void Remove(const FLuaMap* Container);
+        void Remove(lua_State* L, int Index, const FLuaMap* Container);
+
+        /**
+         * Push the userdata cached for a script container.
+         * @return false if nothing is cached, nothing is pushed
+         */
+        bool PushCached(lua_State* L, const void* ContainerPtr);
+
+        void RemoveCached(const void* ContainerPtr);
         
     private:
         static void* NewUserdata(lua_State* L, const FScriptContainerDesc& Desc);
 
-        int MapRef;
+        /**
+         * Find a cached userdata for the container or create a new one
+         * @return null if a valid userdata is already cached, or the new created userdata otherwise
+         */
+        void* FindOrAddUserdata(lua_State* L, void* ContainerPtr, const FScriptContainerDesc& Desc, const TFunctionRef<bool (void*)>& Validator);
+
         FLuaEnv* Env;
+        FLuaProxyIndex ContainerIndex;
     };
 }
@@ -1,6 +1,8 @@
 ﻿#include "FunctionRegistry.h"
 #include "lua.hpp"
 #include "LuaEnv.h"
+#include "LuaBoundaryRecorder.h"
+#include "LuaRPCBatcher.h"
 
 namespace UnLua
 {
@@ -15,71 +17,136 @@ namespace UnLua
         const auto Info = LuaFunctions.Find(Function);
         if (!Info)
             return;
+        if (Info->BatchIndex != INDEX_NONE)
+            Env->GetRPCBatcher().RemoveBatch(Env->GetMainState(), Info->BatchIndex);
         luaL_unref(Env->GetMainState(), LUA_REGISTRYINDEX, Info->LuaRef);
         LuaFunctions.Remove(Function);
     }
 
+    static void InvokeOverridden(ULuaFunction* Function, UObject* Context, FFrame& Stack, RESULT_DECL)
+    {
+        const auto Overridden = Function->GetOverridden();
+        if (Overridden && Stack.Code)
+            Overridden->Invoke(Context, Stack, RESULT_PARAM);
+    }
+
     void FFunctionRegistry::Invoke(ULuaFunction* Function, UObject* Context, FFrame& Stack, RESULT_DECL)
     {
         // TODO: refactor
         if (UNLIKELY(!Env->GetObjectRegistry()->IsBound(Context)))
-            Env->TryBind(Context);
+        {
+            if (!Env->GetObjectRegistry()->Materialize(Context))
+                Env->TryBind(Context);
+        }
 
         const auto SelfRef = Env->GetObjectRegistry()->GetBoundRef(Context);
-        check(SelfRef!=LUA_NOREF);
+        if (SelfRef == LUA_NOREF)
+        {
+            // 覆写清单预先创建了覆写，模块加载失败时对象绑定不上，转发给原函数
+            InvokeOverridden(Function, Context, Stack, RESULT_PARAM);
+            return;
+        }
 
         const auto L = Env->GetMainState();
         lua_Integer FuncRef;
         FFunctionDesc* FuncDesc;
+        int32 BatchIndex;
 
         const auto Exists = LuaFunctions.Find(Function);
         if (Exists)
         {
             FuncRef = Exists->LuaRef;
             FuncDesc = Exists->Desc.Get();
+            BatchIndex = Exists->BatchIndex;
         }
         else
         {
             FuncRef = LUA_NOREF;
             FuncDesc = new FFunctionDesc(Function, nullptr);
+            BatchIndex = INDEX_NONE;
 
-            lua_rawgeti(L, LUA_REGISTRYINDEX, SelfRef);
-            lua_getmetatable(L, -1);
-            do
+            if (Function->HasAnyFunctionFlags(FUNC_Net))
             {
-                lua_pushstring(L, FuncDesc->GetLuaFunctionName());
-                lua_rawget(L, -2);
-                if (lua_isfunction(L, -1))
+                // 用<Name>_Batch覆写的RPC先排队，每帧合并成一次Lua调用；一批调用来自多个对象，不传self
+                const auto BatchName = FString::Printf(TEXT("%s_Batch"), *Function->GetName());
+                FuncRef = FindLuaFunction(L, SelfRef, TCHAR_TO_UTF8(*BatchName));
+                if (FuncRef != LUA_NOREF)
                 {
-                    lua_pushvalue(L, -3);
-                    lua_remove(L, -3);
-                    lua_remove(L, -3);
-                    lua_pushvalue(L, -2);
-                    FuncRef = luaL_ref(L, LUA_REGISTRYINDEX);
-                    break;
+                    lua_rawgeti(L, LUA_REGISTRYINDEX, FuncRef);
+                    const char* FirstParam = lua_getlocal(L, nullptr, 1);
+                    const bool bHasSelf = FirstParam && FCStringAnsi::Strcmp(FirstParam, "self") == 0;
+                    lua_pop(L, 1);
+                    if (bHasSelf)
+                        UE_LOG(LogUnLua, Warning, TEXT("%s is called without self as Handler(Batch, Count), declare it with '.' instead of ':'"), *BatchName);
+                    BatchIndex = Env->GetRPCBatcher().AddBatch(FuncRef);
                 }
-                lua_pop(L, 1);
-                lua_pushstring(L, "Super");
-                lua_rawget(L, -2);
-                lua_remove(L, -2);
             }
-            while (lua_istable(L, -1));
-            lua_pop(L, 2);
-            
+
+            if (FuncRef == LUA_NOREF)
+                FuncRef = FindLuaFunction(L, SelfRef, FuncDesc->GetLuaFunctionName());
+
             FFunctionInfo Info;
             Info.LuaRef = FuncRef;
             Info.Desc = TUniquePtr<FFunctionDesc>(FuncDesc);
+            Info.BatchIndex = BatchIndex;
             LuaFunctions.Add(Function, MoveTemp(Info));
         }
 
         if (FuncRef == LUA_NOREF)
         {
             // 可能因为Lua模块加载失败导致找不到对应的function，转发给原函数
-            const auto Overridden = Function->GetOverridden();
-            if (Overridden && Stack.Code)
-                Overridden->Invoke(Context, Stack, RESULT_PARAM);
+            InvokeOverridden(Function, Context, Stack, RESULT_PARAM);
+            return;
+        }
+
+        if (BatchIndex != INDEX_NONE)
+        {
+            Env->GetRPCBatcher().Enqueue(L, BatchIndex, SelfRef, FuncDesc, Stack);
             return;
         }
+
+#if UNLUA_WITH_BOUNDARY_RECORDER
+        if (UNLIKELY(FLuaBoundaryRecorder::IsRecording()))
+        {
+            // parameters are only available before the call when invoked by ProcessEvent
+            const bool bUnpackParams = Stack.CurrentNativeFunction && Stack.Node != Stack.CurrentNativeFunction;
+            FLuaBoundaryRecorder::FShapes Shapes;
+            FLuaBoundaryRecorder::GetShapes(Function, bUnpackParams ? nullptr : Stack.Locals, Shapes);
+            const uint64 StartCycles = FPlatformTime::Cycles64();
+            FuncDesc->CallLua(L, FuncRef, SelfRef, Stack, RESULT_PARAM);
+            FLuaBoundaryRecorder::Record(FLuaBoundaryRecorder::EDirection::UEToLua, Env, Context, Function, Shapes, StartCycles);
+            return;
+        }
+#endif
+
         FuncDesc->CallLua(L, FuncRef, SelfRef, Stack, RESULT_PARAM);
     }
+
+    lua_Integer FFunctionRegistry::FindLuaFunction(lua_State* L, lua_Integer SelfRef, const char* FuncName)
+    {
+        lua_Integer FuncRef = LUA_NOREF;
+        lua_rawgeti(L, LUA_REGISTRYINDEX, SelfRef);
+        lua_getmetatable(L, -1);
+        do
+        {
+            lua_pushstring(L, FuncName);
+            lua_rawget(L, -2);
+            if (lua_isfunction(L, -1))
+            {
+                lua_pushvalue(L, -3);
+                lua_remove(L, -3);
+                lua_remove(L, -3);
+                lua_pushvalue(L, -2);
+                FuncRef = luaL_ref(L, LUA_REGISTRYINDEX);
+                break;
+            }
+            lua_pop(L, 1);
+            lua_pushstring(L, "Super");
+            lua_rawget(L, -2);
+            lua_remove(L, -2);
+        }
+        while (lua_istable(L, -1));
+        lua_pop(L, 2);
+        return FuncRef;
+    }
 }
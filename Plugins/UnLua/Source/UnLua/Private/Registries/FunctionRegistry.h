@@ -36,8 +36,11 @@ namespace UnLua
         {
             lua_Integer LuaRef;
             TUniquePtr<FFunctionDesc> Desc;
+            int32 BatchIndex = INDEX_NONE;
         };
 
+        static lua_Integer FindLuaFunction(lua_State* L, lua_Integer SelfRef, const char* FuncName);
+
         FLuaEnv* Env;
         TMap<ULuaFunction*, FFunctionInfo> LuaFunctions;
     };
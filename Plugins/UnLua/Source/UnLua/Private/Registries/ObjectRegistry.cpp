@@ -16,10 +16,13 @@
 #include "LowLevel.h"
 #include "LuaEnv.h"
 #include "UnLuaDelegates.h"
+#include "UnLuaManager.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Deferred Lua Instances"), STAT_UnLua_DeferredInstances, STATGROUP_UnLua);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Never Materialized Lua Instances"), STAT_UnLua_NeverMaterializedInstances, STATGROUP_UnLua);
 
 namespace UnLua
 {
-    static const char* REGISTRY_KEY = "UnLua_ObjectMap";
     static const char* MANUAL_REF_PROXY_MAP = "UnLua_ManualRefProxyMap";
 
     static int ReleaseSharedPtr(lua_State* L)
@@ -46,13 +49,10 @@ namespace UnLua
 
     FObjectRegistry::FObjectRegistry(FLuaEnv* Env)
         : Env(Env)
+        , ObjectIndex(Env->GetMainState(), false)
     {
         const auto L = Env->GetMainState();
 
-        lua_pushstring(L, REGISTRY_KEY);
-        LowLevel::CreateWeakValueTable(L);
-        lua_rawset(L, LUA_REGISTRYINDEX);
-
         lua_pushstring(L, MANUAL_REF_PROXY_MAP);
         LowLevel::CreateWeakValueTable(L);
         lua_rawset(L, LUA_REGISTRYINDEX);
@@ -72,11 +72,21 @@ namespace UnLua
 
     void FObjectRegistry::NotifyUObjectDeleted(UObject* Object)
     {
+        if (DeferredObjects.Num() > 0 && DeferredObjects.Remove(Object) > 0)
+        {
+            ++DeferredStats.NeverMaterialized;
+            DEC_DWORD_STAT(STAT_UnLua_DeferredInstances);
+            INC_DWORD_STAT(STAT_UnLua_NeverMaterializedInstances);
+            return;
+        }
         Unbind(Object);
     }
 
-    void FObjectRegistry::NotifyUObjectLuaGC(UObject* Object)
+    void FObjectRegistry::NotifyUObjectLuaGC(lua_State* L, UObject* Object, int Index)
     {
+        // a newer userdata of the object still needs the reference
+        if (!ObjectIndex.NotifyFinalized(L, Object, Index))
+            return;
         Env->AutoObjectReference.Remove(Object);
     }
 
@@ -95,19 +105,23 @@ namespace UnLua
             return;
         }
 
-        lua_getfield(L, LUA_REGISTRYINDEX, REGISTRY_KEY);
-        lua_pushlightuserdata(L, Object);
-        const auto Type = lua_rawget(L, -2);
-        if (Type == LUA_TNIL)
-        {
-            lua_pop(L, 1);
-            PushObjectCore(L, Object);
-            lua_pushlightuserdata(L, Object);
-            lua_pushvalue(L, -2);
-            lua_rawset(L, -4);
-            ObjectRefs.Add(Object, LUA_NOREF);
-        }
-        lua_remove(L, -2);
+        if (ObjectIndex.Push(L, Object))
+            return;
+
+        if (DeferredObjects.Num() > 0 && Materialize(Object) && ObjectIndex.Push(L, Object))
+            return;
+
+        PushObjectCore(L, Object);
+        ObjectIndex.Set(L, Object, -1);
+        ObjectRefs.Add(Object, LUA_NOREF);
+    }
+
+    bool FObjectRegistry::PushCached(lua_State* L, const UObject* Object)
+    {
+        if (ObjectIndex.Push(L, Object))
+            return true;
+
+        return DeferredObjects.Num() > 0 && Materialize((UObject*)Object) && ObjectIndex.Push(L, Object);
     }
 
     int FObjectRegistry::Bind(UObject* Object)
@@ -122,8 +136,6 @@ namespace UnLua
 
         int OldTop = lua_gettop(L);
 
-        lua_getfield(L, LUA_REGISTRYINDEX, REGISTRY_KEY);
-        lua_pushlightuserdata(L, Object);
         lua_newtable(L); // create a Lua table ('INSTANCE')
         PushObjectCore(L, Object); // push UObject ('RAW_UOBJECT')
         lua_pushstring(L, "Object");
@@ -157,7 +169,8 @@ namespace UnLua
 
         FUnLuaDelegates::OnObjectBinded.Broadcast(Object); // 'INSTANCE' is on the top of stack now
 
-        lua_rawset(L, -3);
+        // the instance replaces any userdata cached before, it is kept alive by the reference until unbound
+        ObjectIndex.Set(L, Object, -1);
         lua_pop(L, 1);
         return Ret;
     }
@@ -214,6 +227,25 @@ namespace UnLua
         lua_settop(L, Top);
     }
 
+    void FObjectRegistry::Defer(UObject* Object)
+    {
+        bool bAlreadyDeferred;
+        DeferredObjects.Add(Object, &bAlreadyDeferred);
+        if (bAlreadyDeferred)
+            return;
+        ++DeferredStats.Deferred;
+        INC_DWORD_STAT(STAT_UnLua_DeferredInstances);
+    }
+
+    bool FObjectRegistry::Materialize(UObject* Object)
+    {
+        if (DeferredObjects.Remove(Object) == 0)
+            return false;
+        ++DeferredStats.Materialized;
+        DEC_DWORD_STAT(STAT_UnLua_DeferredInstances);
+        return Env->GetManager()->BindInstance(Object);
+    }
+
     void FObjectRegistry::AddManualRef(lua_State* L, UObject* Object)
     {
         lua_getfield(L, LUA_REGISTRYINDEX, MANUAL_REF_PROXY_MAP);
@@ -248,12 +280,9 @@ namespace UnLua
     void FObjectRegistry::RemoveFromObjectMapAndPushToStack(UObject* Object)
     {
         const auto L = Env->GetMainState();
-        lua_getfield(L, LUA_REGISTRYINDEX, REGISTRY_KEY);
-        lua_pushlightuserdata(L, Object);
-        lua_rawget(L, -2);
-        lua_pushlightuserdata(L, Object);
-        lua_pushnil(L);
-        lua_rawset(L, -4);
-        lua_remove(L, -2);
+        if (ObjectIndex.Push(L, Object))
+            ObjectIndex.Remove(Object);
+        else
+            lua_pushnil(L);
     }
 }
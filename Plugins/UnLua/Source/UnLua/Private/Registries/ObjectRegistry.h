@@ -17,6 +17,7 @@
 #include "lua.hpp"
 #include "UnLuaBase.h"
 #include "ReflectionUtils/FunctionDesc.h"
+#include "LuaProxyIndex.h"
 
 namespace UnLua
 {
@@ -30,17 +31,33 @@ namespace UnLua
     class FObjectRegistry
     {
     public:
+        struct FDeferredStats
+        {
+            int32 Deferred = 0;
+            int32 Materialized = 0;
+            int32 NeverMaterialized = 0;
+        };
+
         explicit FObjectRegistry(FLuaEnv* Env);
 
         void NotifyUObjectDeleted(UObject* Object);
 
-        void NotifyUObjectLuaGC(UObject* Object);
+        /**
+         * Called from the __gc of the UObject userdata at the given stack index.
+         */
+        void NotifyUObjectLuaGC(lua_State* L, UObject* Object, int Index);
 
         template <typename T>
         void Push(lua_State* L, TSharedPtr<T> Ptr);
 
         void Push(lua_State* L, UObject* Object);
 
+        /**
+         * Push the cached userdata or bound instance of a UObject.
+         * @return false if the UObject has not been pushed to Lua yet, nothing is pushed
+         */
+        bool PushCached(lua_State* L, const UObject* Object);
+
         template <typename T>
         FORCEINLINE TSharedPtr<T> Get(lua_State* L, int Index);
 
@@ -66,6 +83,19 @@ namespace UnLua
          */
         void Unbind(UObject* Object);
 
+        /**
+         * 推迟创建UObject在Lua里的实例，直到UE或Lua第一次访问它。
+         */
+        void Defer(UObject* Object);
+
+        /**
+         * 为推迟绑定的UObject创建Lua实例并调用Initialize。
+         * @return 若该UObject没有被推迟绑定则返回false。
+         */
+        bool Materialize(UObject* Object);
+
+        FORCEINLINE const FDeferredStats& GetDeferredStats() const { return DeferredStats; }
+
         /**
          * 增加对指定对象的手动引用，并将对应的代理对象压入栈顶
          */;
@@ -81,6 +111,9 @@ namespace UnLua
 
         FLuaEnv* Env;
         TMap<UObject*, int32> ObjectRefs;
+        FLuaProxyIndex ObjectIndex;
+        TSet<UObject*> DeferredObjects;
+        FDeferredStats DeferredStats;
     };
 
     template <typename T>
@@ -38,6 +38,14 @@ static int UE_Index(lua_State* L)
         return 1;
     }
 
+    const auto ExportedEnum = UnLua::FindExportedEnum(Name);
+    if (ExportedEnum)
+    {
+        ExportedEnum->Register(L);
+        lua_rawget(L, 1);
+        return 1;
+    }
+
     const char Prefix = Name[0];
     const auto& Env = UnLua::FLuaEnv::FindEnvChecked(L);
     if (Prefix == 'U' || Prefix == 'A' || Prefix == 'F')
@@ -195,14 +195,9 @@ namespace UnLua
         bool bCreateUserdata = bAlwaysCreate;
         if (!bAlwaysCreate)
         {
-            // find the pointer from 'StructMap' first
-            lua_getfield(L, LUA_REGISTRYINDEX, "StructMap");
-            lua_pushlightuserdata(L, Value);
-            int32 Type = lua_rawget(L, -2);
-            if (Type == LUA_TUSERDATA)
+            // find the pointer from the struct index first
+            if (FLuaEnv::FindEnvChecked(L).GetStructIndex()->Push(L, Value))
             {
-                lua_remove(L, -2);
-
                 // check metatable is same?
                 bool bMTSame = false;
                 if (lua_getmetatable(L, -1))
@@ -223,7 +218,7 @@ namespace UnLua
                     if (lua_getmetatable(L, -1))
                     {
                         lua_pushstring(L, "__name");
-                        Type = lua_rawget(L,-2);
+                        const int32 Type = lua_rawget(L,-2);
                         if (LUA_TSTRING == Type)
                         {
                             CurMetatableName = UTF8_TO_TCHAR(lua_tostring(L,-1));
@@ -243,8 +238,6 @@ namespace UnLua
             }
             else
             {
-                check(Type == LUA_TNIL);
-                lua_pop(L, 1);
                 bCreateUserdata = true;     // create a new userdata if the value is not found
             }
         }
@@ -265,12 +258,10 @@ namespace UnLua
 
             if (!bAlwaysCreate)
             {
-                // cache the new userdata in 'StructMap
-                FLuaEnv::FindEnv(L)->GetDanglingCheck()->CaptureStruct(L, Value);
-                lua_pushlightuserdata(L, Value);
-                lua_pushvalue(L, -2);
-                lua_rawset(L, -4);
-                lua_remove(L, -2);
+                // cache the new userdata in the struct index
+                auto& Env = FLuaEnv::FindEnvChecked(L);
+                Env.GetDanglingCheck()->CaptureStruct(L, Value);
+                Env.GetStructIndex()->Set(L, Value, -1);
             }
         }
 
@@ -154,6 +154,10 @@ struct TMulticastDelegateTraits<FMulticastScriptDelegate>
     }
 };
 
+#if ENGINE_MAJOR_VERSION < 5
+typedef FTicker FTSTicker;
+#endif
+
 #if UE_VERSION_OLDER_THAN(5, 1, 0)
 
 template< class T >
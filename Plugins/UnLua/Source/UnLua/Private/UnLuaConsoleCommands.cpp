@@ -1,4 +1,13 @@
 ﻿#include "UnLuaConsoleCommands.h"
+#include "UnLua.h"
+#include "UnLuaManager.h"
+#include "LuaJobPool.h"
+#include "LuaBoundaryRecorder.h"
+#include "UnLuaSettings.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Components/InputComponent.h"
 
 #define LOCTEXT_NAMESPACE "UnLuaConsoleCommands"
 
@@ -20,6 +29,41 @@ namespace UnLua
               *LOCTEXT("CommandText_CollectGarbage", "Force collect garbage in lua env.").ToString(),
               FConsoleCommandWithArgsDelegate::CreateRaw(this, &FUnLuaConsoleCommands::CollectGarbage)
           ),
+          BenchCallCommand(
+              TEXT("lua.bench.call"),
+              *LOCTEXT("CommandText_BenchCall", "Compares UnLua::Call with FLuaFunctionHandle::Invoke in lua env.").ToString(),
+              FConsoleCommandWithArgsDelegate::CreateRaw(this, &FUnLuaConsoleCommands::BenchCall)
+          ),
+          BenchInputsCommand(
+              TEXT("lua.bench.inputs"),
+              *LOCTEXT("CommandText_BenchInputs", "Spawns pawns of the given class, possesses each with the first player controller and measures input replacement, the first one building the binding plan of the class.").ToString(),
+              FConsoleCommandWithWorldAndArgsDelegate::CreateRaw(this, &FUnLuaConsoleCommands::BenchInputs)
+          ),
+          BenchJobsCommand(
+              TEXT("lua.bench.jobs"),
+              *LOCTEXT("CommandText_BenchJobs", "Runs the same jobs in lua env and in worker lua states, compares throughput and results.").ToString(),
+              FConsoleCommandWithArgsDelegate::CreateRaw(this, &FUnLuaConsoleCommands::BenchJobs)
+          ),
+          BenchEnvStartCommand(
+              TEXT("lua.bench.envstart"),
+              *LOCTEXT("CommandText_BenchEnvStart", "Measures lua env construction with eager and lazy registration of static exports.").ToString(),
+              FConsoleCommandWithArgsDelegate::CreateRaw(this, &FUnLuaConsoleCommands::BenchEnvStart)
+          ),
+          BenchEnvTemplateCommand(
+              TEXT("lua.bench.envtemplate"),
+              *LOCTEXT("CommandText_BenchEnvTemplate", "Measures lua env creation with the given modules required from scratch and from an env template.").ToString(),
+              FConsoleCommandWithArgsDelegate::CreateRaw(this, &FUnLuaConsoleCommands::BenchEnvTemplate)
+          ),
+          RecordStartCommand(
+              TEXT("lua.record.start"),
+              *LOCTEXT("CommandText_RecordStart", "Starts recording the calls between UE and lua to the given file, replayed by the UnLuaReplay commandlet.").ToString(),
+              FConsoleCommandWithArgsDelegate::CreateRaw(this, &FUnLuaConsoleCommands::RecordStart)
+          ),
+          RecordStopCommand(
+              TEXT("lua.record.stop"),
+              *LOCTEXT("CommandText_RecordStop", "Stops recording the calls between UE and lua.").ToString(),
+              FConsoleCommandWithArgsDelegate::CreateRaw(this, &FUnLuaConsoleCommands::RecordStop)
+          ),
           Module(InModule)
     {
     }
@@ -79,6 +123,290 @@ namespace UnLua
 
         Env->GC();
     }
+
+    void FUnLuaConsoleCommands::BenchCall(const TArray<FString>& Args) const
+    {
+        auto Env = Module->GetEnv();
+        if (!Env)
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("no available lua env found to run benchmark."));
+            return;
+        }
+
+        const int32 Iterations = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100000;
+        Env->DoString(TEXT("function UnLuaBenchCall(A, B) return A + B end"));
+
+        const auto L = Env->GetMainState();
+        int64 Sum = 0;
+        double StartTime = FPlatformTime::Seconds();
+        for (int32 i = 0; i < Iterations; ++i)
+        {
+            const auto RetValues = UnLua::Call(L, "UnLuaBenchCall", i, 1);
+            Sum += RetValues[0].Value<int32>();
+        }
+        const double CallTime = FPlatformTime::Seconds() - StartTime;
+
+        FLuaFunctionHandle Handle(Env, "UnLuaBenchCall");
+        StartTime = FPlatformTime::Seconds();
+        for (int32 i = 0; i < Iterations; ++i)
+            Sum -= Handle.Invoke<int32>(i, 1);
+        const double InvokeTime = FPlatformTime::Seconds() - StartTime;
+
+        check(Sum == 0);
+        Env->DoString(TEXT("UnLuaBenchCall = nil"));
+
+        UE_LOG(LogUnLua, Log, TEXT("lua.bench.call %d iterations: UnLua::Call %.1f ns/call, FLuaFunctionHandle::Invoke %.1f ns/call"),
+               Iterations, CallTime * 1e9 / Iterations, InvokeTime * 1e9 / Iterations);
+    }
+
+    void FUnLuaConsoleCommands::BenchInputs(const TArray<FString>& Args, UWorld* World) const
+    {
+        if (Args.Num() == 0)
+        {
+            UE_LOG(LogUnLua, Log, TEXT("usage: lua.bench.inputs <PawnClassPath> [Count]"));
+            return;
+        }
+
+        auto Env = Module->GetEnv();
+        if (!Env || !World)
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("no available lua env or world found to run benchmark."));
+            return;
+        }
+
+        APlayerController* PlayerController = World->GetFirstPlayerController();
+        if (!PlayerController || !PlayerController->IsLocalController())
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("no local player controller found to possess the pawns."));
+            return;
+        }
+
+        UClass* PawnClass = LoadClass<APawn>(nullptr, *Args[0]);
+        if (!PawnClass)
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("failed to load pawn class %s."), *Args[0]);
+            return;
+        }
+
+        const int32 Count = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 1000;
+        FActorSpawnParameters SpawnParameters;
+        SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+        TArray<APawn*> Pawns;
+        Pawns.Reserve(Count);
+        for (int32 i = 0; i < Count; ++i)
+        {
+            if (APawn* Pawn = Cast<APawn>(World->SpawnActor(PawnClass, nullptr, nullptr, SpawnParameters)))
+                Pawns.Add(Pawn);
+        }
+
+        // possessing creates the input component with the bindings of SetupPlayerInputComponent, the replacement
+        // queued for the next tick skips it as it is destroyed on unpossess
+        const auto Manager = Env->GetManager();
+        APawn* PossessedPawn = PlayerController->GetPawn();
+        // the plan of the class is built by the first replacement, unless a pawn of the class was possessed before
+        TArray<double> Times;
+        for (APawn* Pawn : Pawns)
+        {
+            PlayerController->Possess(Pawn);
+            if (Pawn->InputComponent)
+            {
+                const double StartTime = FPlatformTime::Seconds();
+                Manager->ReplaceInputs(Pawn, Pawn->InputComponent);
+                Times.Add(FPlatformTime::Seconds() - StartTime);
+            }
+            PlayerController->UnPossess(); // destroys the input component
+        }
+
+        if (PossessedPawn)
+            PlayerController->Possess(PossessedPawn);
+        for (APawn* Pawn : Pawns)
+            Pawn->Destroy();
+
+        if (Times.Num() == 0)
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("no input component created by the pawns of %s."), *PawnClass->GetName());
+            return;
+        }
+
+        double PlannedTime = 0;
+        for (int32 i = 1; i < Times.Num(); ++i)
+            PlannedTime += Times[i];
+        UE_LOG(LogUnLua, Log, TEXT("lua.bench.inputs %d possessed pawns of %s: first %.3f ms, then %.3f us per pawn"),
+               Times.Num(), *PawnClass->GetName(), Times[0] * 1e3, Times.Num() > 1 ? PlannedTime * 1e6 / (Times.Num() - 1) : 0.0);
+    }
+
+    void FUnLuaConsoleCommands::BenchJobs(const TArray<FString>& Args) const
+    {
+        auto Env = Module->GetEnv();
+        if (!Env)
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("no available lua env found to run benchmark."));
+            return;
+        }
+
+        const int32 NumJobs = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000;
+        const int32 Count = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 10000;
+
+        const auto L = Env->GetMainState();
+        const int32 Top = lua_gettop(L);
+        lua_getglobal(L, "require");
+        lua_pushstring(L, "UnLua.JobBench");
+        if (lua_pcall(L, 1, 1, 0) != LUA_OK || !lua_istable(L, -1))
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("failed to load UnLua.JobBench: %s"), UTF8_TO_TCHAR(lua_tostring(L, -1)));
+            lua_settop(L, Top);
+            return;
+        }
+        lua_getfield(L, -1, "Score");
+        const int32 FunctionIndex = lua_gettop(L);
+
+        // run every job on the game thread first, the results from worker states must be identical
+        TArray<TArray<uint8>> JobArgs;
+        TArray<TArray<uint8>> Expected;
+        JobArgs.SetNum(NumJobs);
+        Expected.SetNum(NumJobs);
+        FString Error;
+        double StartTime = FPlatformTime::Seconds();
+        for (int32 i = 0; i < NumJobs; ++i)
+        {
+            lua_pushvalue(L, FunctionIndex);
+            lua_createtable(L, 0, 2);
+            lua_pushinteger(L, i);
+            lua_setfield(L, -2, "Seed");
+            lua_pushinteger(L, Count);
+            lua_setfield(L, -2, "Count");
+            FLuaJobPool::Serialize(L, -1, JobArgs[i], Error);
+            if (lua_pcall(L, 1, 1, 0) != LUA_OK || !FLuaJobPool::Serialize(L, -1, Expected[i], Error))
+            {
+                UE_LOG(LogUnLua, Warning, TEXT("lua.bench.jobs failed on game thread: %s"), lua_isstring(L, -1) ? UTF8_TO_TCHAR(lua_tostring(L, -1)) : *Error);
+                lua_settop(L, Top);
+                return;
+            }
+            lua_pop(L, 1);
+        }
+        const double GameThreadTime = FPlatformTime::Seconds() - StartTime;
+        lua_settop(L, Top);
+
+        auto& JobPool = Env->GetJobPool();
+        int32 NumCompleted = 0;
+        int32 NumMismatched = 0;
+        StartTime = FPlatformTime::Seconds();
+        for (int32 i = 0; i < NumJobs; ++i)
+        {
+            JobPool.Submit(TEXT("UnLua.JobBench"), TEXT("Score"), MoveTemp(JobArgs[i]), [&, i](FLuaJob& Job)
+            {
+                ++NumCompleted;
+                if (!Job.bSucceeded)
+                {
+                    UE_LOG(LogUnLua, Warning, TEXT("lua.bench.jobs failed on worker: %s"), *Job.Error);
+                    ++NumMismatched;
+                }
+                else if (Job.Result != Expected[i])
+                {
+                    ++NumMismatched;
+                }
+            });
+        }
+        // the core ticker doesn't run while we wait, workers requiring a module wait for the custom loaders here
+        while (NumCompleted < NumJobs)
+        {
+            JobPool.ServeLoadRequests();
+            if (JobPool.Flush() == 0)
+                FPlatformProcess::Sleep(0);
+        }
+        const double WorkerTime = FPlatformTime::Seconds() - StartTime;
+
+        UE_LOG(LogUnLua, Log, TEXT("lua.bench.jobs %d jobs x %d: game thread %.1f jobs/s, %d worker states %.1f jobs/s, %d results differ"),
+               NumJobs, Count, NumJobs / GameThreadTime, JobPool.GetMaxEnvs(), NumJobs / WorkerTime, NumMismatched);
+    }
+
+    void FUnLuaConsoleCommands::BenchEnvStart(const TArray<FString>& Args) const
+    {
+        const int32 Count = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 20;
+        const auto Settings = GetMutableDefault<UUnLuaSettings>();
+        const bool bSavedRegisterOnStartup = Settings->bRegisterStaticExportsOnStartup;
+
+        const auto Measure = [&](bool bRegisterOnStartup)
+        {
+            Settings->bRegisterStaticExportsOnStartup = bRegisterOnStartup;
+            double Time = 0;
+            for (int32 i = 0; i < Count; ++i)
+            {
+                const double StartTime = FPlatformTime::Seconds();
+                const auto Env = new FLuaEnv();
+                Time += FPlatformTime::Seconds() - StartTime;
+                delete Env;
+            }
+            return Time * 1e3 / Count;
+        };
+
+        // warm up one-time costs shared by both modes
+        delete new FLuaEnv();
+        const double EagerTime = Measure(true);
+        const double LazyTime = Measure(false);
+        Settings->bRegisterStaticExportsOnStartup = bSavedRegisterOnStartup;
+
+        UE_LOG(LogUnLua, Log, TEXT("lua.bench.envstart %d envs: eager static exports %.3f ms/env, lazy static exports %.3f ms/env"),
+               Count, EagerTime, LazyTime);
+    }
+
+    void FUnLuaConsoleCommands::BenchEnvTemplate(const TArray<FString>& Args) const
+    {
+        const int32 Count = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 20;
+        TArray<FString> ModuleNames;
+        for (int32 i = 1; i < Args.Num(); ++i)
+            ModuleNames.Add(Args[i]);
+        if (ModuleNames.Num() == 0)
+            ModuleNames = GetDefault<UUnLuaSettings>()->WarmStartModules;
+
+        // the env used to build the template also warms up one-time costs shared by both modes
+        const auto Template = MakeShared<FLuaEnvTemplate, ESPMode::ThreadSafe>();
+        const auto TemplateEnv = new FLuaEnv();
+        const double BuildStartTime = FPlatformTime::Seconds();
+        const int32 NumModules = Template->Build(*TemplateEnv, ModuleNames);
+        const double BuildTime = (FPlatformTime::Seconds() - BuildStartTime) * 1e3;
+        delete TemplateEnv;
+
+        double ColdTime = 0;
+        double WarmTime = 0;
+        for (int32 i = 0; i < Count; ++i)
+        {
+            double StartTime = FPlatformTime::Seconds();
+            const auto ColdEnv = new FLuaEnv();
+            for (const auto& ModuleName : ModuleNames)
+                ColdEnv->DoString(FString::Printf(TEXT("require('%s')"), *ModuleName));
+            ColdTime += FPlatformTime::Seconds() - StartTime;
+            delete ColdEnv;
+
+            StartTime = FPlatformTime::Seconds();
+            const auto WarmEnv = new FLuaEnv(Template);
+            WarmEnv->Start(FString(), {});
+            WarmTime += FPlatformTime::Seconds() - StartTime;
+            delete WarmEnv;
+        }
+
+        UE_LOG(LogUnLua, Log, TEXT("lua.bench.envtemplate %d envs, %d modules compiled in %.3f ms: from scratch %.3f ms/env, from template %.3f ms/env"),
+               Count, NumModules, BuildTime, ColdTime * 1e3 / Count, WarmTime * 1e3 / Count);
+    }
+
+    void FUnLuaConsoleCommands::RecordStart(const TArray<FString>& Args) const
+    {
+#if UNLUA_WITH_BOUNDARY_RECORDER
+        const auto FilePath = Args.Num() > 0
+                                  ? Args[0]
+                                  : FPaths::ProjectSavedDir() / TEXT("UnLua") / FString::Printf(TEXT("Boundary_%s.ulbr"), *FDateTime::Now().ToString());
+        FLuaBoundaryRecorder::Start(FilePath);
+#else
+        UE_LOG(LogUnLua, Warning, TEXT("boundary recorder is not available in shipping builds."));
+#endif
+    }
+
+    void FUnLuaConsoleCommands::RecordStop(const TArray<FString>& Args) const
+    {
+#if UNLUA_WITH_BOUNDARY_RECORDER
+        FLuaBoundaryRecorder::Stop();
+#endif
+    }
 }
 
 #undef LOCTEXT_NAMESPACE
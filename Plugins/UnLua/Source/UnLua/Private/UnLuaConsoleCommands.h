@@ -27,6 +27,20 @@ namespace UnLua
 
         FAutoConsoleCommand CollectGarbageCommand;
 
+        FAutoConsoleCommand BenchCallCommand;
+
+        FAutoConsoleCommand BenchInputsCommand;
+
+        FAutoConsoleCommand BenchJobsCommand;
+
+        FAutoConsoleCommand BenchEnvStartCommand;
+
+        FAutoConsoleCommand BenchEnvTemplateCommand;
+
+        FAutoConsoleCommand RecordStartCommand;
+
+        FAutoConsoleCommand RecordStopCommand;
+
         explicit FUnLuaConsoleCommands(IUnLuaModule* InModule);
 
         void Do(const TArray<FString>& Args) const;
@@ -35,6 +49,20 @@ namespace UnLua
 
         void CollectGarbage(const TArray<FString>& Args) const;
 
+        void BenchCall(const TArray<FString>& Args) const;
+
+        void BenchInputs(const TArray<FString>& Args, UWorld* World) const;
+
+        void BenchJobs(const TArray<FString>& Args) const;
+
+        void BenchEnvStart(const TArray<FString>& Args) const;
+
+        void BenchEnvTemplate(const TArray<FString>& Args) const;
+
+        void RecordStart(const TArray<FString>& Args) const;
+
+        void RecordStop(const TArray<FString>& Args) const;
+
     private:
         IUnLuaModule* Module;
     };
@@ -16,6 +16,7 @@
 #include "UnLuaFunctionLibrary.h"
 #include "UnLuaDelegates.h"
 #include "UnLuaModule.h"
+#include "LuaOverrideManifest.h"
 
 FString UUnLuaFunctionLibrary::GetScriptRootPath()
 {
@@ -32,3 +33,8 @@ void UUnLuaFunctionLibrary::HotReload()
 {
     IUnLuaModule::Get().HotReload();
 }
+
+int32 UUnLuaFunctionLibrary::PrebindOverrides(bool bLoadClasses)
+{
+    return UnLua::FLuaOverrideManifest::Get().Prebind(bLoadClasses);
+}
@@ -1,6 +1,10 @@
 #include "UnLuaLib.h"
+#include "HotReloadWatcher.h"
 #include "LowLevel.h"
 #include "LuaEnv.h"
+#include "LuaJobPool.h"
+#include "LuaEventBus.h"
+#include "LuaTimerWheel.h"
 #include "UnLuaBase.h"
 
 namespace UnLua
@@ -56,9 +60,468 @@ namespace UnLua
                 LogError(L);
             }
 #endif
+            // modules reloaded partially before an error are stale too
+            if (const auto Env = FLuaEnv::FindEnv(L))
+                Env->NotifyHotReloaded();
             return 0;
         }
 
+        /**
+         * UnLua.GetModifiedModules(Serial) returns the names of modules modified after the given
+         * serial and the latest serial, or nil when the script directory is not being watched.
+         */
+        static int GetModifiedModules(lua_State* L)
+        {
+#if UNLUA_WITH_FILE_WATCHER
+            const auto& Watcher = FHotReloadWatcher::Get();
+            if (Watcher.IsRunning())
+            {
+                TArray<FString> ModuleNames;
+                const uint64 Since = lua_isnoneornil(L, 1) ? MAX_uint64 : (uint64)luaL_checkinteger(L, 1);
+                const uint64 Serial = Watcher.GetModifiedModules(Since, ModuleNames);
+                lua_createtable(L, ModuleNames.Num(), 0);
+                for (int32 i = 0; i < ModuleNames.Num(); i++)
+                {
+                    lua_pushstring(L, TCHAR_TO_UTF8(*ModuleNames[i]));
+                    lua_rawseti(L, -2, i + 1);
+                }
+                lua_pushinteger(L, (lua_Integer)Serial);
+                return 2;
+            }
+#endif
+            return 0;
+        }
+
+#if UNLUA_WITH_HOT_RELOAD
+        /**
+         * Walks the reachable Lua object graph once and substitutes old values by new ones, in table
+         * fields and keys, userdata user values and the locals of every live coroutine stack.
+         */
+        class FObjectGraphPatcher
+        {
+        public:
+            FObjectGraphPatcher(lua_State* InL, int32 InValueMapIndex)
+                : L(InL), ValueMapIndex(lua_absindex(InL, InValueMapIndex))
+            {
+                lua_newtable(L);
+                QueueIndex = lua_gettop(L);
+            }
+
+            ~FObjectGraphPatcher()
+            {
+                lua_remove(L, QueueIndex);
+            }
+
+            void Exclude(int32 Index)
+            {
+                Visited.Add(lua_topointer(L, Index));
+            }
+
+            /** Queue the value at the given index for traversal, unless it's already seen */
+            void Enqueue(int32 Index)
+            {
+                const int32 Type = lua_type(L, Index);
+                if (Type != LUA_TTABLE && Type != LUA_TFUNCTION && Type != LUA_TUSERDATA && Type != LUA_TTHREAD)
+                    return;
+
+                bool bAlreadyVisited;
+                Visited.Add(lua_topointer(L, Index), &bAlreadyVisited);
+                if (bAlreadyVisited)
+                    return;
+
+                lua_pushvalue(L, Index);
+                lua_rawseti(L, QueueIndex, ++Tail);
+            }
+
+            /** Push the replacement of the value at the given index, return false and push nothing if there is none */
+            bool PushReplacement(int32 Index)
+            {
+                const int32 Type = lua_type(L, Index);
+                if (Type != LUA_TTABLE && Type != LUA_TFUNCTION && Type != LUA_TUSERDATA)
+                    return false;
+
+                lua_pushvalue(L, Index);
+                if (lua_rawget(L, ValueMapIndex) != LUA_TNIL)
+                    return true;
+                lua_pop(L, 1);
+                return false;
+            }
+
+            void PatchStack(lua_State* Co, int32 StartLevel)
+            {
+                lua_Debug Ar;
+                for (int32 Level = StartLevel; lua_getstack(Co, Level, &Ar); ++Level)
+                {
+                    if (!lua_checkstack(Co, 2))
+                        return;
+
+                    lua_getinfo(Co, "f", &Ar);
+                    PatchLocal(Co, Ar, 0);
+
+                    for (int32 N = 1; PatchLocal(Co, Ar, N); ++N)
+                    {
+                    }
+                    for (int32 N = -1; PatchLocal(Co, Ar, N); --N)
+                    {
+                    }
+                }
+            }
+
+            int32 Run()
+            {
+                while (Head < Tail)
+                {
+                    lua_rawgeti(L, QueueIndex, ++Head);
+                    lua_pushnil(L);
+                    lua_rawseti(L, QueueIndex, Head);
+
+                    const int32 Index = lua_gettop(L);
+                    switch (lua_type(L, Index))
+                    {
+                    case LUA_TTABLE:
+                        PatchTable(Index);
+                        break;
+                    case LUA_TFUNCTION:
+                        PatchFunction(Index);
+                        break;
+                    case LUA_TUSERDATA:
+                        PatchUserdata(Index);
+                        break;
+                    case LUA_TTHREAD:
+                        PatchThread(lua_tothread(L, Index));
+                        break;
+                    default:
+                        break;
+                    }
+                    lua_settop(L, Index - 1);
+                }
+                return Visited.Num();
+            }
+
+        private:
+            void PatchThread(lua_State* Co)
+            {
+                if (Co == L)
+                    return;
+
+                lua_Debug Ar;
+                if (lua_getstack(Co, 0, &Ar))
+                {
+                    PatchStack(Co, 0);
+                    return;
+                }
+
+                // not started yet, the body and its arguments are still on the stack
+                if (lua_status(Co) != LUA_OK || !lua_checkstack(Co, 1))
+                    return;
+                for (int32 Index = 1; Index <= lua_gettop(Co); ++Index)
+                {
+                    lua_pushvalue(Co, Index);
+                    lua_xmove(Co, L, 1);
+                    Enqueue(-1);
+                    lua_pop(L, 1);
+                }
+            }
+
+            /** N == 0 patches the function running at the frame */
+            bool PatchLocal(lua_State* Co, lua_Debug& Ar, int32 N)
+            {
+                if (N != 0 && !lua_getlocal(Co, &Ar, N))
+                    return false;
+
+                if (Co != L)
+                    lua_xmove(Co, L, 1);
+
+                const int32 Index = lua_gettop(L);
+                if (N != 0 && PushReplacement(Index))
+                {
+                    Enqueue(-1);
+                    if (Co != L)
+                        lua_xmove(L, Co, 1);
+                    lua_setlocal(Co, &Ar, N);
+                }
+                else
+                {
+                    Enqueue(Index);
+                }
+                lua_settop(L, Index - 1);
+                return true;
+            }
+
+            void PatchTable(int32 Index)
+            {
+                if (lua_getmetatable(L, Index))
+                {
+                    Enqueue(-1);
+                    lua_pop(L, 1);
+                }
+
+                // keys can't be replaced while iterating, collect them first
+                int32 KeysIndex = 0;
+                lua_pushnil(L);
+                while (lua_next(L, Index))
+                {
+                    if (PushReplacement(-1))
+                    {
+                        Enqueue(-1);
+                        lua_pushvalue(L, -3);
+                        lua_insert(L, -2);
+                        lua_rawset(L, Index);
+                    }
+                    else
+                    {
+                        Enqueue(-1);
+                    }
+                    lua_pop(L, 1);
+
+                    if (PushReplacement(-1))
+                    {
+                        if (!KeysIndex)
+                        {
+                            lua_newtable(L);
+                            lua_insert(L, -3);
+                            KeysIndex = lua_absindex(L, -3);
+                        }
+                        lua_pushvalue(L, -2);
+                        lua_insert(L, -2);
+                        lua_rawset(L, KeysIndex);
+                    }
+                    else
+                    {
+                        Enqueue(-1);
+                    }
+                }
+
+                if (!KeysIndex)
+                    return;
+
+                lua_pushnil(L);
+                while (lua_next(L, KeysIndex))
+                {
+                    Enqueue(-1);
+                    lua_pushvalue(L, -2);
+                    lua_rawget(L, Index);                   // old key, new key, value
+                    lua_pushvalue(L, -3);
+                    lua_pushnil(L);
+                    lua_rawset(L, Index);
+                    lua_rawset(L, Index);
+                }
+                lua_remove(L, KeysIndex);
+            }
+
+            void PatchFunction(int32 Index)
+            {
+                for (int32 N = 1; lua_getupvalue(L, Index, N); ++N)
+                {
+                    // upvalues are matched by name in Lua, only follow them here
+                    if (PushReplacement(-1))
+                    {
+                        Enqueue(-1);
+                        lua_pop(L, 1);
+                    }
+                    else
+                    {
+                        Enqueue(-1);
+                    }
+                    lua_pop(L, 1);
+                }
+            }
+
+            void PatchUserdata(int32 Index)
+            {
+                if (lua_getmetatable(L, Index))
+                {
+                    Enqueue(-1);
+                    lua_pop(L, 1);
+                }
+
+                if (lua_getuservalue(L, Index) == LUA_TNONE)
+                {
+                    lua_pop(L, 1);
+                    return;
+                }
+
+                if (PushReplacement(-1))
+                {
+                    Enqueue(-1);
+                    lua_setuservalue(L, Index);
+                }
+                else
+                {
+                    Enqueue(-1);
+                }
+                lua_pop(L, 1);
+            }
+
+            lua_State* L;
+            int32 ValueMapIndex;
+            int32 QueueIndex;
+            int32 Head = 0;
+            int32 Tail = 0;
+            TSet<const void*> Visited;
+        };
+
+        /**
+         * UnLua.PatchObjectGraph(ValueMap, Exclude, StackLevel, ...) replaces every reference to a key of ValueMap
+         * by its value, in all objects reachable from the given roots and from the running stack at StackLevel
+         * and above. Keys of Exclude are skipped. Returns the number of objects visited.
+         */
+        static int PatchObjectGraph(lua_State* L)
+        {
+            luaL_checktype(L, 1, LUA_TTABLE);
+            luaL_checktype(L, 2, LUA_TTABLE);
+            const int32 StackLevel = (int32)luaL_optinteger(L, 3, 1);
+            const int32 NumRoots = lua_gettop(L);
+
+            FObjectGraphPatcher Patcher(L, 1);
+            Patcher.Exclude(1);
+            Patcher.Exclude(2);
+            lua_pushnil(L);
+            while (lua_next(L, 2))
+            {
+                lua_pop(L, 1);
+                Patcher.Exclude(-1);
+            }
+
+            Patcher.PatchStack(L, StackLevel);
+            for (int32 Index = 4; Index <= NumRoots; ++Index)
+                Patcher.Enqueue(Index);
+
+            lua_pushinteger(L, Patcher.Run());
+            return 1;
+        }
+#endif
+
+        /**
+         * UnLua.SetTimer(Seconds, Callback, bLoop) schedules a callback, returns a handle for UnLua.ClearTimer.
+         * Seconds are real time, timers keep running while the game is paused and ignore time dilation.
+         */
+        static int SetTimer(lua_State* L)
+        {
+            const lua_Number Delay = luaL_checknumber(L, 1);
+            luaL_checktype(L, 2, LUA_TFUNCTION);
+            const bool bLoop = !!lua_toboolean(L, 3);
+            if (bLoop && !(Delay > 0))
+                return luaL_error(L, "invalid interval for a looping timer");
+
+            auto& Env = FLuaEnv::FindEnvChecked(L);
+            lua_pushinteger(L, Env.GetTimerWheel().SetTimer(L, 2, Delay, bLoop));
+            return 1;
+        }
+
+        static int ClearTimer(lua_State* L)
+        {
+            const lua_Integer Handle = luaL_checkinteger(L, 1);
+            auto& Env = FLuaEnv::FindEnvChecked(L);
+            lua_pushboolean(L, Env.GetTimerWheel().ClearTimer(L, Handle));
+            return 1;
+        }
+
+        /**
+         * UnLua.StartCoroutine(Function, ...) runs the function in a pooled coroutine until its first wait.
+         * Pooled coroutines are reused once finished, don't keep the result of coroutine.running() around.
+         * Only the Wait functions suspend it until the scheduler resumes it, use UnLua.WaitFrames() to wait for the next
+         * frame, a plain coroutine.yield() stops scheduling it.
+         */
+        static int StartCoroutine(lua_State* L)
+        {
+            luaL_checktype(L, 1, LUA_TFUNCTION);
+            auto& Env = FLuaEnv::FindEnvChecked(L);
+            Env.GetCoroutineScheduler().Start(L, 1);
+            return 0;
+        }
+
+        static int WaitFrames(lua_State* L)
+        {
+            const lua_Integer NumFrames = luaL_optinteger(L, 1, 1);
+            auto& Env = FLuaEnv::FindEnvChecked(L);
+            return Env.GetCoroutineScheduler().WaitFrames(L, (int32)FMath::Clamp(NumFrames, (lua_Integer)1, (lua_Integer)MAX_int32));
+        }
+
+        static int WaitSeconds(lua_State* L)
+        {
+            const lua_Number Seconds = luaL_checknumber(L, 1);
+            auto& Env = FLuaEnv::FindEnvChecked(L);
+            return Env.GetCoroutineScheduler().WaitSeconds(L, Seconds);
+        }
+
+        static int WaitUntil(lua_State* L)
+        {
+            luaL_checktype(L, 1, LUA_TFUNCTION);
+            auto& Env = FLuaEnv::FindEnvChecked(L);
+            return Env.GetCoroutineScheduler().WaitUntil(L, 1);
+        }
+
+        /**
+         * UnLua.WaitEvent(Name) suspends the running coroutine until UnLua.SignalEvent(Name, Payload), returns the payload
+         */
+        static int WaitEvent(lua_State* L)
+        {
+            const char* EventName = luaL_checkstring(L, 1);
+            auto& Env = FLuaEnv::FindEnvChecked(L);
+            return Env.GetCoroutineScheduler().WaitEvent(L, FName(UTF8_TO_TCHAR(EventName)));
+        }
+
+        static int SignalEvent(lua_State* L)
+        {
+            const char* EventName = luaL_checkstring(L, 1);
+            auto& Env = FLuaEnv::FindEnvChecked(L);
+            lua_pushinteger(L, Env.GetCoroutineScheduler().SignalEvent(L, FName(UTF8_TO_TCHAR(EventName)), 2));
+            return 1;
+        }
+
+        /**
+         * UnLua.SubmitJob(ModuleName, FunctionName, Args, Callback) runs require(ModuleName)[FunctionName](Args) in a worker
+         * lua state without UObject access. Args and the result are copied, only nil, booleans, numbers, strings and tables
+         * of them can be passed. Callback(Result) or Callback(nil, Error) is called on the game thread, returns the job id.
+         */
+        static int SubmitJob(lua_State* L)
+        {
+            auto& Env = FLuaEnv::FindEnvChecked(L);
+            lua_pushinteger(L, Env.GetJobPool().Submit(L, 1));
+            return 1;
+        }
+
+        /**
+         * UnLua.AwaitJob(ModuleName, FunctionName, Args) submits a job like UnLua.SubmitJob and suspends the running coroutine
+         * until it's completed, returns the result or nil on error
+         */
+        static int AwaitJob(lua_State* L)
+        {
+            auto& Env = FLuaEnv::FindEnvChecked(L);
+            return Env.GetJobPool().Await(L, 1);
+        }
+
+        /**
+         * UnLua.Subscribe(Topic, Listener) adds a listener called with the arguments of each UnLua.Publish(Topic, ...)
+         * or FLuaEventBus::Publish to the topic, returns a handle for UnLua.Unsubscribe
+         */
+        static int Subscribe(lua_State* L)
+        {
+            luaL_checkstring(L, 1);
+            luaL_checktype(L, 2, LUA_TFUNCTION);
+            auto& Env = FLuaEnv::FindEnvChecked(L);
+            lua_pushinteger(L, Env.GetEventBus().Subscribe(L, 1, 2));
+            return 1;
+        }
+
+        static int Unsubscribe(lua_State* L)
+        {
+            const lua_Integer Handle = luaL_checkinteger(L, 1);
+            auto& Env = FLuaEnv::FindEnvChecked(L);
+            lua_pushboolean(L, Env.GetEventBus().Unsubscribe(L, Handle));
+            return 1;
+        }
+
+        static int Publish(lua_State* L)
+        {
+            luaL_checkstring(L, 1);
+            auto& Env = FLuaEnv::FindEnvChecked(L);
+            const int32 NumCalled = Env.GetEventBus().Publish(L, 1);
+            lua_pushinteger(L, NumCalled);
+            return 1;
+        }
+
         static int Ref(lua_State* L)
         {
             const auto Object = GetUObject(L, -1);
@@ -86,6 +549,23 @@ namespace UnLua
             {"LogWarn", LogWarn},
             {"LogError", LogError},
             {"HotReload", HotReload},
+            {"GetModifiedModules", GetModifiedModules},
+            {"SetTimer", SetTimer},
+            {"ClearTimer", ClearTimer},
+            {"StartCoroutine", StartCoroutine},
+            {"WaitFrames", WaitFrames},
+            {"WaitSeconds", WaitSeconds},
+            {"WaitUntil", WaitUntil},
+            {"WaitEvent", WaitEvent},
+            {"SignalEvent", SignalEvent},
+            {"SubmitJob", SubmitJob},
+            {"AwaitJob", AwaitJob},
+            {"Subscribe", Subscribe},
+            {"Unsubscribe", Unsubscribe},
+            {"Publish", Publish},
+#if UNLUA_WITH_HOT_RELOAD
+            {"PatchObjectGraph", PatchObjectGraph},
+#endif
             {"Ref", Ref},
             {"Unref", Unref},
             {"FTextEnabled", nullptr},
@@ -24,11 +24,41 @@
 #include "UnLuaInterface.h"
 #include "LuaCore.h"
 #include "LuaFunction.h"
+#include "LuaOverrideManifest.h"
+#include "LuaTickManager.h"
 #include "ObjectReferencer.h"
+#include "UnLuaSettings.h"
 
 
 static const TCHAR* SReadableInputEvent[] = { TEXT("Pressed"), TEXT("Released"), TEXT("Repeat"), TEXT("DoubleClick"), TEXT("Axis"), TEXT("Max") };
 
+static const FName NAME_ReceiveTick("ReceiveTick");
+
+/**
+ * Whether the module or any of its super modules asks for 'BatchedTick'
+ */
+static bool IsBatchedTickModule(lua_State* L, int32 ModuleRef)
+{
+    const auto Top = lua_gettop(L);
+    lua_rawgeti(L, LUA_REGISTRYINDEX, ModuleRef);
+    bool bBatched = false;
+    while (lua_istable(L, -1))
+    {
+        lua_pushstring(L, "BatchedTick");
+        if (lua_rawget(L, -2) != LUA_TNIL)
+        {
+            bBatched = !!lua_toboolean(L, -1);
+            break;
+        }
+        lua_pop(L, 1);
+        lua_pushstring(L, "Super");
+        lua_rawget(L, -2);
+        lua_remove(L, -2);
+    }
+    lua_settop(L, Top);
+    return bBatched;
+}
+
 UUnLuaManager::UUnLuaManager()
     : InputActionFunc(nullptr), InputAxisFunc(nullptr), InputTouchFunc(nullptr), InputVectorAxisFunc(nullptr), InputGestureFunc(nullptr), AnimNotifyFunc(nullptr)
 {
@@ -91,6 +121,27 @@ bool UUnLuaManager::Bind(UObject *Object, const TCHAR *InModuleName, int32 Initi
 
     // create a Lua instance for this UObject
     Env->GetObjectRegistry()->Bind(Class);
+
+    // the Lua instance is created on first access, an initializer table only lives during the creation
+    if (InitializerTableRef == LUA_NOREF && GetDefault<UUnLuaSettings>()->bDeferObjectInstances
+        && !Object->IsA<UClass>() && !Object->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+    {
+        const auto BindInfo = Classes.Find(Class);
+        if (!BindInfo || !BindInfo->bBatchedTick)
+        {
+            Env->GetObjectRegistry()->Defer(Object);
+            return true;
+        }
+    }
+
+    return BindInstance(Object, InitializerTableRef);
+}
+
+bool UUnLuaManager::BindInstance(UObject *Object, int32 InitializerTableRef)
+{
+    const auto Class = Object->IsA<UClass>() ? static_cast<UClass*>(Object) : Object->GetClass();
+    lua_State *L = Env->GetMainState();
+
     Env->GetObjectRegistry()->Bind(Object);
 
     // try call user first user function handler
@@ -113,6 +164,17 @@ bool UUnLuaManager::Bind(UObject *Object, const TCHAR *InModuleName, int32 Initi
         luaL_unref(L, LUA_REGISTRYINDEX, FunctionRef);
     }
 
+    if (!Object->IsA<UClass>() && !Object->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+    {
+        const auto BindInfo = Classes.Find(Class);
+        if (BindInfo && BindInfo->bBatchedTick)
+        {
+            if (!TickManager)
+                TickManager = new UnLua::FLuaTickManager(Env);
+            TickManager->Add(Object);
+        }
+    }
+
     return true;
 }
 
@@ -133,6 +195,8 @@ void UUnLuaManager::NotifyUObjectDeleted(const UObjectBase* Object)
  */
 void UUnLuaManager::Cleanup()
 {
+    delete TickManager;
+    TickManager = nullptr;
     Env = nullptr;
     Classes.Empty();
 }
@@ -145,6 +209,12 @@ int UUnLuaManager::GetBoundRef(const UClass* Class)
     return Info->TableRef;
 }
 
+FString UUnLuaManager::GetBoundModuleName(const UClass* Class) const
+{
+    const auto Info = Classes.Find(Class);
+    return Info ? Info->ModuleName : FString();
+}
+
 /**
  * Get all default Axis/Action inputs
  */
@@ -186,14 +256,15 @@ bool UUnLuaManager::ReplaceInputs(AActor *Actor, UInputComponent *InputComponent
     if (!BindInfo)
         return false;
 
-    auto& LuaFunctions = BindInfo->LuaFunctions;
-    ReplaceActionInputs(Actor, InputComponent, LuaFunctions);       // replace action inputs
-    ReplaceKeyInputs(Actor, InputComponent, LuaFunctions);          // replace key inputs
-    ReplaceAxisInputs(Actor, InputComponent, LuaFunctions);         // replace axis inputs
-    ReplaceTouchInputs(Actor, InputComponent, LuaFunctions);        // replace touch inputs
-    ReplaceAxisKeyInputs(Actor, InputComponent, LuaFunctions);      // replace AxisKey inputs
-    ReplaceVectorAxisInputs(Actor, InputComponent, LuaFunctions);   // replace VectorAxis inputs
-    ReplaceGestureInputs(Actor, InputComponent, LuaFunctions);      // replace gesture inputs
+    const auto& LuaFunctions = BindInfo->LuaFunctions;
+    auto& Plan = GetInputBindingPlan(*BindInfo);
+    ReplaceActionInputs(Actor, InputComponent, Plan);                               // replace action inputs
+    ReplaceKeyInputs(Actor, InputComponent, Plan);                                  // replace key inputs
+    ReplaceAxisInputs(Actor, InputComponent, Plan, LuaFunctions);                   // replace axis inputs
+    ReplaceTouchInputs(Actor, InputComponent, Plan);                                // replace touch inputs
+    ReplaceAxisKeyInputs(Actor, InputComponent, Plan, LuaFunctions);                // replace AxisKey inputs
+    ReplaceVectorAxisInputs(Actor, InputComponent, Plan, LuaFunctions);             // replace VectorAxis inputs
+    ReplaceGestureInputs(Actor, InputComponent, Plan, LuaFunctions);                // replace gesture inputs
 
     return true;
 }
@@ -302,12 +373,50 @@ bool UUnLuaManager::BindClass(UClass* Class, const FString& InModuleName, FStrin
     BindInfo.ModuleName = InModuleName;
     BindInfo.TableRef = Ref;
 
-    UnLua::LowLevel::GetFunctionNames(Env->GetMainState(), Ref, BindInfo.LuaFunctions);
-    ULuaFunction::GetOverridableFunctions(Class, BindInfo.UEFunctions);
+    UnLua::LowLevel::GetFunctionNames(Env->GetMainState(), Ref, BindInfo.LuaFunctions, Class);
+
+    // 清单中记录了覆写的函数时不再遍历类的所有函数；Lua里有清单之外的同名UFunction说明清单已过期，仍遍历所有函数
+    const auto ManifestEntry = UnLua::FLuaOverrideManifest::Get().Find(Class);
+    bool bManifestUpToDate = ManifestEntry && ManifestEntry->ModuleName == InModuleName;
+    if (bManifestUpToDate)
+    {
+        for (const auto& LuaFuncName : BindInfo.LuaFunctions)
+        {
+            if (!ManifestEntry->Functions.Contains(LuaFuncName) && Class->FindFunctionByName(LuaFuncName))
+            {
+                UE_LOG(LogUnLua, Warning, TEXT("Override manifest of %s misses %s, regenerate it with -run=UnLuaOverrideManifest"), *Class->GetPathName(), *LuaFuncName.ToString());
+                bManifestUpToDate = false;
+                break;
+            }
+        }
+    }
+    if (bManifestUpToDate)
+    {
+        for (const auto& FuncName : ManifestEntry->Functions)
+        {
+            if (const auto Function = UnLua::FLuaOverrideManifest::FindOverridableFunction(Class, FuncName))
+                BindInfo.UEFunctions.Add(FuncName, Function);
+        }
+    }
+    else
+    {
+        ULuaFunction::GetOverridableFunctions(Class, BindInfo.UEFunctions);
+    }
+
+    // 批量Tick时不覆写ReceiveTick，由TickManager统一调用；蓝图实现或父类已被Lua覆写时仍走原来的方式
+    if ((Class->IsChildOf<AActor>() || Class->IsChildOf<UActorComponent>())
+        && BindInfo.LuaFunctions.Contains(NAME_ReceiveTick) && IsBatchedTickModule(L, Ref))
+    {
+        const auto InheritedTick = Class->FindFunctionByName(NAME_ReceiveTick);
+        BindInfo.bBatchedTick = InheritedTick && !InheritedTick->IsA<ULuaFunction>() && InheritedTick->Script.Num() == 0;
+    }
 
     // 用LuaTable里所有的函数来替换Class上对应的UFunction
     for (const auto& LuaFuncName : BindInfo.LuaFunctions)
     {
+        if (BindInfo.bBatchedTick && LuaFuncName == NAME_ReceiveTick)
+            continue;
+
         UFunction** Func = BindInfo.UEFunctions.Find(LuaFuncName);
         if (Func)
         {
@@ -361,36 +470,122 @@ bool UUnLuaManager::BindClass(UClass* Class, const FString& InModuleName, FStrin
     return true;
 }
 
+/**
+ * Get the input binding plan of a class, build it if necessary
+ */
+UUnLuaManager::FInputBindingPlan& UUnLuaManager::GetInputBindingPlan(FClassBindInfo &BindInfo)
+{
+    // 热重载时（包括Lua里调用UnLua.HotReload()）代数会增加，方案随之重新生成
+    auto& Plan = BindInfo.InputPlan;
+    const auto Generation = Env->GetHotReloadGeneration();
+    if (Plan.bValid && Plan.Generation == Generation)
+        return Plan;
+
+    Plan = FInputBindingPlan();
+    Plan.bValid = true;
+    Plan.Generation = Generation;
+
+    // index all Lua functions named like '<Name>_<InputEvent>' by name and input event
+    static const FName NAME_Touch("Touch");
+    for (const FName& FuncName : BindInfo.LuaFunctions)
+    {
+        const FString FuncNameString = FuncName.ToString();
+        int32 SeparatorIndex;
+        if (!FuncNameString.FindLastChar(TEXT('_'), SeparatorIndex))
+            continue;
+
+        const TCHAR* Suffix = *FuncNameString + SeparatorIndex + 1;
+        for (int32 IE = 0; IE < IE_MAX; ++IE)
+        {
+            if (FCString::Stricmp(Suffix, SReadableInputEvent[IE]) == 0)
+            {
+                Plan.EventFunctions.FindOrAdd(FName(FuncNameString.Left(SeparatorIndex))).Functions[IE] = FuncName;
+                break;
+            }
+        }
+    }
+
+    if (const auto TouchFunctions = Plan.EventFunctions.Find(NAME_Touch))
+        Plan.TouchFunctions = *TouchFunctions;
+
+    const EInputEvent IEs[] = { IE_Pressed, IE_Released };
+    for (const FName& ActionName : DefaultActionNames)
+    {
+        const auto Functions = Plan.EventFunctions.Find(ActionName);
+        if (!Functions)
+            continue;
+        for (const EInputEvent IE : IEs)
+        {
+            if (!Functions->Functions[IE].IsNone())
+                Plan.DefaultActions.Add({FKey(), ActionName, Functions->Functions[IE], IE});
+        }
+    }
+
+    for (const FKey& Key : AllKeys)
+    {
+        const auto Functions = Plan.EventFunctions.Find(Key.GetFName());
+        if (!Functions)
+            continue;
+        for (const EInputEvent IE : IEs)
+        {
+            if (!Functions->Functions[IE].IsNone())
+                Plan.DefaultKeys.Add({Key, Key.GetFName(), Functions->Functions[IE], IE});
+        }
+    }
+
+    for (const FName& AxisName : DefaultAxisNames)
+    {
+        if (BindInfo.LuaFunctions.Contains(AxisName))
+            Plan.DefaultAxes.Add(AxisName);
+    }
+
+    return Plan;
+}
+
+/**
+ * Override an input UFunction once per class
+ */
+void UUnLuaManager::OverrideInput(FInputBindingPlan &Plan, UFunction *TemplateFunction, UClass *Class, FName FuncName)
+{
+    bool bAlreadyOverridden;
+    Plan.Overridden.Add(FuncName, &bAlreadyOverridden);
+    if (!bAlreadyOverridden)
+        ULuaFunction::Override(TemplateFunction, Class, FuncName);
+}
+
 /**
  * Replace action inputs
  */
-void UUnLuaManager::ReplaceActionInputs(AActor *Actor, UInputComponent *InputComponent, TSet<FName> &LuaFunctions)
+void UUnLuaManager::ReplaceActionInputs(AActor *Actor, UInputComponent *InputComponent, FInputBindingPlan &Plan)
 {
     UClass *Class = Actor->GetClass();
 
-    TSet<FName> ActionNames;
+    TArray<FName, TInlineAllocator<32>> ActionNames;
     int32 NumActionBindings = InputComponent->GetNumActionBindings();
     for (int32 i = 0; i < NumActionBindings; ++i)
     {
         FInputActionBinding &IAB = InputComponent->GetActionBinding(i);
         FName Name = GET_INPUT_ACTION_NAME(IAB);
-        FString ActionName = Name.ToString();
-        ActionNames.Add(Name);
+        ActionNames.AddUnique(Name);
+
+        const auto Functions = Plan.EventFunctions.Find(Name);
+        if (!Functions)
+            continue;
 
-        FName FuncName = FName(*FString::Printf(TEXT("%s_%s"), *ActionName, SReadableInputEvent[IAB.KeyEvent]));
-        if (LuaFunctions.Find(FuncName))
+        FName FuncName = Functions->Functions[IAB.KeyEvent];
+        if (!FuncName.IsNone())
         {
-            ULuaFunction::Override(InputActionFunc, Class, FuncName);
+            OverrideInput(Plan, InputActionFunc, Class, FuncName);
             IAB.ActionDelegate.BindDelegate(Actor, FuncName);
         }
 
         if (!IS_INPUT_ACTION_PAIRED(IAB))
         {
             EInputEvent IE = IAB.KeyEvent == IE_Pressed ? IE_Released : IE_Pressed;
-            FuncName = FName(*FString::Printf(TEXT("%s_%s"), *ActionName, SReadableInputEvent[IE]));
-            if (LuaFunctions.Find(FuncName))
+            FuncName = Functions->Functions[IE];
+            if (!FuncName.IsNone())
             {
-                ULuaFunction::Override(InputActionFunc, Class, FuncName);
+                OverrideInput(Plan, InputActionFunc, Class, FuncName);
                 FInputActionBinding AB(Name, IE);
                 AB.ActionDelegate.BindDelegate(Actor, FuncName);
                 InputComponent->AddActionBinding(AB);
@@ -398,35 +593,27 @@ void UUnLuaManager::ReplaceActionInputs(AActor *Actor, UInputComponent *InputCom
         }
     }
 
-    EInputEvent IEs[] = { IE_Pressed, IE_Released };
-    TSet<FName> DiffActionNames = DefaultActionNames.Difference(ActionNames);
-    for (TSet<FName>::TConstIterator It(DiffActionNames); It; ++It)
+    for (const auto& Binding : Plan.DefaultActions)
     {
-        FName ActionName = *It;
-        for (int32 i = 0; i < 2; ++i)
-        {
-            FName FuncName = FName(*FString::Printf(TEXT("%s_%s"), *ActionName.ToString(), SReadableInputEvent[IEs[i]]));
-            if (LuaFunctions.Find(FuncName))
-            {
-                ULuaFunction::Override(InputActionFunc, Class, FuncName);
-                FInputActionBinding AB(ActionName, IEs[i]);
-                AB.ActionDelegate.BindDelegate(Actor, FuncName);
-                InputComponent->AddActionBinding(AB);
-            }
-        }
+        if (ActionNames.Contains(Binding.Name))
+            continue;
+        OverrideInput(Plan, InputActionFunc, Class, Binding.FuncName);
+        FInputActionBinding AB(Binding.Name, Binding.InputEvent);
+        AB.ActionDelegate.BindDelegate(Actor, Binding.FuncName);
+        InputComponent->AddActionBinding(AB);
     }
 }
 
 /**
  * Replace key inputs
  */
-void UUnLuaManager::ReplaceKeyInputs(AActor *Actor, UInputComponent *InputComponent, TSet<FName> &LuaFunctions)
+void UUnLuaManager::ReplaceKeyInputs(AActor *Actor, UInputComponent *InputComponent, FInputBindingPlan &Plan)
 {
     UClass *Class = Actor->GetClass();
 
-    TArray<FKey> Keys;
-    TArray<bool> PairedKeys;
-    TArray<EInputEvent> InputEvents;
+    TArray<FKey, TInlineAllocator<16>> Keys;
+    TArray<bool, TInlineAllocator<16>> PairedKeys;
+    TArray<EInputEvent, TInlineAllocator<16>> InputEvents;
     for (FInputKeyBinding &IKB : InputComponent->KeyBindings)
     {
         int32 Index = Keys.Find(IKB.Chord.Key);
@@ -441,10 +628,11 @@ void UUnLuaManager::ReplaceKeyInputs(AActor *Actor, UInputComponent *InputCompon
             PairedKeys[Index] = true;
         }
 
-        FName FuncName = FName(*FString::Printf(TEXT("%s_%s"), *IKB.Chord.Key.ToString(), SReadableInputEvent[IKB.KeyEvent]));
-        if (LuaFunctions.Find(FuncName))
+        const auto Functions = Plan.EventFunctions.Find(IKB.Chord.Key.GetFName());
+        if (Functions && !Functions->Functions[IKB.KeyEvent].IsNone())
         {
-            ULuaFunction::Override(InputActionFunc, Class, FuncName);
+            const FName FuncName = Functions->Functions[IKB.KeyEvent];
+            OverrideInput(Plan, InputActionFunc, Class, FuncName);
             IKB.KeyDelegate.BindDelegate(Actor, FuncName);
         }
     }
@@ -453,11 +641,15 @@ void UUnLuaManager::ReplaceKeyInputs(AActor *Actor, UInputComponent *InputCompon
     {
         if (!PairedKeys[i])
         {
+            const auto Functions = Plan.EventFunctions.Find(Keys[i].GetFName());
+            if (!Functions)
+                continue;
+
             EInputEvent IE = InputEvents[i] == IE_Pressed ? IE_Released : IE_Pressed;
-            FName FuncName = FName(*FString::Printf(TEXT("%s_%s"), *Keys[i].ToString(), SReadableInputEvent[IE]));
-            if (LuaFunctions.Find(FuncName))
+            const FName FuncName = Functions->Functions[IE];
+            if (!FuncName.IsNone())
             {
-                ULuaFunction::Override(InputActionFunc, Class, FuncName);
+                OverrideInput(Plan, InputActionFunc, Class, FuncName);
                 FInputKeyBinding IKB(FInputChord(Keys[i]), IE);
                 IKB.KeyDelegate.BindDelegate(Actor, FuncName);
                 InputComponent->KeyBindings.Add(IKB);
@@ -465,82 +657,70 @@ void UUnLuaManager::ReplaceKeyInputs(AActor *Actor, UInputComponent *InputCompon
         }
     }
 
-    EInputEvent IEs[] = { IE_Pressed, IE_Released };
-    for (const FKey &Key : AllKeys)
+    for (const auto& Binding : Plan.DefaultKeys)
     {
-        if (Keys.Find(Key) != INDEX_NONE)
-        {
+        if (Keys.Contains(Binding.Key))
             continue;
-        }
-        for (int32 i = 0; i < 2; ++i)
-        {
-            FName FuncName = FName(*FString::Printf(TEXT("%s_%s"), *Key.ToString(), SReadableInputEvent[IEs[i]]));
-            if (LuaFunctions.Find(FuncName))
-            {
-                ULuaFunction::Override(InputActionFunc, Class, FuncName);
-                FInputKeyBinding IKB(FInputChord(Key), IEs[i]);
-                IKB.KeyDelegate.BindDelegate(Actor, FuncName);
-                InputComponent->KeyBindings.Add(IKB);
-            }
-        }
+        OverrideInput(Plan, InputActionFunc, Class, Binding.FuncName);
+        FInputKeyBinding IKB(FInputChord(Binding.Key), Binding.InputEvent);
+        IKB.KeyDelegate.BindDelegate(Actor, Binding.FuncName);
+        InputComponent->KeyBindings.Add(IKB);
     }
 }
 
 /**
  * Replace axis inputs
  */
-void UUnLuaManager::ReplaceAxisInputs(AActor *Actor, UInputComponent *InputComponent, TSet<FName> &LuaFunctions)
+void UUnLuaManager::ReplaceAxisInputs(AActor *Actor, UInputComponent *InputComponent, FInputBindingPlan &Plan, const TSet<FName> &LuaFunctions)
 {
     UClass *Class = Actor->GetClass();
 
-    TSet<FName> AxisNames;
+    TArray<FName, TInlineAllocator<32>> AxisNames;
     for (FInputAxisBinding &IAB : InputComponent->AxisBindings)
     {
-        AxisNames.Add(IAB.AxisName);
-        if (LuaFunctions.Find(IAB.AxisName))
+        AxisNames.AddUnique(IAB.AxisName);
+        if (LuaFunctions.Contains(IAB.AxisName))
         {
-            ULuaFunction::Override(InputAxisFunc, Class, IAB.AxisName);
+            OverrideInput(Plan, InputAxisFunc, Class, IAB.AxisName);
             IAB.AxisDelegate.BindDelegate(Actor, IAB.AxisName);
         }
     }
 
-    TSet<FName> DiffAxisNames = DefaultAxisNames.Difference(AxisNames);
-    for (TSet<FName>::TConstIterator It(DiffAxisNames); It; ++It)
+    for (const FName& AxisName : Plan.DefaultAxes)
     {
-        if (LuaFunctions.Find(*It))
-        {
-            ULuaFunction::Override(InputAxisFunc, Class, *It);
-            FInputAxisBinding &IAB = InputComponent->BindAxis(*It);
-            IAB.AxisDelegate.BindDelegate(Actor, *It);
-        }
+        if (AxisNames.Contains(AxisName))
+            continue;
+        OverrideInput(Plan, InputAxisFunc, Class, AxisName);
+        FInputAxisBinding &IAB = InputComponent->BindAxis(AxisName);
+        IAB.AxisDelegate.BindDelegate(Actor, AxisName);
     }
 }
 
 /**
  * Replace touch inputs
  */
-void UUnLuaManager::ReplaceTouchInputs(AActor *Actor, UInputComponent *InputComponent, TSet<FName> &LuaFunctions)
+void UUnLuaManager::ReplaceTouchInputs(AActor *Actor, UInputComponent *InputComponent, FInputBindingPlan &Plan)
 {
     UClass *Class = Actor->GetClass();
 
-    TArray<EInputEvent> InputEvents = { IE_Pressed, IE_Released, IE_Repeat };        // IE_DoubleClick?
+    TArray<EInputEvent, TInlineAllocator<3>> InputEvents = { IE_Pressed, IE_Released, IE_Repeat };        // IE_DoubleClick?
     for (FInputTouchBinding &ITB : InputComponent->TouchBindings)
     {
         InputEvents.Remove(ITB.KeyEvent);
-        FName FuncName = FName(*FString::Printf(TEXT("Touch_%s"), SReadableInputEvent[ITB.KeyEvent]));
-        if (LuaFunctions.Find(FuncName))
+        const FName FuncName = Plan.TouchFunctions.Functions[ITB.KeyEvent];
+        if (!FuncName.IsNone())
         {
-            ULuaFunction::Override(InputTouchFunc, Class, FuncName);
+            OverrideInput(Plan, InputTouchFunc, Class, FuncName);
             ITB.TouchDelegate.BindDelegate(Actor, FuncName);
         }
     }
 
     for (EInputEvent IE : InputEvents)
     {
-        FName FuncName = FName(*FString::Printf(TEXT("Touch_%s"), SReadableInputEvent[IE]));
-        if (LuaFunctions.Find(FuncName))
+        const FName FuncName = Plan.TouchFunctions.Functions[IE];
+        if (!FuncName.IsNone())
         {
-            ULuaFunction::Override(InputTouchFunc, Class, FuncName);
+            OverrideInput(Plan, InputTouchFunc, Class, FuncName);
             FInputTouchBinding ITB(IE);
             ITB.TouchDelegate.BindDelegate(Actor, FuncName);
             InputComponent->TouchBindings.Add(ITB);
@@ -551,15 +731,15 @@ void UUnLuaManager::ReplaceTouchInputs(AActor *Actor, UInputComponent *InputComp
 /**
  * Replace axis key inputs
  */
-void UUnLuaManager::ReplaceAxisKeyInputs(AActor *Actor, UInputComponent *InputComponent, TSet<FName> &LuaFunctions)
+void UUnLuaManager::ReplaceAxisKeyInputs(AActor *Actor, UInputComponent *InputComponent, FInputBindingPlan &Plan, const TSet<FName> &LuaFunctions)
 {
     UClass *Class = Actor->GetClass();
     for (FInputAxisKeyBinding &IAKB : InputComponent->AxisKeyBindings)
     {
         FName FuncName = IAKB.AxisKey.GetFName();
-        if (LuaFunctions.Find(FuncName))
+        if (LuaFunctions.Contains(FuncName))
         {
-            ULuaFunction::Override(InputAxisFunc, Class, FuncName);
+            OverrideInput(Plan, InputAxisFunc, Class, FuncName);
             IAKB.AxisDelegate.BindDelegate(Actor, FuncName);
         }
     }
@@ -568,15 +748,15 @@ void UUnLuaManager::ReplaceAxisKeyInputs(AActor *Actor, UInputComponent *InputCo
 /**
  * Replace vector axis inputs
  */
-void UUnLuaManager::ReplaceVectorAxisInputs(AActor *Actor, UInputComponent *InputComponent, TSet<FName> &LuaFunctions)
+void UUnLuaManager::ReplaceVectorAxisInputs(AActor *Actor, UInputComponent *InputComponent, FInputBindingPlan &Plan, const TSet<FName> &LuaFunctions)
 {
     UClass *Class = Actor->GetClass();
     for (FInputVectorAxisBinding &IVAB : InputComponent->VectorAxisBindings)
     {
         FName FuncName = IVAB.AxisKey.GetFName();
-        if (LuaFunctions.Find(FuncName))
+        if (LuaFunctions.Contains(FuncName))
         {
-            ULuaFunction::Override(InputVectorAxisFunc, Class, FuncName);
+            OverrideInput(Plan, InputVectorAxisFunc, Class, FuncName);
             IVAB.AxisDelegate.BindDelegate(Actor, FuncName);
         }
     }
@@ -585,15 +765,15 @@ void UUnLuaManager::ReplaceVectorAxisInputs(AActor *Actor, UInputComponent *Inpu
 /**
  * Replace gesture inputs
  */
-void UUnLuaManager::ReplaceGestureInputs(AActor *Actor, UInputComponent *InputComponent, TSet<FName> &LuaFunctions)
+void UUnLuaManager::ReplaceGestureInputs(AActor *Actor, UInputComponent *InputComponent, FInputBindingPlan &Plan, const TSet<FName> &LuaFunctions)
 {
     UClass *Class = Actor->GetClass();
     for (FInputGestureBinding &IGB : InputComponent->GestureBindings)
     {
         FName FuncName = IGB.GestureKey.GetFName();
-        if (LuaFunctions.Find(FuncName))
+        if (LuaFunctions.Contains(FuncName))
         {
-            ULuaFunction::Override(InputGestureFunc, Class, FuncName);
+            OverrideInput(Plan, InputGestureFunc, Class, FuncName);
             IGB.GestureDelegate.BindDelegate(Actor, FuncName);
         }
     }
@@ -27,8 +27,11 @@
 #include "UnLuaModule.h"
 #include "DefaultParamCollection.h"
 #include "GameDelegates.h"
+#include "HotReloadWatcher.h"
+#include "LuaBoundaryRecorder.h"
 #include "LuaEnvLocator.h"
 #include "LuaOverrides.h"
+#include "LuaOverrideManifest.h"
 #include "UnLuaDebugBase.h"
 #include "UnLuaInterface.h"
 #include "UnLuaSettings.h"
@@ -81,6 +84,9 @@ namespace UnLua
         {
             UnregisterSettings();
             SetActive(false);
+#if UNLUA_WITH_BOUNDARY_RECORDER
+            FLuaBoundaryRecorder::Stop();
+#endif
         }
 
         virtual bool IsActive() override
@@ -126,9 +132,18 @@ namespace UnLua
                         }
                     }
                 }
+
+                UnLua::FLuaOverrideManifest::Get().Prebind(false);
+
+#if UNLUA_WITH_FILE_WATCHER
+                FHotReloadWatcher::Get().Start();
+#endif
             }
             else
             {
+#if UNLUA_WITH_FILE_WATCHER
+                FHotReloadWatcher::Get().Stop();
+#endif
                 FCoreDelegates::OnHandleSystemError.Remove(OnHandleSystemErrorHandle);
                 FCoreDelegates::OnHandleSystemEnsure.Remove(OnHandleSystemEnsureHandle);
                 GUObjectArray.RemoveUObjectCreateListener(this);
@@ -40,5 +40,7 @@ namespace UnLua
 
     UNLUA_API IExportedClass* FindExportedNonReflectedClass(FString Name);
 
+    UNLUA_API IExportedEnum* FindExportedEnum(FString Name);
+
     UNLUA_API TSharedPtr<ITypeInterface> FindTypeInterface(FString Name);
 }
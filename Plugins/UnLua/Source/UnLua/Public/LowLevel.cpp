@@ -79,31 +79,48 @@ namespace UnLua
             return Struct->GetPathName();
         }
 
-        void GetFunctionNames(lua_State* L, const int TableRef, TSet<FName>& FunctionNames)
+        void GetFunctionNames(lua_State* L, const int TableRef, TSet<FName>& FunctionNames, const UClass* Class)
         {
             const auto Type = lua_rawgeti(L, LUA_REGISTRYINDEX, TableRef);
             if (Type == LUA_TNIL)
                 return;
 
+            struct FContext
+            {
+                TSet<FName>* Names;
+                const UClass* Class;
+            };
+
             static auto GetFunctionName = [](lua_State* L, void* Userdata)
             {
                 const auto ValueType = lua_type(L, -1);
                 if (ValueType != LUA_TFUNCTION)
                     return true;
 
-                auto Names = (TSet<FName>*)Userdata;
+                const auto Context = (FContext*)Userdata;
                 FString FuncName(lua_tostring(L, -2));
                 if (FuncName.EndsWith(TEXT("_RPC")))
+                {
                     FuncName = FuncName.Left(FuncName.Len() - 4);
-                Names->Add(FName(*FuncName));
+                }
+                else if (FuncName.EndsWith(TEXT("_Batch")) && Context->Class)
+                {
+                    // only a batched RPC, a function merely named like one keeps its name
+                    const auto NetFunction = Context->Class->FindFunctionByName(FName(*FuncName.Left(FuncName.Len() - 6)));
+                    if (NetFunction && NetFunction->HasAnyFunctionFlags(FUNC_Net))
+                        FuncName = FuncName.Left(FuncName.Len() - 6);
+                }
+                Context->Names->Add(FName(*FuncName));
                 return true;
             };
 
+            FContext Context{&FunctionNames, Class};
+
             auto N = 1;
             bool bNext;
             do
             {
-                bNext = TraverseTable(L, -1, &FunctionNames, GetFunctionName) > INDEX_NONE;
+                bNext = TraverseTable(L, -1, &Context, GetFunctionName) > INDEX_NONE;
                 if (bNext)
                 {
                     lua_pushstring(L, "Super");
@@ -58,8 +58,8 @@ namespace UnLua
 
         FString GetMetatableName(const UStruct* Struct);
 
-        /* 从指定的LuaTable及其Super中找到所有Lua方法名 */
-        void GetFunctionNames(lua_State* L, int TableRef, TSet<FName>& FunctionNames);
+        /* 从指定的LuaTable及其Super中找到所有Lua方法名，<Name>_Batch仅在Class有名为<Name>的RPC时视为<Name> */
+        void GetFunctionNames(lua_State* L, int TableRef, TSet<FName>& FunctionNames, const UClass* Class = nullptr);
 
         /* Get package.loaded[ModuleName] */
         int GetLoadedModule(lua_State* L, const char* ModuleName);
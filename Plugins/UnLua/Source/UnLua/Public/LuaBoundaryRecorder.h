@@ -0,0 +1,151 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if UNLUA_WITH_BOUNDARY_RECORDER
+
+class UWorld;
+
+namespace UnLua
+{
+    class FLuaEnv;
+
+    /**
+     * Records the calls crossing the UE/Lua boundary to a compact binary file, UE to Lua through FFunctionRegistry::Invoke
+     * and Lua to UE through FFunctionDesc::CallUE. Each call is stored with the class of the object, the function name,
+     * the shape of its parameters and its inclusive duration. Only used on the game thread.
+     */
+    class UNLUA_API FLuaBoundaryRecorder
+    {
+    public:
+        enum class EDirection : uint8
+        {
+            UEToLua,
+            LuaToUE,
+        };
+
+        static constexpr int32 MaxShapes = 16;
+
+        /** Number of elements of array, set and map parameters, length of string parameters, 0 for other parameters */
+        struct FShapes
+        {
+            uint32 Values[MaxShapes];
+            int32 Num = 0;
+            /** false when the parameters could not be read, e.g. an override called from blueprint bytecode */
+            bool bAvailable = true;
+        };
+
+        static bool Start(const FString& FilePath);
+
+        static void Stop();
+
+        FORCEINLINE static bool IsRecording() { return Active != nullptr; }
+
+        /** Parameters recorded and replayed in order, all parameters except the return value */
+        static bool IsRecordedParam(const FProperty* Property);
+
+        static void GetShapes(const UFunction* Function, const void* Params, FShapes& OutShapes);
+
+        /** Record a call which started at the given cycles and just returned, nothing is done if not recording */
+        static void Record(EDirection Direction, FLuaEnv* Env, const UObject* Object, const UFunction* Function, const FShapes& Shapes, uint64 StartCycles);
+
+        ~FLuaBoundaryRecorder();
+
+    private:
+        enum class ERecordType : uint8
+        {
+            Class = 1,
+            Name,
+            Call,
+        };
+
+        explicit FLuaBoundaryRecorder(FArchive* InFile);
+
+        void WriteCall(EDirection Direction, FLuaEnv* Env, const UObject* Object, const UFunction* Function, const FShapes& Shapes, uint64 DurationNs);
+
+        uint32 FindOrAddClass(FLuaEnv* Env, const UClass* Class);
+
+        uint32 FindOrAddName(FName Name);
+
+        void WriteVarInt(uint64 Value);
+
+        void WriteString(const FString& Value);
+
+        void Flush();
+
+        static FLuaBoundaryRecorder* Active;
+        FArchive* File;
+        TArray<uint8> Buffer;
+        TMap<const UClass*, uint32> ClassIndices;
+        TMap<FName, uint32> NameIndices;
+        uint64 NumCalls = 0;
+
+        friend class FLuaBoundaryReplay;
+    };
+
+    /**
+     * Re-issues the calls of a recording against stub objects and measures their cost. A stub is created for each
+     * recorded class and bound to the recorded module, actors are spawned in the given world. Parameters are default
+     * values, arrays and strings are sized after the recorded shapes, sets and maps are empty.
+     *
+     * Lua to UE calls may change the state of the world the other calls run in, only those of BlueprintPure or const
+     * functions are replayed unless allowed explicitly.
+     */
+    class UNLUA_API FLuaBoundaryReplay
+    {
+    public:
+        struct FFunctionStats
+        {
+            FString ClassPath;
+            FName FunctionName;
+            FLuaBoundaryRecorder::EDirection Direction;
+            int32 NumCalls = 0;
+            int32 NumSkipped = 0;
+            int32 NumWithoutParams = 0; // calls whose parameters were not recorded, replayed with default values
+            double RecordedNs = 0;
+            double ReplayedNs = 0;
+        };
+
+        bool Load(const FString& FilePath);
+
+        /**
+         * @param AllowedLuaToUE names of the Lua to UE functions replayed in addition to the BlueprintPure and const ones
+         * @return stats of each function ordered by total replayed time
+         */
+        TArray<FFunctionStats> Run(UWorld* World, int32 Repeats, const TSet<FName>& AllowedLuaToUE = TSet<FName>());
+
+        FORCEINLINE int32 GetNumCalls() const { return Calls.Num(); }
+
+    private:
+        struct FCall
+        {
+            FLuaBoundaryRecorder::EDirection Direction;
+            uint32 ClassIndex;
+            uint32 NameIndex;
+            uint64 DurationNs;
+            FLuaBoundaryRecorder::FShapes Shapes;
+        };
+
+        TArray<FString> ClassPaths;
+        TArray<FString> ModuleNames;
+        TArray<FName> Names;
+        TArray<FCall> Calls;
+    };
+}
+
+#endif
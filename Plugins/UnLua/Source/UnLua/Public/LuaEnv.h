@@ -29,29 +29,49 @@
 #include "LuaDanglingCheck.h"
 #include "LuaDeadLoopCheck.h"
 #include "LuaModuleLocator.h"
+#include "LuaEnvTemplate.h"
+#include "LuaProxyIndex.h"
 
 namespace UnLua
 {
+    class FLuaTimerWheel;
+    class FLuaCoroutineScheduler;
+    class FLuaJobEnv;
+    class FLuaJobPool;
+    class FLuaEventBus;
+    class FLuaRPCBatcher;
+    class FLuaActorPool;
+
     class UNLUA_API FLuaEnv
         : public FUObjectArray::FUObjectDeleteListener
     {
         friend FClassRegistry;
         friend FDelegateRegistry;
         friend FObjectRegistry;
+        friend FLuaJobEnv;
+        friend FLuaEnvTemplate;
 
     public:
         DECLARE_MULTICAST_DELEGATE_OneParam(FOnCreated, FLuaEnv&);
 
         DECLARE_MULTICAST_DELEGATE_OneParam(FOnDestroyed, FLuaEnv&);
 
+        DECLARE_MULTICAST_DELEGATE_OneParam(FOnHotReloaded, FLuaEnv&);
+
         DECLARE_DELEGATE_RetVal_FourParams(bool, FLuaFileLoader, const FLuaEnv& /* Env */, const FString& /* FilePath */, TArray<uint8>&/* Data */, FString&/* RealFilePath */);
 
         static FOnCreated OnCreated;
 
         static FOnDestroyed OnDestroyed;
 
+        /** Broadcast after the scripts of an env were hot reloaded, from C++ or from UnLua.HotReload() in Lua */
+        static FOnHotReloaded OnHotReloaded;
+
         FLuaEnv();
 
+        /** Create an env loading the modules of the template from their precompiled bytecode, they are required on start */
+        explicit FLuaEnv(TSharedPtr<const FLuaEnvTemplate, ESPMode::ThreadSafe> InTemplate);
+
         virtual ~FLuaEnv() override;
 
         static TMap<lua_State*, FLuaEnv*>& GetAll();
@@ -60,6 +80,9 @@ namespace UnLua
 
         static FLuaEnv& FindEnvChecked(const lua_State* L);
 
+        /** Unique to each env created by the process, unlike the main state a new env can be allocated at */
+        FORCEINLINE uint32 GetId() const { return Id; }
+
         void Start(const TMap<FString, UObject*>& Args = {});
 
         void Start(const FString& StartupModuleName, const TMap<FString, UObject*>& Args);
@@ -82,6 +105,12 @@ namespace UnLua
 
         virtual void HotReload();
 
+        /** Drop what was cached from the modules before a hot reload, called once the modules were reloaded */
+        void NotifyHotReloaded();
+
+        /** Incremented on each hot reload, cached Lua functions must be resolved again when it changes */
+        FORCEINLINE uint32 GetHotReloadGeneration() const { return HotReloadGeneration; }
+
         FORCEINLINE lua_State* GetMainState() const { return L; }
 
         void AddThread(lua_State* Thread, int32 ThreadRef);
@@ -94,6 +123,18 @@ namespace UnLua
 
         UUnLuaManager* GetManager();
 
+        FLuaTimerWheel& GetTimerWheel();
+
+        FLuaCoroutineScheduler& GetCoroutineScheduler();
+
+        FLuaJobPool& GetJobPool();
+
+        FLuaEventBus& GetEventBus();
+
+        FLuaRPCBatcher& GetRPCBatcher();
+
+        FLuaActorPool& GetActorPool();
+
         FORCEINLINE FClassRegistry* GetClassRegistry() const { return ClassRegistry; }
 
         FORCEINLINE FObjectRegistry* GetObjectRegistry() const { return ObjectRegistry; }
@@ -112,8 +153,19 @@ namespace UnLua
 
         FORCEINLINE FDeadLoopCheck* GetDeadLoopCheck() const { return DeadLoopCheck; }
 
+        /** Userdata of struct pointers pushed by UnLua::PushPointer */
+        FORCEINLINE FLuaProxyIndex* GetStructIndex() const { return StructIndex; }
+
         void AddLoader(const FLuaFileLoader Loader);
 
+        bool HasCustomLoaders() const;
+
+        /**
+         * Find a module with the custom loaders, including the legacy FUnLuaDelegates::CustomLoadLuaFile.
+         * @return false if no loader found it
+         */
+        bool LoadFromCustomLoaders(const FString& ModuleName, TArray<uint8>& Data, FString& ChunkName);
+
         void AddBuiltInLoader(const FString InName, lua_CFunction Loader);
 
         void AddManualObjectReference(UObject* Object);
@@ -129,6 +181,11 @@ namespace UnLua
 
         static int LoadFromFileSystem(lua_State* L);
 
+        static int LoadFromTemplate(lua_State* L);
+
+        /** Find the file of a module following the patterns of the package path, download directory first */
+        static bool FindModuleFile(const FString& PackagePath, FString ModuleName, TArray<uint8>& Data, FString& FullPath);
+
         static void* DefaultLuaAllocator(void* ud, void* ptr, size_t osize, size_t nsize);
 
         virtual lua_Alloc GetLuaAllocator() const;
@@ -176,12 +233,23 @@ namespace UnLua
         FEnumRegistry* EnumRegistry;
         FDanglingCheck* DanglingCheck;
         FDeadLoopCheck* DeadLoopCheck;
+        FLuaProxyIndex* StructIndex;
+        FLuaTimerWheel* TimerWheel = nullptr;
+        FLuaCoroutineScheduler* CoroutineScheduler = nullptr;
+        FLuaJobPool* JobPool = nullptr;
+        FLuaEventBus* EventBus = nullptr;
+        FLuaRPCBatcher* RPCBatcher = nullptr;
+        FLuaActorPool* ActorPool = nullptr;
+        TSharedPtr<const FLuaEnvTemplate, ESPMode::ThreadSafe> Template;
+        TSet<FString> PendingTemplateModules; // template modules not loaded yet, later loads go to the file system
         TMap<lua_State*, int32> ThreadToRef;
         TMap<int32, lua_State*> RefToThread;
         FDelegateHandle OnAsyncLoadingFlushUpdateHandle;
         TArray<UInputComponent*> CandidateInputComponents;
         FDelegateHandle OnWorldTickStartHandle;
         FString Name = TEXT("Env_0");
+        uint32 HotReloadGeneration = 0;
+        uint32 Id;
         bool bObjectArrayListenerRegistered;
         bool bStarted;
     };
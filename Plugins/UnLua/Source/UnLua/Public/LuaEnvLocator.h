@@ -47,4 +47,7 @@ public:
     UnLua::FLuaEnv* GetDefault();
 
     TMap<TWeakObjectPtr<UGameInstance>, TSharedPtr<UnLua::FLuaEnv, ESPMode::ThreadSafe>> Envs;
+
+    /** Built from the first env created for a game instance when UUnLuaSettings::WarmStartModules is not empty */
+    TSharedPtr<UnLua::FLuaEnvTemplate, ESPMode::ThreadSafe> Template;
 };
@@ -0,0 +1,68 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "lua.hpp"
+
+namespace UnLua
+{
+    class FLuaEnv;
+
+    /**
+     * Common Lua modules compiled once and shared by many envs. An env created from a template loads these modules from
+     * the precompiled bytecode instead of reading and parsing their files, and requires them when it starts.
+     */
+    class UNLUA_API FLuaEnvTemplate
+    {
+    public:
+        struct FModule
+        {
+            FString Name;
+            TArray<uint8> Bytecode;
+
+            friend FArchive& operator<<(FArchive& Ar, FModule& Module)
+            {
+                return Ar << Module.Name << Module.Bytecode;
+            }
+        };
+
+        /**
+         * Compile the given modules, and UnLua's own scripts loaded during env construction, along the package path of
+         * the given env. Modules not found on the file system are skipped and load normally in envs created later.
+         * Serialized templates are only valid for the Lua build that wrote them.
+         * @return number of modules compiled
+         */
+        int32 Build(FLuaEnv& Env, const TArray<FString>& ModuleNames);
+
+        const FModule* Find(const FString& ModuleName) const;
+
+        FORCEINLINE const TArray<FModule>& GetModules() const { return Modules; }
+
+        FORCEINLINE bool IsEmpty() const { return Modules.Num() == 0; }
+
+        void Reset();
+
+        friend UNLUA_API FArchive& operator<<(FArchive& Ar, FLuaEnvTemplate& Template);
+
+    private:
+        static int WriteBytecode(lua_State* L, const void* Data, size_t Size, void* UserData);
+
+        /** modules in the order they are required when an env starts */
+        TArray<FModule> Modules;
+        TMap<FString, int32> ModuleIndices;
+    };
+}
@@ -0,0 +1,104 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "lua.hpp"
+
+namespace UnLua
+{
+    class FLuaEnv;
+
+    /**
+     * Per env publish/subscribe of Lua listeners by topic name. The listeners of a topic are registry refs in a
+     * contiguous array, a publish calls all of them in a single protected call and goes on with the next listener
+     * if one raises an error. Listeners are called in subscription order, those subscribed during a publish are
+     * called from the next one.
+     */
+    class UNLUA_API FLuaEventBus
+    {
+    public:
+        explicit FLuaEventBus(FLuaEnv* InEnv);
+
+        /**
+         * Subscribe the function at FunctionIndex to the topic name at TopicIndex.
+         * @return handle of the listener, never zero
+         */
+        lua_Integer Subscribe(lua_State* L, int32 TopicIndex, int32 FunctionIndex);
+
+        /** @return false if the handle is unknown or already unsubscribed */
+        bool Unsubscribe(lua_State* L, lua_Integer Handle);
+
+        /**
+         * Publish to the topic name at TopicIndex, with all values above it as arguments.
+         * @return number of listeners called
+         */
+        int32 Publish(lua_State* L, int32 TopicIndex);
+
+        /**
+         * Publish to the topic from C++, arguments are pushed like UnLua::Call.
+         * @return number of listeners called
+         */
+        template <typename... T>
+        int32 Publish(FName Topic, T&&... Args);
+
+        int32 NumListeners(FName Topic) const;
+
+    private:
+        struct FListener
+        {
+            int32 FunctionRef;
+            uint32 Id;
+        };
+
+        struct FTopic
+        {
+            FName Name;
+            TArray<FListener> Listeners;
+            int32 DispatchDepth = 0;
+            bool bHasRemoved = false;
+        };
+
+        struct FDispatch
+        {
+            FLuaEventBus* Bus;
+            int32 Topic;
+            int32 Cursor;
+            int32 End;
+            int32 NumCalled;
+        };
+
+        /** @return index of the topic named by the lua string at NameIndex, INDEX_NONE if unknown and bAdd is false */
+        int32 FindTopic(lua_State* L, int32 NameIndex, bool bAdd);
+
+        int32 FindOrAddTopic(FName Name);
+
+        /** Call the listeners of the topic with the NumArgs values on top of the stack, which are popped */
+        int32 Dispatch(lua_State* L, int32 Topic, int32 NumArgs);
+
+        static int DispatchListeners(lua_State* L);
+
+        void Compact(FTopic& Topic);
+
+        FLuaEnv* Env;
+        TArray<FTopic> Topics;
+        TMap<FName, int32> TopicIndices;
+        int32 TopicNamesRef = LUA_NOREF;
+        uint32 NextId = 1;
+    };
+}
+
+#include "LuaEventBus.inl"
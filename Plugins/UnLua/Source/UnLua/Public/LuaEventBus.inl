@@ -0,0 +1,30 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "UnLuaLegacy.h"
+
+namespace UnLua
+{
+    template <typename... T>
+    int32 FLuaEventBus::Publish(FName Topic, T&&... Args)
+    {
+        const int32* Index = TopicIndices.Find(Topic);
+        if (!Index || Topics[*Index].Listeners.Num() == 0)
+            return 0;
+
+        lua_State* L = Env->GetMainState();
+        const int32 NumArgs = PushArgs<false>(L, Forward<T>(Args)...);
+        return Dispatch(L, *Index, NumArgs);
+    }
+}
@@ -143,4 +143,44 @@ namespace UnLua
         lua_State* L;
         int32 FunctionRef;
     };
+
+    /**
+     * Lua function handle, resolved once by name and resolved again after the env is hot reloaded.
+     * Invoke<RetType>(Args...) reads the results directly from the stack without allocating, RetType can be void,
+     * a value type or a TTuple of value types for multiple results.
+     * The handle may outlive its env, it is invalid once the env is destroyed.
+     */
+    struct UNLUA_API FLuaFunctionHandle
+    {
+        explicit FLuaFunctionHandle(FLuaEnv* Env, const char* GlobalFuncName);
+        explicit FLuaFunctionHandle(FLuaEnv* Env, const char* GlobalTableName, const char* FuncName);
+        ~FLuaFunctionHandle();
+
+        FLuaFunctionHandle(const FLuaFunctionHandle&) = delete;
+        FLuaFunctionHandle& operator=(const FLuaFunctionHandle&) = delete;
+
+        bool IsValid();
+
+        /**
+         * Call the function, a default constructed RetType is returned if the function doesn't exist or raises an error.
+         */
+        template <typename RetType = void, typename... T>
+        RetType Invoke(T&&... Args);
+
+    private:
+        /** The env the handle was created for, nullptr once destroyed. The state is only a key, never dereferenced */
+        FLuaEnv* GetEnv() const;
+
+        /** Push the message handler and the function, the handle must be valid */
+        void PushFunction();
+
+        void Resolve(FLuaEnv* Env);
+
+        lua_State* L;
+        uint32 EnvId;
+        FString TableName;
+        FString FuncName;
+        int32 FunctionRef;
+        uint32 Generation;
+    };
 }
@@ -138,9 +138,9 @@ namespace UnLua
         virtual ~IExportedEnum() {}
 
         virtual void Register(lua_State *L) = 0;
+        virtual FString GetName() const = 0;
 
 #if WITH_EDITOR
-        virtual FString GetName() const = 0;
         virtual void GenerateIntelliSense(FString &Buffer) const = 0;
 #endif
     };
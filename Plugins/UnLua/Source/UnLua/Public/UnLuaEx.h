@@ -17,6 +17,13 @@
 #include "UnLua.h"
 #include "Binding.h"
 
+/**
+ * Exported functions are dispatched at compile time when 'auto' template parameters (C++17) are available
+ */
+#ifndef UNLUA_WITH_STATIC_DISPATCH
+#define UNLUA_WITH_STATIC_DISPATCH (ENGINE_MAJOR_VERSION >= 5)
+#endif
+
 namespace UnLua
 {
 
@@ -38,7 +45,7 @@ namespace UnLua
 
     private:
         template <uint32... N>
-        void Construct(lua_State *L, TTuple<typename TArgTypeTraits<ArgType>::Type...> &Args, TIndices<N...>);
+        void Construct(lua_State *L, TIndices<N...>);
 
         FString ClassName;
     };
@@ -192,6 +199,95 @@ namespace UnLua
         FString ClassName;
     };
 
+#if UNLUA_WITH_STATIC_DISPATCH
+    /**
+     * Base of exported functions dispatched at compile time
+     */
+    struct FDispatchedFunctionBase : public IExportedFunction
+    {
+        FDispatchedFunctionBase(const FString &InName, const FString &InClassName)
+            : Name(InName), ClassName(InClassName)
+        {}
+
+#if WITH_EDITOR
+        virtual FString GetName() const override { return Name; }
+#endif
+
+        static int32 ReportInvalidArguments(lua_State *L, int32 Expected, int32 Actual);
+        static int32 ReportInvalidSelf(lua_State *L);
+
+    protected:
+        void RegisterClosure(lua_State *L, lua_CFunction Func);
+
+        FString Name;
+        FString ClassName;
+    };
+
+    /**
+     * Exported function whose target is a template argument. Each instantiation owns a distinct
+     * lua_CFunction which reads arguments straight from the Lua stack and calls the target directly.
+     */
+    template <auto Func>
+    struct TDispatchedFunction : public FDispatchedFunctionBase
+    {
+        TDispatchedFunction(const FString &InName, const FString &InClassName = FString())
+            : FDispatchedFunctionBase(InName, InClassName)
+        {}
+
+        virtual void Register(lua_State *L) override;
+        virtual int32 Invoke(lua_State *L) override;
+
+#if WITH_EDITOR
+        virtual void GenerateIntelliSense(FString &Buffer) const override;
+#endif
+    };
+
+    /**
+     * Exported member function / static member function whose target is a template argument
+     */
+    template <auto Func>
+    struct TDispatchedMemberFunction : public TDispatchedFunction<Func>
+    {
+        typedef TDispatchedFunction<Func> Super;
+
+        TDispatchedMemberFunction(const FString &InName, const FString &InClassName)
+            : Super(InName, InClassName)
+        {}
+
+        virtual void Register(lua_State *L) override;
+
+#if WITH_EDITOR
+        virtual void GenerateIntelliSense(FString &Buffer) const override;
+#endif
+    };
+
+    /**
+     * Helper to turn a member / static function of ClassType into a constant function pointer. Overloaded functions
+     * can't be deduced here, export them with the '_EX' macros instead.
+     */
+    template <typename ClassType>
+    struct TFunctionResolver
+    {
+        template <typename RetType, typename... ArgType>
+        static constexpr auto Member(RetType(ClassType::*Func)(ArgType...)) { return Func; }
+
+        template <typename RetType, typename... ArgType>
+        static constexpr auto Member(RetType(ClassType::*Func)(ArgType...) const) { return Func; }
+
+        template <typename RetType, typename... ArgType>
+        static constexpr auto Member(RetType(ClassType::*Func)(ArgType...) noexcept) { return Func; }
+
+        template <typename RetType, typename... ArgType>
+        static constexpr auto Member(RetType(ClassType::*Func)(ArgType...) const noexcept) { return Func; }
+
+        template <typename RetType, typename... ArgType>
+        static constexpr auto Static(RetType(*Func)(ArgType...)) { return Func; }
+
+        template <typename RetType, typename... ArgType>
+        static constexpr auto Static(RetType(*Func)(ArgType...) noexcept) { return Func; }
+    };
+#endif
+
 
     /**
      * Exported property
@@ -375,6 +471,9 @@ namespace UnLua
         template <typename RetType, typename... ArgType> void AddFunction(const FString &InName, RetType(ClassType::*InFunc)(ArgType...));
         template <typename RetType, typename... ArgType> void AddFunction(const FString &InName, RetType(ClassType::*InFunc)(ArgType...) const);
         template <typename RetType, typename... ArgType> void AddStaticFunction(const FString &InName, RetType(*InFunc)(ArgType...));
+#if UNLUA_WITH_STATIC_DISPATCH
+        template <auto Func> void AddDispatchedFunction(const FString &InName);
+#endif
 
         template <ESPMode Mode, typename... ArgType> void AddSharedPtrConstructor();
         template <ESPMode Mode, typename... ArgType> void AddSharedRefConstructor();
@@ -406,9 +505,9 @@ namespace UnLua
         {}
 
         virtual void Register(lua_State *L) override;
+        virtual FString GetName() const override { return Name; }
 
 #if WITH_EDITOR
-        virtual FString GetName() const override { return Name; }
         virtual void GenerateIntelliSense(FString &Buffer) const override;
 #endif
 
@@ -514,18 +613,40 @@ UnLua::AddType(#Name, UnLua::GetTypeInterface<Type>()); \
                 check(bSuccess); \
             }
 
+#if UNLUA_WITH_STATIC_DISPATCH
+#define ADD_FUNCTION(Function) \
+            Class->AddDispatchedFunction<UnLua::TFunctionResolver<ClassType>::Member(&ClassType::Function)>(#Function);
+
+#define ADD_NAMED_FUNCTION(Name, Function) \
+            Class->AddDispatchedFunction<UnLua::TFunctionResolver<ClassType>::Member(&ClassType::Function)>(Name);
+#else
 #define ADD_FUNCTION(Function) \
             Class->AddFunction(#Function, &ClassType::Function);
 
 #define ADD_NAMED_FUNCTION(Name, Function) \
             Class->AddFunction(Name, &ClassType::Function);
+#endif
 
+// the '_EX' variants of member functions may rely on reinterpreting casts, so they are always invoked through TFunction
 #define ADD_FUNCTION_EX(Name, RetType, Function, ...) \
             Class->AddFunction<RetType, ##__VA_ARGS__>(Name, (RetType(ClassType::*)(__VA_ARGS__))(&ClassType::Function));
 
 #define ADD_CONST_FUNCTION_EX(Name, RetType, Function, ...) \
             Class->AddFunction<RetType, ##__VA_ARGS__>(Name, (RetType(ClassType::*)(__VA_ARGS__) const)(&ClassType::Function));
 
+#if UNLUA_WITH_STATIC_DISPATCH
+#define ADD_STATIC_FUNCTION(Function) \
+            Class->AddDispatchedFunction<UnLua::TFunctionResolver<ClassType>::Static(&ClassType::Function)>(#Function);
+
+#define ADD_STATIC_FUNCTION_EX(Name, RetType, Function, ...) \
+            Class->AddDispatchedFunction<static_cast<RetType(*)(__VA_ARGS__)>(&ClassType::Function)>(Name);
+
+#define ADD_EXTERNAL_FUNCTION(RetType, Function, ...) \
+            Class->AddDispatchedFunction<static_cast<RetType(*)(__VA_ARGS__)>(Function)>(#Function);
+
+#define ADD_EXTERNAL_FUNCTION_EX(Name, RetType, Function, ...) \
+            Class->AddDispatchedFunction<static_cast<RetType(*)(__VA_ARGS__)>(Function)>(Name);
+#else
 #define ADD_STATIC_FUNCTION(Function) \
             Class->AddStaticFunction(#Function, &ClassType::Function);
 
@@ -537,6 +658,7 @@ UnLua::AddType(#Name, UnLua::GetTypeInterface<Type>()); \
 
 #define ADD_EXTERNAL_FUNCTION_EX(Name, RetType, Function, ...) \
             Class->AddStaticFunction<RetType, ##__VA_ARGS__>(Name, Function);
+#endif
 
 #define ADD_STATIC_CFUNTION(Function) \
             Class->AddStaticCFunction(#Function, &ClassType::Function);
@@ -566,6 +688,27 @@ UnLua::AddType(#Name, UnLua::GetTypeInterface<Type>()); \
 /**
  * Export a global function
  */
+#if UNLUA_WITH_STATIC_DISPATCH
+#define EXPORT_FUNCTION(RetType, Function, ...) \
+    static struct FExportedFunc##Function : public UnLua::TDispatchedFunction<static_cast<RetType(*)(__VA_ARGS__)>(Function)> \
+    { \
+        FExportedFunc##Function(const FString &InName) \
+            : UnLua::TDispatchedFunction<static_cast<RetType(*)(__VA_ARGS__)>(Function)>(InName) \
+        { \
+            UnLua::ExportFunction(this); \
+        } \
+    } Exported##Function(#Function);
+
+#define EXPORT_FUNCTION_EX(Name, RetType, Function, ...) \
+    static struct FExportedFunc##Name : public UnLua::TDispatchedFunction<static_cast<RetType(*)(__VA_ARGS__)>(Function)> \
+    { \
+        FExportedFunc##Name(const FString &InName) \
+            : UnLua::TDispatchedFunction<static_cast<RetType(*)(__VA_ARGS__)>(Function)>(InName) \
+        { \
+            UnLua::ExportFunction(this); \
+        } \
+    } Exported##Name(#Name);
+#else
 #define EXPORT_FUNCTION(RetType, Function, ...) \
     static struct FExportedFunc##Function : public UnLua::TExportedFunction<RetType, ##__VA_ARGS__> \
     { \
@@ -585,6 +728,7 @@ UnLua::AddType(#Name, UnLua::GetTypeInterface<Type>()); \
             UnLua::ExportFunction(this); \
         } \
     } Exported##Name(#Name, Function);
+#endif
 
 /**
  * Export an enum
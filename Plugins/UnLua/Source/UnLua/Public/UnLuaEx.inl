@@ -367,18 +367,18 @@ namespace UnLua
             return 0;
         }
 
-        TTuple<typename TArgTypeTraits<ArgType>::Type...> Args = GetArgs<typename TArgTypeTraits<ArgType>::Type...>(L, typename TOneBasedIndices<Expected>::Type(), 1);
-        Construct(L, Args, typename TZeroBasedIndices<Expected>::Type());
+        Construct(L, typename TOneBasedIndices<Expected>::Type());
         return 1;
     }
 
     template <typename ClassType, typename... ArgType>
-    template <uint32... N> void TConstructor<ClassType, ArgType...>::Construct(lua_State *L, TTuple<typename TArgTypeTraits<ArgType>::Type...> &Args, TIndices<N...>)
+    template <uint32... N> void TConstructor<ClassType, ArgType...>::Construct(lua_State *L, TIndices<N...>)
     {
+        // arguments are read straight from the stack, the class table is at index 1
         void *Userdata = UnLua::NewUserdata(L, sizeof(ClassType), TCHAR_TO_UTF8(*ClassName), alignof(ClassType));
         if (Userdata)
         {
-            new(Userdata) ClassType(Args.template Get<N>()...);
+            new(Userdata) ClassType(UnLua::Get(L, N + 1, TType<typename TArgTypeTraits<ArgType>::Type>())...);
         }
     }
 
@@ -634,6 +634,267 @@ namespace UnLua
     }
 #endif
 
+#if UNLUA_WITH_STATIC_DISPATCH
+    /**
+     * Traits class which tests if a parameter is an out parameter (non-const reference to primitive type or pointer)
+     */
+    template <typename T>
+    struct TIsOutParam
+    {
+        enum { Value = TIsReferenceType<T>::Value && !TIsConstType<typename TRemoveReference<T>::Type>::Value && TIsPrimitiveTypeOrPointer<typename TRemoveReference<T>::Type>::Value };
+    };
+
+    /**
+     * Call the target and push results, 'NumArgs' is the number of arguments on Lua stack (including 'this')
+     */
+    template <typename RetType, bool IsClass = TIsClass<RetType>::Value>
+    struct TDispatchingHelper
+    {
+        template <typename CallType, typename OutParamsType>
+        static FORCEINLINE_DEBUGGABLE int32 Dispatch(lua_State *L, int32 NumArgs, CallType &&Call, OutParamsType &&PushOutParams)
+        {
+            RetType RetVal = Call();
+#if UNLUA_LEGACY_RETURN_ORDER
+            int32 Num = PushOutParams();
+#endif
+            UnLua::Push(L, Forward<RetType>(RetVal), true);
+#if !UNLUA_LEGACY_RETURN_ORDER
+            int32 Num = PushOutParams();
+#endif
+            return Num + 1;
+        }
+    };
+
+    template <typename RetType>
+    struct TDispatchingHelper<RetType, true>
+    {
+        template <typename CallType, typename OutParamsType>
+        static FORCEINLINE_DEBUGGABLE int32 Dispatch(lua_State *L, int32 NumArgs, CallType &&Call, OutParamsType &&PushOutParams)
+        {
+            // an extra argument is the userdata to store the return value
+            int32 Num = 0;
+            std::remove_cv_t<RetType> *RetValPtr = lua_gettop(L) > NumArgs ? UnLua::Get(L, NumArgs + 1, TType<std::remove_cv_t<RetType>*>()) : nullptr;
+            if (RetValPtr)
+            {
+                *RetValPtr = Call();
+                Num = PushOutParams();
+                lua_pushvalue(L, NumArgs + 1);
+            }
+            else
+            {
+                RetType RetVal = Call();
+#if UNLUA_LEGACY_RETURN_ORDER
+                Num = PushOutParams();
+#endif
+                UnLua::Push(L, Forward<typename std::add_lvalue_reference<RetType>::type>(RetVal), true);
+#if !UNLUA_LEGACY_RETURN_ORDER
+                Num = PushOutParams();
+#endif
+            }
+            return Num + 1;
+        }
+    };
+
+    template <>
+    struct TDispatchingHelper<void, false>
+    {
+        template <typename CallType, typename OutParamsType>
+        static FORCEINLINE_DEBUGGABLE int32 Dispatch(lua_State *L, int32 NumArgs, CallType &&Call, OutParamsType &&PushOutParams)
+        {
+            Call();
+            return PushOutParams();
+        }
+    };
+
+    /**
+     * Compile-time dispatcher for a function pointer / member function pointer
+     */
+    template <auto Func, typename FuncType = decltype(Func)>
+    struct TFunctionDispatcher;
+
+    template <auto Func, typename RetType, typename... ArgType>
+    struct TFunctionDispatcher<Func, RetType(*)(ArgType...)>
+    {
+        static constexpr int32 NumArgs = sizeof...(ArgType);
+        static constexpr bool bHasOutParams = (false || ... || TIsOutParam<ArgType>::Value);
+
+        static int32 Dispatch(lua_State *L)
+        {
+            const int32 Actual = lua_gettop(L);
+            if (Actual < NumArgs)
+                return FDispatchedFunctionBase::ReportInvalidArguments(L, NumArgs, Actual);
+            return Call(L, typename TOneBasedIndices<NumArgs>::Type());
+        }
+
+#if WITH_EDITOR
+        static void GenerateArgsIntelliSense(FString &Buffer, FString &ArgList) { UnLua::GenerateArgsIntelliSense<RetType, ArgType...>(Buffer, ArgList); }
+#endif
+
+    private:
+        template <uint32... N>
+        static FORCEINLINE_DEBUGGABLE int32 Call(lua_State *L, TIndices<N...>)
+        {
+            if constexpr (bHasOutParams)
+            {
+                TTuple<typename TArgTypeTraits<ArgType>::Type...> Args(UnLua::Get(L, N, TType<typename TArgTypeTraits<ArgType>::Type>())...);
+                return TDispatchingHelper<RetType>::Dispatch(L, NumArgs,
+                    [&]() -> RetType { return (*Func)(Forward<ArgType>(Args.template Get<N - 1>())...); },
+                    [&]() -> int32 { return PushNonConstRefParam(L, Forward<ArgType>(Args.template Get<N - 1>())...); });
+            }
+            else
+            {
+                return TDispatchingHelper<RetType>::Dispatch(L, NumArgs,
+                    [L]() -> RetType { return (*Func)(UnLua::Get(L, N, TType<typename TArgTypeTraits<ArgType>::Type>())...); },
+                    []() -> int32 { return 0; });
+            }
+        }
+    };
+
+    template <auto Func, typename ClassType, typename RetType, typename... ArgType>
+    struct TMemberFunctionDispatcher
+    {
+        static constexpr int32 NumArgs = sizeof...(ArgType) + 1;
+        static constexpr bool bHasOutParams = (false || ... || TIsOutParam<ArgType>::Value);
+
+        static int32 Dispatch(lua_State *L)
+        {
+            const int32 Actual = lua_gettop(L);
+            if (Actual < NumArgs)
+                return FDispatchedFunctionBase::ReportInvalidArguments(L, NumArgs, Actual);
+            ClassType *Self = UnLua::Get(L, 1, TType<ClassType*>());
+            if (!Self)
+                return FDispatchedFunctionBase::ReportInvalidSelf(L);
+            return Call(L, Self, typename TOneBasedIndices<sizeof...(ArgType)>::Type());
+        }
+
+#if WITH_EDITOR
+        static void GenerateArgsIntelliSense(FString &Buffer, FString &ArgList) { UnLua::GenerateArgsIntelliSense<RetType, ArgType...>(Buffer, ArgList); }
+#endif
+
+    private:
+        template <uint32... N>
+        static FORCEINLINE_DEBUGGABLE int32 Call(lua_State *L, ClassType *Self, TIndices<N...>)
+        {
+            // arguments start at index 2, 'this' is at index 1
+            if constexpr (bHasOutParams)
+            {
+                TTuple<typename TArgTypeTraits<ArgType>::Type...> Args(UnLua::Get(L, N + 1, TType<typename TArgTypeTraits<ArgType>::Type>())...);
+                return TDispatchingHelper<RetType>::Dispatch(L, NumArgs,
+                    [&]() -> RetType { return (Self->*Func)(Forward<ArgType>(Args.template Get<N - 1>())...); },
+                    [&]() -> int32 { return PushNonConstRefParam(L, Forward<ArgType>(Args.template Get<N - 1>())...); });
+            }
+            else
+            {
+                return TDispatchingHelper<RetType>::Dispatch(L, NumArgs,
+                    [L, Self]() -> RetType { return (Self->*Func)(UnLua::Get(L, N + 1, TType<typename TArgTypeTraits<ArgType>::Type>())...); },
+                    []() -> int32 { return 0; });
+            }
+        }
+    };
+
+    template <auto Func, typename ClassType, typename RetType, typename... ArgType>
+    struct TFunctionDispatcher<Func, RetType(ClassType::*)(ArgType...)> : public TMemberFunctionDispatcher<Func, ClassType, RetType, ArgType...> {};
+
+    template <auto Func, typename ClassType, typename RetType, typename... ArgType>
+    struct TFunctionDispatcher<Func, RetType(ClassType::*)(ArgType...) const> : public TMemberFunctionDispatcher<Func, ClassType, RetType, ArgType...> {};
+
+    // noexcept is part of the function type since C++17
+    template <auto Func, typename RetType, typename... ArgType>
+    struct TFunctionDispatcher<Func, RetType(*)(ArgType...) noexcept> : public TFunctionDispatcher<Func, RetType(*)(ArgType...)> {};
+
+    template <auto Func, typename ClassType, typename RetType, typename... ArgType>
+    struct TFunctionDispatcher<Func, RetType(ClassType::*)(ArgType...) noexcept> : public TMemberFunctionDispatcher<Func, ClassType, RetType, ArgType...> {};
+
+    template <auto Func, typename ClassType, typename RetType, typename... ArgType>
+    struct TFunctionDispatcher<Func, RetType(ClassType::*)(ArgType...) const noexcept> : public TMemberFunctionDispatcher<Func, ClassType, RetType, ArgType...> {};
+
+
+    /**
+     * Exported function dispatched at compile time
+     */
+    inline int32 FDispatchedFunctionBase::ReportInvalidArguments(lua_State *L, int32 Expected, int32 Actual)
+    {
+        const FDispatchedFunctionBase *Function = (const FDispatchedFunctionBase*)lua_touserdata(L, lua_upvalueindex(1));
+        if (!Function)
+            return 0;
+
+        if (Function->ClassName.IsEmpty())
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("Attempted to call %s with invalid arguments. %d expected but got %d."), *Function->Name, Expected, Actual);
+        }
+        else
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("Attempted to call %s::%s with invalid arguments. %d expected but got %d."), *Function->ClassName, *Function->Name, Expected, Actual);
+        }
+        return 0;
+    }
+
+    inline int32 FDispatchedFunctionBase::ReportInvalidSelf(lua_State *L)
+    {
+        const FDispatchedFunctionBase *Function = (const FDispatchedFunctionBase*)lua_touserdata(L, lua_upvalueindex(1));
+        if (Function)
+            UE_LOG(LogUnLua, Error, TEXT("Attempted to call %s::%s with nullptr of 'this'."), *Function->ClassName, *Function->Name);
+        return 0;
+    }
+
+    inline void FDispatchedFunctionBase::RegisterClosure(lua_State *L, lua_CFunction Func)
+    {
+        // 'this' is only used to report errors
+        lua_pushlightuserdata(L, this);
+        lua_pushcclosure(L, Func, 1);
+    }
+
+    template <auto Func>
+    void TDispatchedFunction<Func>::Register(lua_State *L)
+    {
+        RegisterClosure(L, &TFunctionDispatcher<Func>::Dispatch);
+        lua_setglobal(L, TCHAR_TO_UTF8(*Name));
+    }
+
+    template <auto Func>
+    int32 TDispatchedFunction<Func>::Invoke(lua_State *L)
+    {
+        return TFunctionDispatcher<Func>::Dispatch(L);
+    }
+
+#if WITH_EDITOR
+    template <auto Func>
+    void TDispatchedFunction<Func>::GenerateIntelliSense(FString &Buffer) const
+    {
+        // arguments
+        FString ArgList;
+        TFunctionDispatcher<Func>::GenerateArgsIntelliSense(Buffer, ArgList);
+        // function definition
+        Buffer += FString::Printf(TEXT("function _G.%s(%s) end\r\n\r\n"), *Name, *ArgList);
+    }
+#endif
+
+    template <auto Func>
+    void TDispatchedMemberFunction<Func>::Register(lua_State *L)
+    {
+        // make sure the meta table is on the top of the stack
+        lua_pushstring(L, TCHAR_TO_UTF8(*Super::Name));
+        Super::RegisterClosure(L, &TFunctionDispatcher<Func>::Dispatch);
+        lua_rawset(L, -3);
+    }
+
+#if WITH_EDITOR
+    template <auto Func>
+    void TDispatchedMemberFunction<Func>::GenerateIntelliSense(FString &Buffer) const
+    {
+        constexpr bool bIsStatic = !std::is_member_function_pointer_v<decltype(Func)>;
+        if (bIsStatic)
+            Buffer += FString::Printf(TEXT("\r\n\r\n"));
+
+        // arguments
+        FString ArgList;
+        TFunctionDispatcher<Func>::GenerateArgsIntelliSense(Buffer, ArgList);
+        // function definition
+        Buffer += FString::Printf(TEXT("function %s%s%s(%s) end\r\n"), *Super::ClassName, bIsStatic ? TEXT(".") : TEXT(":"), *Super::Name, *ArgList);
+    }
+#endif
+#endif
+
 
     /**
      * Exported property
@@ -1006,6 +1267,14 @@ namespace UnLua
         FExportedClassBase::Functions.Add(new TExportedStaticMemberFunction<RetType, ArgType...>(InName, InFunc, FExportedClassBase::Name));
     }
 
+#if UNLUA_WITH_STATIC_DISPATCH
+    template <bool bIsReflected, typename ClassType, typename... CtorArgType>
+    template <auto Func> void TExportedClass<bIsReflected, ClassType, CtorArgType...>::AddDispatchedFunction(const FString &InName)
+    {
+        FExportedClassBase::Functions.Add(new TDispatchedMemberFunction<Func>(InName, FExportedClassBase::Name));
+    }
+#endif
+
     template <bool bIsReflected, typename ClassType, typename... CtorArgType>
     template <ESPMode Mode, typename... ArgType> void TExportedClass<bIsReflected, ClassType, CtorArgType...>::AddSharedPtrConstructor()
     {
@@ -32,4 +32,12 @@ public:
 
     UFUNCTION(BlueprintCallable)
     static void HotReload();
+
+    /**
+     * Create the Lua overrides of the classes in the override manifest, to be called on a loading screen so the first
+     * spawn of each class does not hitch. Only cooked builds with 'bUseOverrideManifest' have a manifest.
+     * @return number of classes overridden
+     */
+    UFUNCTION(BlueprintCallable)
+    static int32 PrebindOverrides(bool bLoadClasses);
 };
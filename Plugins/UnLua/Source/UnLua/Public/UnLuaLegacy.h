@@ -810,6 +810,88 @@ namespace UnLua
         return CallFunctionInternal(L, Forward<T>(Args)...);
     }
 
+    /**
+     * Strings read from the stack point into Lua memory, they may be collected once the results are popped
+     */
+    template <typename T>
+    struct TIsLuaStringPointer
+    {
+        static constexpr bool Value = std::is_pointer_v<T> && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<T>>, char>;
+    };
+
+    /**
+     * Read typed results of a Lua function call
+     */
+    template <typename T>
+    struct TLuaResults
+    {
+        static_assert(!TIsLuaStringPointer<T>::Value, "results are popped from the stack, return strings as FString.");
+
+        static constexpr int32 Num = 1;
+
+        static FORCEINLINE T Read(lua_State* L, int32 Index)
+        {
+            return UnLua::Get(L, Index, TType<T>());
+        }
+    };
+
+    template <>
+    struct TLuaResults<void>
+    {
+        static constexpr int32 Num = 0;
+    };
+
+    template <typename... T>
+    struct TLuaResults<TTuple<T...>>
+    {
+        static_assert(!(TIsLuaStringPointer<T>::Value || ...), "results are popped from the stack, return strings as FString.");
+
+        static constexpr int32 Num = sizeof...(T);
+
+        static FORCEINLINE TTuple<T...> Read(lua_State* L, int32 Index)
+        {
+            return Read(L, Index, typename TZeroBasedIndices<sizeof...(T)>::Type());
+        }
+
+        template <uint32... N>
+        static FORCEINLINE TTuple<T...> Read(lua_State* L, int32 Index, TIndices<N...>)
+        {
+            return TTuple<T...>(UnLua::Get(L, Index + N, TType<T>())...);
+        }
+    };
+
+    /**
+     * Call function with typed results
+     */
+    template <typename RetType, typename... T>
+    RetType FLuaFunctionHandle::Invoke(T&&... Args)
+    {
+        static_assert(!TIsReferenceType<RetType>::Value, "results are popped from the stack, return them by value.");
+
+        if (!IsValid())
+            return RetType();
+
+        const int32 Top = lua_gettop(L);
+        PushFunction();
+        const int32 NumArgs = PushArgs<false>(L, Forward<T>(Args)...);
+        if (lua_pcall(L, NumArgs, TLuaResults<RetType>::Num, Top + 1) != LUA_OK)
+        {
+            lua_settop(L, Top);
+            return RetType();
+        }
+
+        if constexpr (std::is_void_v<RetType>)
+        {
+            lua_settop(L, Top);
+        }
+        else
+        {
+            RetType Ret = TLuaResults<RetType>::Read(L, Top + 2);
+            lua_settop(L, Top);
+            return Ret;
+        }
+    }
+
 
     /**
      * true/false type
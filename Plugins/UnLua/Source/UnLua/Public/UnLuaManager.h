@@ -15,6 +15,7 @@
 #pragma once
 
 #include "InputCoreTypes.h"
+#include "Engine/EngineBaseTypes.h"
 #include "Engine/DynamicBlueprintBinding.h"
 #include "lua.hpp"
 #include "UnLuaCompatibility.h"
@@ -23,6 +24,7 @@
 namespace UnLua
 {
     class FLuaEnv;
+    class FLuaTickManager;
 }
 
 UCLASS()
@@ -38,12 +40,18 @@ public:
 
     bool Bind(UObject *Object, const TCHAR *InModuleName, int32 InitializerTableRef = LUA_NOREF);
 
+    /* 为已绑定模块的UObject创建Lua实例并调用Initialize */
+    bool BindInstance(UObject *Object, int32 InitializerTableRef = LUA_NOREF);
+
     void NotifyUObjectDeleted(const UObjectBase *Object);
 
     void Cleanup();
 
     int GetBoundRef(const UClass* Class);
 
+    /* 类绑定的Lua模块名，未绑定时为空 */
+    FString GetBoundModuleName(const UClass* Class) const;
+
     void GetDefaultInputs();
 
     void CleanupDefaultInputs();
@@ -95,13 +103,32 @@ private:
     /* 将一个UClass绑定到Lua模块，根据这个模块定义的函数列表来覆盖上面的UFunction */
     bool BindClass(UClass *Class, const FString &InModuleName, FString &Error);
 
-    void ReplaceActionInputs(AActor *Actor, UInputComponent *InputComponent, TSet<FName> &LuaFunctions);
-    void ReplaceKeyInputs(AActor *Actor, UInputComponent *InputComponent, TSet<FName> &LuaFunctions);
-    void ReplaceAxisInputs(AActor *Actor, UInputComponent *InputComponent, TSet<FName> &LuaFunctions);
-    void ReplaceTouchInputs(AActor *Actor, UInputComponent *InputComponent, TSet<FName> &LuaFunctions);
-    void ReplaceAxisKeyInputs(AActor *Actor, UInputComponent *InputComponent, TSet<FName> &LuaFunctions);
-    void ReplaceVectorAxisInputs(AActor *Actor, UInputComponent *InputComponent, TSet<FName> &LuaFunctions);
-    void ReplaceGestureInputs(AActor *Actor, UInputComponent *InputComponent, TSet<FName> &LuaFunctions);
+    /* "<Action/Key/Touch>_<InputEvent>"形式的Lua函数名，按输入事件索引 */
+    struct FInputEventFunctions
+    {
+        FName Functions[IE_MAX];
+    };
+
+    struct FDefaultInputBinding
+    {
+        FKey Key;
+        FName Name;
+        FName FuncName;
+        EInputEvent InputEvent;
+    };
+
+    /* 输入替换方案，只依赖类和它绑定的Lua模块，第一次替换输入时生成，之后替换时不再拼接字符串 */
+    struct FInputBindingPlan
+    {
+        bool bValid = false;
+        uint32 Generation = 0;
+        TMap<FName, FInputEventFunctions> EventFunctions;
+        FInputEventFunctions TouchFunctions;
+        TArray<FDefaultInputBinding> DefaultActions;
+        TArray<FDefaultInputBinding> DefaultKeys;
+        TArray<FName> DefaultAxes;
+        TSet<FName> Overridden;
+    };
 
     struct FClassBindInfo
     {
@@ -110,10 +137,26 @@ private:
         int TableRef;
         TSet<FName> LuaFunctions;
         TMap<FName, UFunction*> UEFunctions;
+        bool bBatchedTick = false;
+        FInputBindingPlan InputPlan;
     };
 
+    FInputBindingPlan& GetInputBindingPlan(FClassBindInfo &BindInfo);
+    void OverrideInput(FInputBindingPlan &Plan, UFunction *TemplateFunction, UClass *Class, FName FuncName);
+
+    void ReplaceActionInputs(AActor *Actor, UInputComponent *InputComponent, FInputBindingPlan &Plan);
+    void ReplaceKeyInputs(AActor *Actor, UInputComponent *InputComponent, FInputBindingPlan &Plan);
+    void ReplaceAxisInputs(AActor *Actor, UInputComponent *InputComponent, FInputBindingPlan &Plan, const TSet<FName> &LuaFunctions);
+    void ReplaceTouchInputs(AActor *Actor, UInputComponent *InputComponent, FInputBindingPlan &Plan);
+    void ReplaceAxisKeyInputs(AActor *Actor, UInputComponent *InputComponent, FInputBindingPlan &Plan, const TSet<FName> &LuaFunctions);
+    void ReplaceVectorAxisInputs(AActor *Actor, UInputComponent *InputComponent, FInputBindingPlan &Plan, const TSet<FName> &LuaFunctions);
+    void ReplaceGestureInputs(AActor *Actor, UInputComponent *InputComponent, FInputBindingPlan &Plan, const TSet<FName> &LuaFunctions);
+
     TMap<UClass*, FClassBindInfo> Classes;
 
+    /* 批量派发Lua的ReceiveTick，模块中定义 BatchedTick = true 时启用 */
+    UnLua::FLuaTickManager* TickManager = nullptr;
+
     TSet<FName> DefaultAxisNames;
     TSet<FName> DefaultActionNames;
     TArray<FKey> AllKeys;
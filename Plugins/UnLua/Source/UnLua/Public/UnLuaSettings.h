@@ -40,10 +40,41 @@ public:
     UPROPERTY(Config, EditAnywhere, Category="Runtime")
     bool DanglingCheck = false;
 
+    /**
+     * Create the Lua instance of a bound object on its first access from UE or Lua instead of on creation.
+     * 'Initialize' is called right before that first access. Objects created with an initializer table, CDOs and
+     * classes using batched tick are always bound on creation.
+     */
+    UPROPERTY(Config, EditAnywhere, Category="Runtime")
+    bool bDeferObjectInstances = false;
+
+    /** Number of worker lua states running jobs submitted by UnLua.SubmitJob, 0 for one per task graph worker thread. */
+    UPROPERTY(Config, EditAnywhere, Category="Runtime", Meta=(ClampMin="0"))
+    int32 MaxJobEnvs = 0;
+
+    /** Register all statically exported classes and enums when a lua env is created, instead of on their first access from UE namespace. */
+    UPROPERTY(Config, EditAnywhere, Category="Runtime")
+    bool bRegisterStaticExportsOnStartup = false;
+
+    /**
+     * Modules compiled once into a template shared by the envs created for each game instance, and required when each
+     * of them starts. Only used by LuaEnvLocator_ByGameInstance, leave it empty to create every env from scratch.
+     */
+    UPROPERTY(Config, EditAnywhere, Category="Runtime")
+    TArray<FString> WarmStartModules;
+
     /** Whether to print all Lua env stacks on crash. */
     UPROPERTY(Config, EditAnywhere, Category="Runtime")
     bool bPrintLuaStackOnSystemError = true;
 
+    /**
+     * Use the override manifest staged with the scripts in cooked builds, generated by -run=UnLuaOverrideManifest
+     * before cooking. Lua overrides of the loaded classes it lists are created in one pass on startup, and binding
+     * those classes skips looking for overridable functions. See also UUnLuaFunctionLibrary::PrebindOverrides.
+     */
+    UPROPERTY(Config, EditAnywhere, Category="Runtime")
+    bool bUseOverrideManifest = false;
+
     /** Class of LuaEnvLocator, which handles lua env locating for each UObject. */
     UPROPERTY(Config, EditAnywhere, Category="Runtime", Meta=(AllowAbstract="false"))
     TSubclassOf<ULuaEnvLocator> EnvLocatorClass = ULuaEnvLocator::StaticClass();
@@ -54,4 +85,12 @@ public:
     /** List of classes to bind on startup. */
     UPROPERTY(config, EditAnywhere, Category=Runtime, meta = (MetaClass="Object", AllowAbstract="True", DisplayName = "List of classes to bind on startup"))
     TArray<FSoftClassPath> PreBindClasses;
+
+    /** Reload modified lua modules automatically, watching the script directory for changes. Not available in shipping builds. */
+    UPROPERTY(Config, EditAnywhere, Category="HotReload")
+    bool bAutoHotReload = false;
+
+    /** Seconds to wait after the last file change before reloading automatically. */
+    UPROPERTY(Config, EditAnywhere, Category="HotReload", Meta=(ClampMin="0", EditCondition="bAutoHotReload"))
+    float AutoHotReloadDelay = 0.3f;
 };
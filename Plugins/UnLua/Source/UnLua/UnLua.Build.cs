@@ -57,6 +57,9 @@ public class UnLua : ModuleRules
             }
         );
 
+        PrivateDependencyModuleNames.Add("Json");
+        PrivateDependencyModuleNames.Add("NetCore");
+
         PublicIncludePaths.Add(Path.Combine(ModuleDirectory, "Private"));
 
         if (Target.bBuildEditor)
@@ -110,6 +113,14 @@ public class UnLua : ModuleRules
         var withHotReload = hotReloadMode != "Never";
         PublicDefinitions.Add("UNLUA_WITH_HOT_RELOAD=" + (withHotReload ? "1" : "0"));
 
+        var withFileWatcher = withHotReload && Target.bBuildDeveloperTools && Target.Configuration != UnrealTargetConfiguration.Shipping;
+        if (withFileWatcher)
+            PrivateDependencyModuleNames.Add("DirectoryWatcher");
+        PublicDefinitions.Add("UNLUA_WITH_FILE_WATCHER=" + (withFileWatcher ? "1" : "0"));
+
+        var withBoundaryRecorder = Target.Configuration != UnrealTargetConfiguration.Shipping;
+        PublicDefinitions.Add("UNLUA_WITH_BOUNDARY_RECORDER=" + (withBoundaryRecorder ? "1" : "0"));
+
         if (IsPluginEnabled("LuaCompat"))
             PublicIncludePaths.Add(Path.Combine(PluginDirectory, "Source/ThirdParty/Lua/lua-compat-5.3/c-api"));
     }
@@ -0,0 +1,1266 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#include "Commandlets/UnLuaBenchmarkCommandlet.h"
+
+#include "Dom/JsonObject.h"
+#include "EdGraphSchema_K2.h"
+#include "Engine/Blueprint.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Engine/Engine.h"
+#include "GameFramework/WorldSettings.h"
+#include "HAL/FileManager.h"
+#include "HAL/MemoryBase.h"
+#include "K2Node_CustomEvent.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Kismet2/KismetEditorUtilities.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "LuaEnv.h"
+#include "UnLua.h"
+#include "LuaOverrideManifest.h"
+#include "LuaRPCBatcher.h"
+#include "UnLuaBase.h"
+#include "UnLuaEx.h"
+#include "UnLuaModule.h"
+
+/**
+ * Vector math exported statically, both dispatched at compile time and through the TFunction of the legacy path
+ */
+struct FUnLuaBenchmarkMath
+{
+    static FVector Add(const FVector& A, const FVector& B)
+    {
+        return A + B;
+    }
+
+    static double Dot(const FVector& A, const FVector& B)
+    {
+        return FVector::DotProduct(A, B);
+    }
+};
+
+BEGIN_EXPORT_CLASS(FUnLuaBenchmarkMath)
+    ADD_STATIC_FUNCTION(Add)
+    ADD_STATIC_FUNCTION(Dot)
+    Class->AddStaticFunction("AddLegacy", &FUnLuaBenchmarkMath::Add);
+    Class->AddStaticFunction("DotLegacy", &FUnLuaBenchmarkMath::Dot);
+END_EXPORT_CLASS()
+IMPLEMENT_EXPORTED_CLASS(FUnLuaBenchmarkMath)
+
+/**
+ * Forwards to the engine allocator and counts the allocations made on the benchmark thread. Lua allocates through
+ * FMemory too, so both sides of the boundary are counted. Nothing is counted on platforms where FMemory inlines a
+ * fixed allocator class instead of calling GMalloc.
+ *
+ * Other threads keep allocating while GMalloc is swapped: they may still call the wrapper after it was swapped out,
+ * or free through it what they allocated before, so it forwards everything and is never destroyed.
+ */
+class FUnLuaBenchmarkMalloc final : public FMalloc
+{
+public:
+    explicit FUnLuaBenchmarkMalloc(FMalloc* InInner)
+        : Inner(InInner), ThreadId(FPlatformTLS::GetCurrentThreadId())
+    {
+    }
+
+    void Reset()
+    {
+        NumAllocs = 0;
+    }
+
+    uint64 GetNumAllocs() const
+    {
+        return NumAllocs;
+    }
+
+    virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+    {
+        OnAlloc();
+        return Inner->Malloc(Count, Alignment);
+    }
+
+    virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+    {
+        OnAlloc();
+        return Inner->TryMalloc(Count, Alignment);
+    }
+
+    virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+    {
+        if (Count > 0)
+            OnAlloc();
+        return Inner->Realloc(Original, Count, Alignment);
+    }
+
+    virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+    {
+        if (Count > 0)
+            OnAlloc();
+        return Inner->TryRealloc(Original, Count, Alignment);
+    }
+
+    virtual void Free(void* Original) override
+    {
+        Inner->Free(Original);
+    }
+
+    virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+    {
+        return Inner->QuantizeSize(Count, Alignment);
+    }
+
+    virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+    {
+        return Inner->GetAllocationSize(Original, SizeOut);
+    }
+
+    virtual void Trim(bool bTrimThreadCaches) override
+    {
+        Inner->Trim(bTrimThreadCaches);
+    }
+
+    virtual void SetupTLSCachesOnCurrentThread() override
+    {
+        Inner->SetupTLSCachesOnCurrentThread();
+    }
+
+    virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+    {
+        Inner->ClearAndDisableTLSCachesOnCurrentThread();
+    }
+
+    virtual void InitializeStatsMetadata() override
+    {
+        Inner->InitializeStatsMetadata();
+    }
+
+    virtual void UpdateStats() override
+    {
+        Inner->UpdateStats();
+    }
+
+    virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override
+    {
+        Inner->GetAllocatorStats(OutStats);
+    }
+
+    virtual void DumpAllocatorStats(FOutputDevice& Ar) override
+    {
+        Inner->DumpAllocatorStats(Ar);
+    }
+
+    virtual bool IsInternallyThreadSafe() const override
+    {
+        return Inner->IsInternallyThreadSafe();
+    }
+
+    virtual bool ValidateHeap() override
+    {
+        return Inner->ValidateHeap();
+    }
+
+    virtual const TCHAR* GetDescriptiveName() override
+    {
+        return Inner->GetDescriptiveName();
+    }
+
+private:
+    FORCEINLINE void OnAlloc()
+    {
+        if (FPlatformTLS::GetCurrentThreadId() == ThreadId)
+            ++NumAllocs;
+    }
+
+    FMalloc* Inner;
+    uint32 ThreadId;
+    uint64 NumAllocs = 0;
+};
+
+struct FUnLuaBenchmark
+{
+    FString Name;
+    /** Run about Count operations, @return the number of operations run or -1 on failure */
+    TFunction<int64(int32)> Run;
+};
+
+struct FUnLuaBenchmarkResult
+{
+    FString Name;
+    double NsPerOp = 0;
+    double AllocsPerOp = 0;
+};
+
+struct FUnLuaThroughputResult
+{
+    FString Name;
+    double Seconds = 0;
+    double MBPerSecond = 0;
+};
+
+struct FUnLuaFrameResult
+{
+    FString Name;
+    int32 NumActors = 0;
+    double MsPerFrame = 0;
+};
+
+struct FUnLuaHitchResult
+{
+    FString Name;
+    double MeanMs = 0;
+    double MaxMs = 0;
+    double AllocsPerClass = 0;
+};
+
+/**
+ * Full collections with live proxies pushed by Push, kept alive by a Lua table. Returns the median pause per proxy,
+ * relative to the same collections without the proxies.
+ */
+static double MeasureGCPause(lua_State* L, int32 NumProxies, int32 Repeats, const TFunctionRef<void(int32)>& Push)
+{
+    const auto Collect = [L, Repeats]()
+    {
+        TArray<double> Times;
+        for (int32 i = 0; i < Repeats; ++i)
+        {
+            const double StartTime = FPlatformTime::Seconds();
+            lua_gc(L, LUA_GCCOLLECT, 0);
+            Times.Add(FPlatformTime::Seconds() - StartTime);
+        }
+        Times.Sort();
+        return Times[Repeats / 2];
+    };
+
+    lua_gc(L, LUA_GCCOLLECT, 0);
+    const double EmptyTime = Collect();
+
+    lua_createtable(L, NumProxies, 0);
+    for (int32 i = 0; i < NumProxies; ++i)
+    {
+        Push(i);
+        lua_rawseti(L, -2, i + 1);
+    }
+    const double Time = Collect();
+    lua_pop(L, 1);
+    lua_gc(L, LUA_GCCOLLECT, 0);
+
+    return FMath::Max(Time - EmptyTime, 0.0) * 1e9 / NumProxies;
+}
+
+/** Distinct bound classes spawned to measure the hitches */
+static constexpr int32 NumSpawnClasses = 50;
+
+/** Blueprint subclasses of the benchmark object, bound to its module and never spawned yet */
+static TArray<UClass*> CreateBenchmarkClasses(const TCHAR* Prefix, int32 Count)
+{
+    TArray<UClass*> Classes;
+    for (int32 i = 0; i < Count; ++i)
+    {
+        const auto Name = FString::Printf(TEXT("%s%d"), Prefix, i);
+        const auto Package = CreatePackage(*(FString(TEXT("/Temp/UnLuaBenchmark/")) + Name));
+        const auto Blueprint = FKismetEditorUtilities::CreateBlueprint(UUnLuaBenchmarkObject::StaticClass(), Package, *Name, BPTYPE_Normal,
+                                                                       UBlueprint::StaticClass(), UBlueprintGeneratedClass::StaticClass());
+        Blueprint->AddToRoot();
+        Classes.Add(Blueprint->GeneratedClass);
+    }
+    return Classes;
+}
+
+/** Spawn one object of each class, each the first of its class so the class is bound on the spot */
+static FUnLuaHitchResult MeasureFirstSpawn(const FString& Name, const TArray<UClass*>& Classes, FUnLuaBenchmarkMalloc& CountingMalloc)
+{
+    FUnLuaHitchResult Result;
+    Result.Name = Name;
+    CountingMalloc.Reset();
+    for (const auto Class : Classes)
+    {
+        const double StartTime = FPlatformTime::Seconds();
+        NewObject<UObject>(GetTransientPackage(), Class)->AddToRoot();
+        const double Ms = (FPlatformTime::Seconds() - StartTime) * 1000;
+        Result.MeanMs += Ms / Classes.Num();
+        Result.MaxMs = FMath::Max(Result.MaxMs, Ms);
+    }
+    Result.AllocsPerClass = (double)CountingMalloc.GetNumAllocs() / Classes.Num();
+    return Result;
+}
+
+/** A game world that has begun play, without a game mode */
+static UWorld* CreateBenchmarkWorld()
+{
+    UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("UnLuaBenchmarkWorld"));
+    FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+    WorldContext.SetCurrentWorld(World);
+    World->InitializeActorsForPlay(FURL());
+    World->GetWorldSettings()->NotifyBeginPlay();
+    return World;
+}
+
+static void DestroyBenchmarkWorld(UWorld* World)
+{
+    World->BeginTearingDown();
+    GEngine->DestroyWorldContext(World);
+    World->DestroyWorld(false);
+}
+
+/** Spawn the actors and tick the world, @return median time of a frame */
+static FUnLuaFrameResult MeasureTickFrames(const FString& Name, UWorld* World, UClass* Class, int32 NumActors, int32 NumFrames)
+{
+    constexpr float DeltaSeconds = 1.0f / 60;
+    TArray<AActor*> Actors;
+    for (int32 i = 0; i < NumActors; ++i)
+        Actors.Add(World->SpawnActor(Class));
+
+    // the first frames start the batches
+    for (int32 i = 0; i < 10; ++i)
+        World->Tick(LEVELTICK_All, DeltaSeconds);
+
+    TArray<double> Times;
+    for (int32 i = 0; i < NumFrames; ++i)
+    {
+        const double StartTime = FPlatformTime::Seconds();
+        World->Tick(LEVELTICK_All, DeltaSeconds);
+        Times.Add((FPlatformTime::Seconds() - StartTime) * 1000);
+    }
+
+    for (const auto Actor : Actors)
+    {
+        if (Actor)
+            Actor->Destroy();
+    }
+    World->Tick(LEVELTICK_All, DeltaSeconds);
+
+    Times.Sort();
+    FUnLuaFrameResult Result;
+    Result.Name = Name;
+    Result.NumActors = NumActors;
+    Result.MsPerFrame = Times[NumFrames / 2];
+    return Result;
+}
+
+/** Call the method of the Lua instance bound to the object with an iteration count */
+static bool CallLua(lua_State* L, UObject* Object, const char* FuncName, int32 Count)
+{
+    const auto Top = lua_gettop(L);
+    UnLua::PushUObject(L, Object);
+    lua_getfield(L, -1, FuncName);
+    if (!lua_isfunction(L, -1))
+    {
+        UE_LOG(LogUnLua, Error, TEXT("Benchmark function '%s' not found, is 'UnLua.Benchmark' bound?"), UTF8_TO_TCHAR(FuncName));
+        lua_settop(L, Top);
+        return false;
+    }
+
+    lua_insert(L, -2);
+    lua_pushinteger(L, Count);
+    const bool bSucceeded = lua_pcall(L, 2, 0, 0) == LUA_OK;
+    if (!bSucceeded)
+        UE_LOG(LogUnLua, Error, TEXT("Benchmark function '%s' failed: %s"), UTF8_TO_TCHAR(FuncName), UTF8_TO_TCHAR(lua_tostring(L, -1)));
+    lua_settop(L, Top);
+    return bSucceeded;
+}
+
+/** Write a text file of 100 byte lines */
+static bool WriteBenchmarkFile(const FString& FilePath, int32 SizeMB)
+{
+    const TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*FilePath));
+    if (!Writer)
+        return false;
+
+    TArray<ANSICHAR> Chunk;
+    Chunk.Reserve(1024 * 1024);
+    while (Chunk.Num() + 100 <= 1024 * 1024)
+    {
+        for (int32 i = 0; i < 99; ++i)
+            Chunk.Add('a' + (Chunk.Num() + i) % 26);
+        Chunk.Add('\n');
+    }
+    for (int32 i = 0; i < SizeMB; ++i)
+        Writer->Serialize(Chunk.GetData(), Chunk.Num());
+    return Writer->Close();
+}
+
+/** Read the file through UE.File with the Lua method of the object, @return number of bytes read or -1 on failure */
+static int64 ReadFileLua(lua_State* L, UObject* Object, const char* FuncName, const FString& FilePath, const char* Mode)
+{
+    const auto Top = lua_gettop(L);
+    UnLua::PushUObject(L, Object);
+    lua_getfield(L, -1, FuncName);
+    lua_insert(L, -2);
+    lua_pushstring(L, TCHAR_TO_UTF8(*FilePath));
+    lua_pushstring(L, Mode);
+    int64 Size = -1;
+    if (lua_pcall(L, 3, 1, 0) == LUA_OK)
+        Size = lua_tointeger(L, -1);
+    else
+        UE_LOG(LogUnLua, Error, TEXT("Benchmark function '%s' failed: %s"), UTF8_TO_TCHAR(FuncName), UTF8_TO_TCHAR(lua_tostring(L, -1)));
+    lua_settop(L, Top);
+    return Size;
+}
+
+/** Run the method of the Lua instance bound to the object, @return the number of operations it returned or -1 on failure */
+static int64 RunLua(lua_State* L, UObject* Object, const char* FuncName, int32 Count)
+{
+    const auto Top = lua_gettop(L);
+    UnLua::PushUObject(L, Object);
+    lua_getfield(L, -1, FuncName);
+    lua_insert(L, -2);
+    lua_pushinteger(L, Count);
+    int64 NumOps = -1;
+    if (lua_pcall(L, 2, 1, 0) == LUA_OK)
+        NumOps = lua_isinteger(L, -1) ? lua_tointeger(L, -1) : -1;
+    else
+        UE_LOG(LogUnLua, Error, TEXT("Benchmark function '%s' failed: %s"), UTF8_TO_TCHAR(FuncName), UTF8_TO_TCHAR(lua_tostring(L, -1)));
+    lua_settop(L, Top);
+    return NumOps;
+}
+
+/** Benchmarks of a baseline by kind */
+struct FUnLuaBenchmarkBaseline
+{
+    TMap<FString, FUnLuaBenchmarkResult> Results;
+    TMap<FString, FUnLuaHitchResult> Hitches;
+    TMap<FString, FUnLuaThroughputResult> Throughputs;
+    TMap<FString, FUnLuaFrameResult> Frames;
+};
+
+/** State shared by the benchmark groups */
+struct FUnLuaBenchmarkContext
+{
+    UnLua::FLuaEnv* Env = nullptr;
+    lua_State* L = nullptr;
+    UUnLuaBenchmarkObject* Object = nullptr;
+    FUnLuaBenchmarkMalloc* CountingMalloc = nullptr;
+    FString Filter;
+    int32 Iterations = 0;
+    int32 Repeats = 0;
+    /** Benchmarks that failed to run, reported as regressions */
+    TArray<FString> Failures;
+
+    bool IsSelected(const FString& Name) const
+    {
+        return Filter.IsEmpty() || Name.Contains(Filter);
+    }
+
+    void Fail(const FString& Name)
+    {
+        UE_LOG(LogUnLua, Error, TEXT("Benchmark %s failed"), *Name);
+        Failures.Add(Name);
+    }
+};
+
+/** Parameters of the server RPCs, laid out like the ones of their blueprint functions */
+struct FUnLuaBenchmarkHitParams
+{
+    int32 Value;
+    FVector Location;
+};
+
+/** Blueprint subclass of the benchmark object with the server RPCs, replicated custom events as games declare them */
+static UClass* CreateRPCClass()
+{
+    const auto Name = TEXT("BP_UnLuaBenchmarkRPC");
+    const auto Package = CreatePackage(*(FString(TEXT("/Temp/UnLuaBenchmark/")) + Name));
+    const auto Blueprint = FKismetEditorUtilities::CreateBlueprint(UUnLuaBenchmarkObject::StaticClass(), Package, Name, BPTYPE_Normal,
+                                                                   UBlueprint::StaticClass(), UBlueprintGeneratedClass::StaticClass());
+    Blueprint->AddToRoot();
+
+    FEdGraphPinType IntType;
+    IntType.PinCategory = UEdGraphSchema_K2::PC_Int;
+    FEdGraphPinType VectorType;
+    VectorType.PinCategory = UEdGraphSchema_K2::PC_Struct;
+    VectorType.PinSubCategoryObject = TBaseStructure<FVector>::Get();
+
+    const auto EventGraph = FBlueprintEditorUtils::FindEventGraph(Blueprint);
+    for (const auto FuncName : {TEXT("ServerHit"), TEXT("ServerHitBatched")})
+    {
+        const auto Event = NewObject<UK2Node_CustomEvent>(EventGraph);
+        Event->CustomFunctionName = FuncName;
+        Event->FunctionFlags |= FUNC_Net | FUNC_NetServer | FUNC_NetReliable;
+        EventGraph->AddNode(Event, false, false);
+        Event->CreateNewGuid();
+        Event->PostPlacedNewNode();
+        Event->AllocateDefaultPins();
+        Event->CreateUserDefinedPin(TEXT("Value"), IntType, EGPD_Output);
+        Event->CreateUserDefinedPin(TEXT("Location"), VectorType, EGPD_Output);
+    }
+
+    FKismetEditorUtilities::CompileBlueprint(Blueprint);
+    return Blueprint->GeneratedClass;
+}
+
+/** Find the server RPC on the class of the object, as the net driver does when receiving it */
+static UFunction* FindServerRPC(UObject* Object, const TCHAR* FuncName)
+{
+    const auto Function = Object->FindFunction(FuncName);
+    if (!Function || !Function->HasAllFunctionFlags(FUNC_Net | FUNC_NetServer) || Function->ParmsSize != sizeof(FUnLuaBenchmarkHitParams))
+    {
+        UE_LOG(LogUnLua, Error, TEXT("Server RPC %s not found on %s"), FuncName, *Object->GetClass()->GetName());
+        return nullptr;
+    }
+    return Function;
+}
+
+/** Hot paths of the boundary, median ns/op and allocations/op of the repeats */
+static void RunMicroBenchmarks(FUnLuaBenchmarkContext& Context, TArray<FUnLuaBenchmarkResult>& Results)
+{
+    const auto Env = Context.Env;
+    const auto L = Context.L;
+    const auto Object = Context.Object;
+    const auto CountingMalloc = Context.CountingMalloc;
+
+    // simulated clients sending RPCs to the server
+    constexpr int32 NumClients = 64;
+    constexpr int32 RPCsPerTick = 256;
+    const auto RPCClass = CreateRPCClass();
+    TArray<UObject*> Clients;
+    for (int32 i = 0; i < NumClients; ++i)
+    {
+        Clients.Add(NewObject<UObject>(GetTransientPackage(), RPCClass));
+        Clients.Last()->AddToRoot();
+    }
+    const auto ServerHit = FindServerRPC(Clients[0], TEXT("ServerHit"));
+    const auto ServerHitBatched = FindServerRPC(Clients[0], TEXT("ServerHitBatched"));
+
+    auto& EventBus = Env->GetEventBus();
+    const FName Topic1(TEXT("UnLua.Benchmark.1"));
+    const FName Topic10(TEXT("UnLua.Benchmark.10"));
+    const FName Topic1000(TEXT("UnLua.Benchmark.1000"));
+    auto& RPCBatcher = Env->GetRPCBatcher();
+
+    const TArray<FUnLuaBenchmark> Benchmarks = {
+        // UE -> Lua, ULuaFunction::execCallLua
+        {TEXT("OverrideCall"), [Object](int32 Count)
+        {
+            for (int32 i = 0; i < Count; ++i)
+                Object->Compute(i);
+            return (int64)Count;
+        }},
+        // Lua -> UE, FFunctionDesc::CallUE
+        {TEXT("CallUE"), [L, Object](int32 Count) { return RunLua(L, Object, "CallUE", Count); }},
+        // Class_Index / Class_NewIndex
+        {TEXT("PropertyRead"), [L, Object](int32 Count) { return RunLua(L, Object, "ReadProperty", Count); }},
+        {TEXT("PropertyWrite"), [L, Object](int32 Count) { return RunLua(L, Object, "WriteProperty", Count); }},
+        // FObjectRegistry::Push of an object already pushed
+        {TEXT("ObjectPush"), [L, Object](int32 Count)
+        {
+            for (int32 i = 0; i < Count; ++i)
+            {
+                UnLua::PushUObject(L, Object);
+                lua_pop(L, 1);
+            }
+            return (int64)Count;
+        }},
+        // one op per element
+        {TEXT("ArrayIterate"), [L, Object](int32 Count) { return RunLua(L, Object, "IterateArray", Count); }},
+        // dynamic multicast delegate with a Lua callback
+        {TEXT("DelegateBroadcast"), [Object](int32 Count)
+        {
+            for (int32 i = 0; i < Count; ++i)
+                Object->OnNotify.Broadcast(i);
+            return (int64)Count;
+        }},
+        // FLuaEventBus, one op per publish to all listeners of the topic
+        {TEXT("EventPublish1"), [L, Object](int32 Count) { return RunLua(L, Object, "PublishEvents1", Count); }},
+        {TEXT("EventPublish10"), [L, Object](int32 Count) { return RunLua(L, Object, "PublishEvents10", Count); }},
+        {TEXT("EventPublish1000"), [L, Object](int32 Count) { return RunLua(L, Object, "PublishEvents1000", Count); }},
+        {TEXT("EventPublishNative1"), [&EventBus, Topic1](int32 Count)
+        {
+            for (int32 i = 0; i < Count; ++i)
+                EventBus.Publish(Topic1, i);
+            return (int64)Count;
+        }},
+        {TEXT("EventPublishNative10"), [&EventBus, Topic10](int32 Count)
+        {
+            for (int32 i = 0; i < Count; ++i)
+                EventBus.Publish(Topic10, i);
+            return (int64)Count;
+        }},
+        {TEXT("EventPublishNative1000"), [&EventBus, Topic1000](int32 Count)
+        {
+            for (int32 i = 0; i < Count; ++i)
+                EventBus.Publish(Topic1000, i);
+            return (int64)Count;
+        }},
+        // RPCs from the clients received by ProcessEvent, one op per RPC including its share of the per tick delivery
+        {TEXT("RPCReceive"), [&Clients, ServerHit](int32 Count)
+        {
+            if (!ServerHit)
+                return (int64)-1;
+            for (int32 i = 0; i < Count; ++i)
+            {
+                FUnLuaBenchmarkHitParams Params{i, FVector(i, 0, 0)};
+                Clients[i % NumClients]->ProcessEvent(ServerHit, &Params);
+            }
+            return (int64)Count;
+        }},
+        {TEXT("RPCReceiveBatched"), [&Clients, ServerHitBatched, &RPCBatcher](int32 Count)
+        {
+            if (!ServerHitBatched)
+                return (int64)-1;
+            for (int32 i = 0; i < Count; ++i)
+            {
+                FUnLuaBenchmarkHitParams Params{i, FVector(i, 0, 0)};
+                Clients[i % NumClients]->ProcessEvent(ServerHitBatched, &Params);
+                if ((i + 1) % RPCsPerTick == 0)
+                    RPCBatcher.Flush();
+            }
+            RPCBatcher.Flush();
+            return (int64)Count;
+        }},
+        // ScriptStruct_Index / ScriptStruct_NewIndex on a FHitResult, one op per field access
+        {TEXT("HitResultRead"), [L, Object](int32 Count) { return RunLua(L, Object, "ReadHitResult", Count); }},
+        {TEXT("HitResultReadNested"), [L, Object](int32 Count) { return RunLua(L, Object, "ReadHitResultNested", Count); }},
+        {TEXT("HitResultWrite"), [L, Object](int32 Count) { return RunLua(L, Object, "WriteHitResult", Count); }},
+        // FVector add and dot
+        {TEXT("VectorMath"), [L, Object](int32 Count) { return RunLua(L, Object, "VectorMath", Count); }},
+        // statically exported add and dot, TDispatchedFunction against TExportedStaticMemberFunction
+        {TEXT("StaticExportMath"), [L, Object](int32 Count) { return RunLua(L, Object, "StaticExportMath", Count); }},
+        {TEXT("StaticExportMathLegacy"), [L, Object](int32 Count) { return RunLua(L, Object, "StaticExportMathLegacy", Count); }},
+    };
+
+    for (const auto& Benchmark : Benchmarks)
+    {
+        if (!Context.IsSelected(Benchmark.Name))
+            continue;
+
+        if (Benchmark.Run(FMath::Max(Context.Iterations / 10, 1)) < 0) // warm up
+        {
+            Context.Fail(Benchmark.Name);
+            continue;
+        }
+
+        // normalised by the operations actually run, Lua loops over groups of operations may run fewer than asked
+        TArray<double> Times;
+        TArray<double> Allocs;
+        for (int32 i = 0; i < Context.Repeats; ++i)
+        {
+            Env->GC();
+            CountingMalloc->Reset();
+            const double StartTime = FPlatformTime::Seconds();
+            const int64 NumOps = Benchmark.Run(Context.Iterations);
+            if (NumOps < 0)
+                break;
+            Times.Add((FPlatformTime::Seconds() - StartTime) * 1e9 / FMath::Max<int64>(NumOps, 1));
+            Allocs.Add((double)CountingMalloc->GetNumAllocs() / FMath::Max<int64>(NumOps, 1));
+        }
+        if (Times.Num() < Context.Repeats)
+        {
+            Context.Fail(Benchmark.Name);
+            continue;
+        }
+
+        // median of the repeats
+        Times.Sort();
+        Allocs.Sort();
+        FUnLuaBenchmarkResult Result;
+        Result.Name = Benchmark.Name;
+        Result.NsPerOp = Times[Context.Repeats / 2];
+        Result.AllocsPerOp = Allocs[Context.Repeats / 2];
+        Results.Add(Result);
+    }
+
+    for (const auto Client : Clients)
+        Client->RemoveFromRoot();
+}
+
+/** GC pause with many live UObject and struct proxies cached by the env, one op per proxy */
+static void RunGCPauseBenchmarks(FUnLuaBenchmarkContext& Context, TArray<FUnLuaBenchmarkResult>& Results)
+{
+    constexpr int32 NumProxies = 100000;
+    const auto L = Context.L;
+    if (Context.IsSelected(TEXT("GCPauseObjects")))
+    {
+        TArray<UObject*> ProxyObjects;
+        for (int32 i = 0; i < NumProxies; ++i)
+        {
+            ProxyObjects.Add(NewObject<UObject>(GetTransientPackage()));
+            ProxyObjects.Last()->AddToRoot();
+        }
+        FUnLuaBenchmarkResult Result;
+        Result.Name = TEXT("GCPauseObjects");
+        Result.NsPerOp = MeasureGCPause(L, NumProxies, Context.Repeats, [L, &ProxyObjects](int32 Index) { UnLua::PushUObject(L, ProxyObjects[Index]); });
+        Results.Add(Result);
+        for (const auto ProxyObject : ProxyObjects)
+            ProxyObject->RemoveFromRoot();
+    }
+    if (Context.IsSelected(TEXT("GCPauseStructs")))
+    {
+        if (Context.Env->GetClassRegistry()->Register("FVector"))
+        {
+            TArray<FVector> Vectors;
+            Vectors.SetNumZeroed(NumProxies);
+            FUnLuaBenchmarkResult Result;
+            Result.Name = TEXT("GCPauseStructs");
+            Result.NsPerOp = MeasureGCPause(L, NumProxies, Context.Repeats, [L, &Vectors](int32 Index) { UnLua::PushPointer(L, &Vectors[Index], "FVector"); });
+            Results.Add(Result);
+        }
+        else
+        {
+            Context.Fail(TEXT("GCPauseStructs"));
+        }
+    }
+    if (Context.IsSelected(TEXT("GCPauseWeakMap")))
+    {
+        // the weak value map keyed by light userdata the proxies were cached in before, to compare against in one run
+        lua_newtable(L);
+        lua_createtable(L, 0, 1);
+        lua_pushstring(L, "__mode");
+        lua_pushstring(L, "v");
+        lua_rawset(L, -3);
+        lua_setmetatable(L, -2);
+        const int32 WeakMap = lua_gettop(L);
+
+        FUnLuaBenchmarkResult Result;
+        Result.Name = TEXT("GCPauseWeakMap");
+        Result.NsPerOp = MeasureGCPause(L, NumProxies, Context.Repeats, [L, WeakMap](int32 Index)
+        {
+            lua_newuserdata(L, sizeof(void*));
+            lua_pushlightuserdata(L, (void*)((UPTRINT)(Index + 1) * sizeof(void*)));
+            lua_pushvalue(L, -2);
+            lua_rawset(L, WeakMap);
+        });
+        Results.Add(Result);
+        lua_pop(L, 1);
+    }
+}
+
+/**
+ * Hot reload replacing the functions of 100 modules of 100 functions in the object graph, C++ against Lua,
+ * one op per replaced function
+ */
+static void RunHotReloadBenchmarks(FUnLuaBenchmarkContext& Context, TArray<FUnLuaBenchmarkResult>& Results)
+{
+    const auto L = Context.L;
+    const auto Object = Context.Object;
+    for (const auto& Patch : {TPair<const TCHAR*, const char*>(TEXT("HotReloadPatchNative"), "PatchObjectGraphNative"),
+                              TPair<const TCHAR*, const char*>(TEXT("HotReloadPatchLua"), "PatchObjectGraphLua")})
+    {
+        if (!Context.IsSelected(Patch.Key))
+            continue;
+
+        TArray<double> Times;
+        TArray<double> Allocs;
+        for (int32 i = 0; i <= Context.Repeats; ++i)
+        {
+            if (!CallLua(L, Object, "PrepareObjectGraph", 0))
+                break;
+            Context.Env->GC();
+            Context.CountingMalloc->Reset();
+            const double StartTime = FPlatformTime::Seconds();
+            if (!CallLua(L, Object, Patch.Value, 0))
+                break;
+            const double Seconds = FPlatformTime::Seconds() - StartTime;
+            const uint64 NumAllocs = Context.CountingMalloc->GetNumAllocs();
+            const int64 NumOps = FMath::Max<int64>(RunLua(L, Object, "CountPatchedFunctions", 0), 1);
+            if (i == 0)
+                continue; // warm up
+            Times.Add(Seconds * 1e9 / NumOps);
+            Allocs.Add((double)NumAllocs / NumOps);
+        }
+        if (Times.Num() < Context.Repeats)
+        {
+            Context.Fail(Patch.Key);
+            continue;
+        }
+
+        Times.Sort();
+        Allocs.Sort();
+        FUnLuaBenchmarkResult Result;
+        Result.Name = Patch.Key;
+        Result.NsPerOp = Times[Context.Repeats / 2];
+        Result.AllocsPerOp = Allocs[Context.Repeats / 2];
+        Results.Add(Result);
+    }
+}
+
+/** First spawn of distinct bound classes, bound on the spot or prebound from an override manifest */
+static void MeasureHitches(FUnLuaBenchmarkContext& Context, TArray<FUnLuaHitchResult>& Hitches)
+{
+    if (!Context.IsSelected(TEXT("FirstSpawn")) && !Context.IsSelected(TEXT("OverridePrebind")) && !Context.IsSelected(TEXT("FirstSpawnPrebound")))
+        return;
+
+    const auto ColdClasses = CreateBenchmarkClasses(TEXT("BP_UnLuaBenchmarkCold"), NumSpawnClasses);
+    const auto PreboundClasses = CreateBenchmarkClasses(TEXT("BP_UnLuaBenchmarkPrebound"), NumSpawnClasses);
+    UnLua::FLuaOverrideManifest Manifest;
+    for (const auto Class : PreboundClasses)
+        Manifest.Add(*Context.Env, Class, Context.Object->GetModuleName_Implementation());
+
+    Hitches.Add(MeasureFirstSpawn(TEXT("FirstSpawn"), ColdClasses, *Context.CountingMalloc));
+
+    // the pass a loading screen would make, spread over its classes
+    Context.CountingMalloc->Reset();
+    const double StartTime = FPlatformTime::Seconds();
+    Manifest.Prebind(false);
+    FUnLuaHitchResult PrebindResult;
+    PrebindResult.Name = TEXT("OverridePrebind");
+    PrebindResult.MeanMs = (FPlatformTime::Seconds() - StartTime) * 1000 / NumSpawnClasses;
+    PrebindResult.MaxMs = PrebindResult.MeanMs * NumSpawnClasses;
+    PrebindResult.AllocsPerClass = (double)Context.CountingMalloc->GetNumAllocs() / NumSpawnClasses;
+    Hitches.Add(PrebindResult);
+
+    Hitches.Add(MeasureFirstSpawn(TEXT("FirstSpawnPrebound"), PreboundClasses, *Context.CountingMalloc));
+}
+
+/** UE.File reading a large text file line by line and at once, buffered ("r") and memory mapped ("rm") */
+static void MeasureThroughputs(FUnLuaBenchmarkContext& Context, int32 FileMB, TArray<FUnLuaThroughputResult>& Throughputs)
+{
+    struct FUnLuaFileRead
+    {
+        const TCHAR* Name;
+        const char* FuncName;
+        const char* Mode;
+    };
+    TArray<FUnLuaFileRead> FileReads;
+    for (const auto& FileRead : {
+             FUnLuaFileRead{TEXT("FileReadLines"), "ReadFileLines", "r"},
+             FUnLuaFileRead{TEXT("FileReadLinesMapped"), "ReadFileLines", "rm"},
+             FUnLuaFileRead{TEXT("FileReadAll"), "ReadFileAll", "r"},
+             FUnLuaFileRead{TEXT("FileReadAllMapped"), "ReadFileAll", "rm"}})
+    {
+        if (Context.IsSelected(FileRead.Name))
+            FileReads.Add(FileRead);
+    }
+    // the engine reading the whole file natively is the upper bound of the Lua reads
+    const TCHAR* NativeName = TEXT("FileReadNative");
+    if (FileMB <= 0 || (FileReads.Num() == 0 && !Context.IsSelected(NativeName)))
+        return;
+
+    const FString BenchmarkFilePath = FPaths::ProjectSavedDir() / TEXT("UnLua/BenchmarkFile.txt");
+    if (!WriteBenchmarkFile(BenchmarkFilePath, FileMB))
+    {
+        UE_LOG(LogUnLua, Error, TEXT("Failed to write benchmark file %s"), *BenchmarkFilePath);
+        Context.Fail(NativeName);
+        for (const auto& FileRead : FileReads)
+            Context.Fail(FileRead.Name);
+        return;
+    }
+
+    const int64 FileSize = IFileManager::Get().FileSize(*BenchmarkFilePath);
+    const auto AddThroughput = [&](const TCHAR* Name, const TFunction<int64()>& Read)
+    {
+        TArray<double> Times;
+        for (int32 i = 0; i < Context.Repeats; ++i)
+        {
+            Context.Env->GC();
+            const double StartTime = FPlatformTime::Seconds();
+            const int64 Size = Read();
+            Times.Add(FPlatformTime::Seconds() - StartTime);
+            if (Size != FileSize)
+            {
+                UE_LOG(LogUnLua, Error, TEXT("%s read %lld of %lld bytes"), Name, Size, FileSize);
+                Context.Fail(Name);
+                return;
+            }
+        }
+        Times.Sort();
+        FUnLuaThroughputResult Result;
+        Result.Name = Name;
+        Result.Seconds = Times[Context.Repeats / 2];
+        Result.MBPerSecond = FileSize / (1024.0 * 1024.0) / Result.Seconds;
+        Throughputs.Add(Result);
+    };
+
+    AddThroughput(NativeName, [&BenchmarkFilePath]()
+    {
+        TArray<uint8> Data;
+        return FFileHelper::LoadFileToArray(Data, *BenchmarkFilePath) ? (int64)Data.Num() : -1;
+    });
+    for (const auto& FileRead : FileReads)
+    {
+        AddThroughput(FileRead.Name, [&]() { return ReadFileLua(Context.L, Context.Object, FileRead.FuncName, BenchmarkFilePath, FileRead.Mode); });
+    }
+    IFileManager::Get().Delete(*BenchmarkFilePath);
+}
+
+/** ReceiveTick of actors called one by one by their tick functions, or once per frame by the tick manager */
+static void MeasureFrames(FUnLuaBenchmarkContext& Context, int32 Frames, TArray<FUnLuaFrameResult>& FrameResults)
+{
+    TArray<TTuple<FString, UClass*, int32>> TickRuns;
+    for (const int32 NumActors : {100, 500, 2000})
+    {
+        TickRuns.Emplace(FString::Printf(TEXT("TickActors%d"), NumActors), AUnLuaBenchmarkTickActor::StaticClass(), NumActors);
+        TickRuns.Emplace(FString::Printf(TEXT("TickActorsBatched%d"), NumActors), AUnLuaBenchmarkBatchedTickActor::StaticClass(), NumActors);
+    }
+    TickRuns.RemoveAll([&Context](const TTuple<FString, UClass*, int32>& Run) { return !Context.IsSelected(Run.Get<0>()); });
+    if (Frames <= 0 || TickRuns.Num() == 0)
+        return;
+
+    UWorld* World = CreateBenchmarkWorld();
+    for (const auto& Run : TickRuns)
+        FrameResults.Add(MeasureTickFrames(Run.Get<0>(), World, Run.Get<1>(), Run.Get<2>(), Frames));
+    DestroyBenchmarkWorld(World);
+}
+
+static void LoadBaselineArray(const TSharedPtr<FJsonObject>& Root, const TCHAR* FieldName, const TFunctionRef<void(const FJsonObject&)>& Load)
+{
+    const TArray<TSharedPtr<FJsonValue>>* Values;
+    if (!Root->TryGetArrayField(FieldName, Values))
+        return;
+
+    for (const auto& Value : *Values)
+    {
+        const auto Object = Value->AsObject();
+        if (Object.IsValid())
+            Load(*Object);
+    }
+}
+
+/** Baselines saved before hitches, throughputs or frames were reported compare their results only */
+static bool LoadBaseline(const FString& FilePath, FUnLuaBenchmarkBaseline& OutBaseline)
+{
+    FString Content;
+    if (!FFileHelper::LoadFileToString(Content, *FilePath))
+    {
+        UE_LOG(LogUnLua, Error, TEXT("Failed to load benchmark baseline %s"), *FilePath);
+        return false;
+    }
+
+    TSharedPtr<FJsonObject> Root;
+    const auto Reader = TJsonReaderFactory<>::Create(Content);
+    if (!FJsonSerializer::Deserialize(Reader, Root) || !Root.IsValid() || !Root->HasTypedField<EJson::Array>(TEXT("results")))
+    {
+        UE_LOG(LogUnLua, Error, TEXT("Invalid benchmark baseline %s"), *FilePath);
+        return false;
+    }
+
+    LoadBaselineArray(Root, TEXT("results"), [&OutBaseline](const FJsonObject& Object)
+    {
+        FUnLuaBenchmarkResult Result;
+        Result.Name = Object.GetStringField(TEXT("name"));
+        Result.NsPerOp = Object.GetNumberField(TEXT("ns_per_op"));
+        Result.AllocsPerOp = Object.GetNumberField(TEXT("allocs_per_op"));
+        OutBaseline.Results.Add(Result.Name, Result);
+    });
+    LoadBaselineArray(Root, TEXT("hitches"), [&OutBaseline](const FJsonObject& Object)
+    {
+        FUnLuaHitchResult Hitch;
+        Hitch.Name = Object.GetStringField(TEXT("name"));
+        Hitch.MeanMs = Object.GetNumberField(TEXT("mean_ms"));
+        Hitch.MaxMs = Object.GetNumberField(TEXT("max_ms"));
+        Hitch.AllocsPerClass = Object.GetNumberField(TEXT("allocs_per_class"));
+        OutBaseline.Hitches.Add(Hitch.Name, Hitch);
+    });
+    LoadBaselineArray(Root, TEXT("throughput"), [&OutBaseline](const FJsonObject& Object)
+    {
+        FUnLuaThroughputResult Throughput;
+        Throughput.Name = Object.GetStringField(TEXT("name"));
+        Throughput.Seconds = Object.GetNumberField(TEXT("seconds"));
+        Throughput.MBPerSecond = Object.GetNumberField(TEXT("mb_per_s"));
+        OutBaseline.Throughputs.Add(Throughput.Name, Throughput);
+    });
+    LoadBaselineArray(Root, TEXT("frames"), [&OutBaseline](const FJsonObject& Object)
+    {
+        FUnLuaFrameResult Frame;
+        Frame.Name = Object.GetStringField(TEXT("name"));
+        Frame.NumActors = (int32)Object.GetNumberField(TEXT("actors"));
+        Frame.MsPerFrame = Object.GetNumberField(TEXT("ms_per_frame"));
+        OutBaseline.Frames.Add(Frame.Name, Frame);
+    });
+    return true;
+}
+
+/** Change from the baseline in percent */
+static double GetDeltaPercent(double Value, double Base)
+{
+    return Base > 0 ? (Value / Base - 1) * 100 : 0;
+}
+
+/** Compares the results against the baseline, @return the results as json */
+static TArray<TSharedPtr<FJsonValue>> ReportResults(const TArray<FUnLuaBenchmarkResult>& Results, const FUnLuaBenchmarkBaseline& Baseline, float Tolerance, int32& NumRegressions)
+{
+    const double Scale = 1 + Tolerance / 100;
+    TArray<TSharedPtr<FJsonValue>> Values;
+    for (const auto& Result : Results)
+    {
+        const auto JsonObject = MakeShared<FJsonObject>();
+        JsonObject->SetStringField(TEXT("name"), Result.Name);
+        JsonObject->SetNumberField(TEXT("ns_per_op"), Result.NsPerOp);
+        JsonObject->SetNumberField(TEXT("allocs_per_op"), Result.AllocsPerOp);
+        Values.Add(MakeShared<FJsonValueObject>(JsonObject));
+
+        const auto Base = Baseline.Results.Find(Result.Name);
+        if (!Base)
+        {
+            UE_LOG(LogUnLua, Display, TEXT("%-20s %10.1f ns/op %8.2f allocs/op"), *Result.Name, Result.NsPerOp, Result.AllocsPerOp);
+            continue;
+        }
+
+        const double Delta = GetDeltaPercent(Result.NsPerOp, Base->NsPerOp);
+        // small absolute slack as lua gc may allocate once in a while
+        const bool bRegressed = Result.NsPerOp > Base->NsPerOp * Scale || Result.AllocsPerOp > Base->AllocsPerOp * Scale + 0.05;
+        NumRegressions += bRegressed ? 1 : 0;
+        JsonObject->SetNumberField(TEXT("baseline_ns_per_op"), Base->NsPerOp);
+        JsonObject->SetNumberField(TEXT("baseline_allocs_per_op"), Base->AllocsPerOp);
+        JsonObject->SetNumberField(TEXT("delta_percent"), Delta);
+        JsonObject->SetBoolField(TEXT("regressed"), bRegressed);
+
+        UE_LOG(LogUnLua, Display, TEXT("%-20s %10.1f ns/op %8.2f allocs/op  baseline %10.1f ns/op %8.2f allocs/op  %+6.1f%%%s"),
+               *Result.Name, Result.NsPerOp, Result.AllocsPerOp, Base->NsPerOp, Base->AllocsPerOp, Delta, bRegressed ? TEXT("  REGRESSED") : TEXT(""));
+    }
+    return Values;
+}
+
+static TArray<TSharedPtr<FJsonValue>> ReportHitches(const TArray<FUnLuaHitchResult>& Hitches, const FUnLuaBenchmarkBaseline& Baseline, float Tolerance, int32& NumRegressions)
+{
+    const double Scale = 1 + Tolerance / 100;
+    TArray<TSharedPtr<FJsonValue>> Values;
+    for (const auto& Hitch : Hitches)
+    {
+        const auto JsonObject = MakeShared<FJsonObject>();
+        JsonObject->SetStringField(TEXT("name"), Hitch.Name);
+        JsonObject->SetNumberField(TEXT("classes"), NumSpawnClasses);
+        JsonObject->SetNumberField(TEXT("mean_ms"), Hitch.MeanMs);
+        JsonObject->SetNumberField(TEXT("max_ms"), Hitch.MaxMs);
+        JsonObject->SetNumberField(TEXT("allocs_per_class"), Hitch.AllocsPerClass);
+        Values.Add(MakeShared<FJsonValueObject>(JsonObject));
+
+        const auto Base = Baseline.Hitches.Find(Hitch.Name);
+        if (!Base)
+        {
+            UE_LOG(LogUnLua, Display, TEXT("%-20s %10.3f ms/class %10.3f ms max %8.1f allocs/class"), *Hitch.Name, Hitch.MeanMs, Hitch.MaxMs, Hitch.AllocsPerClass);
+            continue;
+        }
+
+        const double Delta = GetDeltaPercent(Hitch.MeanMs, Base->MeanMs);
+        const bool bRegressed = Hitch.MeanMs > Base->MeanMs * Scale || Hitch.MaxMs > Base->MaxMs * Scale || Hitch.AllocsPerClass > Base->AllocsPerClass * Scale + 0.05;
+        NumRegressions += bRegressed ? 1 : 0;
+        JsonObject->SetNumberField(TEXT("baseline_mean_ms"), Base->MeanMs);
+        JsonObject->SetNumberField(TEXT("baseline_max_ms"), Base->MaxMs);
+        JsonObject->SetNumberField(TEXT("baseline_allocs_per_class"), Base->AllocsPerClass);
+        JsonObject->SetNumberField(TEXT("delta_percent"), Delta);
+        JsonObject->SetBoolField(TEXT("regressed"), bRegressed);
+
+        UE_LOG(LogUnLua, Display, TEXT("%-20s %10.3f ms/class %10.3f ms max %8.1f allocs/class  baseline %10.3f ms/class %10.3f ms max %8.1f allocs/class  %+6.1f%%%s"),
+               *Hitch.Name, Hitch.MeanMs, Hitch.MaxMs, Hitch.AllocsPerClass, Base->MeanMs, Base->MaxMs, Base->AllocsPerClass, Delta, bRegressed ? TEXT("  REGRESSED") : TEXT(""));
+    }
+    return Values;
+}
+
+/** Lower throughputs are the regressions */
+static TArray<TSharedPtr<FJsonValue>> ReportThroughputs(const TArray<FUnLuaThroughputResult>& Throughputs, const FUnLuaBenchmarkBaseline& Baseline, int32 FileMB, float Tolerance, int32& NumRegressions)
+{
+    const double Scale = 1 + Tolerance / 100;
+    TArray<TSharedPtr<FJsonValue>> Values;
+    for (const auto& Throughput : Throughputs)
+    {
+        const auto JsonObject = MakeShared<FJsonObject>();
+        JsonObject->SetStringField(TEXT("name"), Throughput.Name);
+        JsonObject->SetNumberField(TEXT("megabytes"), FileMB);
+        JsonObject->SetNumberField(TEXT("seconds"), Throughput.Seconds);
+        JsonObject->SetNumberField(TEXT("mb_per_s"), Throughput.MBPerSecond);
+        Values.Add(MakeShared<FJsonValueObject>(JsonObject));
+
+        const auto Base = Baseline.Throughputs.Find(Throughput.Name);
+        if (!Base)
+        {
+            UE_LOG(LogUnLua, Display, TEXT("%-20s %10.3f s %10.1f MB/s"), *Throughput.Name, Throughput.Seconds, Throughput.MBPerSecond);
+            continue;
+        }
+
+        const double Delta = GetDeltaPercent(Throughput.MBPerSecond, Base->MBPerSecond);
+        const bool bRegressed = Throughput.MBPerSecond * Scale < Base->MBPerSecond;
+        NumRegressions += bRegressed ? 1 : 0;
+        JsonObject->SetNumberField(TEXT("baseline_mb_per_s"), Base->MBPerSecond);
+        JsonObject->SetNumberField(TEXT("delta_percent"), Delta);
+        JsonObject->SetBoolField(TEXT("regressed"), bRegressed);
+
+        UE_LOG(LogUnLua, Display, TEXT("%-20s %10.3f s %10.1f MB/s  baseline %10.1f MB/s  %+6.1f%%%s"),
+               *Throughput.Name, Throughput.Seconds, Throughput.MBPerSecond, Base->MBPerSecond, Delta, bRegressed ? TEXT("  REGRESSED") : TEXT(""));
+    }
+    return Values;
+}
+
+static TArray<TSharedPtr<FJsonValue>> ReportFrames(const TArray<FUnLuaFrameResult>& FrameResults, const FUnLuaBenchmarkBaseline& Baseline, int32 Frames, float Tolerance, int32& NumRegressions)
+{
+    const double Scale = 1 + Tolerance / 100;
+    TArray<TSharedPtr<FJsonValue>> Values;
+    for (const auto& Frame : FrameResults)
+    {
+        const auto JsonObject = MakeShared<FJsonObject>();
+        JsonObject->SetStringField(TEXT("name"), Frame.Name);
+        JsonObject->SetNumberField(TEXT("actors"), Frame.NumActors);
+        JsonObject->SetNumberField(TEXT("frames"), Frames);
+        JsonObject->SetNumberField(TEXT("ms_per_frame"), Frame.MsPerFrame);
+        Values.Add(MakeShared<FJsonValueObject>(JsonObject));
+
+        const auto Base = Baseline.Frames.Find(Frame.Name);
+        if (!Base)
+        {
+            UE_LOG(LogUnLua, Display, TEXT("%-20s %10.3f ms/frame %10.1f ns/actor"), *Frame.Name, Frame.MsPerFrame, Frame.MsPerFrame * 1e6 / Frame.NumActors);
+            continue;
+        }
+
+        const double Delta = GetDeltaPercent(Frame.MsPerFrame, Base->MsPerFrame);
+        const bool bRegressed = Frame.MsPerFrame > Base->MsPerFrame * Scale;
+        NumRegressions += bRegressed ? 1 : 0;
+        JsonObject->SetNumberField(TEXT("baseline_ms_per_frame"), Base->MsPerFrame);
+        JsonObject->SetNumberField(TEXT("delta_percent"), Delta);
+        JsonObject->SetBoolField(TEXT("regressed"), bRegressed);
+
+        UE_LOG(LogUnLua, Display, TEXT("%-20s %10.3f ms/frame %10.1f ns/actor  baseline %10.3f ms/frame  %+6.1f%%%s"),
+               *Frame.Name, Frame.MsPerFrame, Frame.MsPerFrame * 1e6 / Frame.NumActors, Base->MsPerFrame, Delta, bRegressed ? TEXT("  REGRESSED") : TEXT(""));
+    }
+    return Values;
+}
+
+/** Benchmarks of the baseline picked by the filter without a result, @return their names */
+template <typename ResultType>
+static TArray<FString> FindMissing(const TMap<FString, ResultType>& BaselineResults, const TArray<ResultType>& Results, const FUnLuaBenchmarkContext& Context)
+{
+    TArray<FString> Missing;
+    for (const auto& Pair : BaselineResults)
+    {
+        if (!Context.IsSelected(Pair.Key) || Context.Failures.Contains(Pair.Key))
+            continue;
+        if (!Results.ContainsByPredicate([&Pair](const ResultType& Result) { return Result.Name == Pair.Key; }))
+            Missing.Add(Pair.Key);
+    }
+    return Missing;
+}
+
+UUnLuaBenchmarkCommandlet::UUnLuaBenchmarkCommandlet(const FObjectInitializer& ObjectInitializer)
+    : Super(ObjectInitializer)
+{
+    LogToConsole = true;
+}
+
+int32 UUnLuaBenchmarkCommandlet::Main(const FString& Params)
+{
+    FUnLuaBenchmarkContext Context;
+    Context.Iterations = 100000;
+    Context.Repeats = 5;
+    float Tolerance = 10;
+    FString OutputPath = FPaths::ProjectSavedDir() / TEXT("UnLua/Benchmark.json");
+    FString BaselinePath;
+    int32 FileMB = 100;
+    int32 Frames = 300;
+    FParse::Value(*Params, TEXT("Iterations="), Context.Iterations);
+    FParse::Value(*Params, TEXT("Repeats="), Context.Repeats);
+    FParse::Value(*Params, TEXT("Tolerance="), Tolerance);
+    FParse::Value(*Params, TEXT("Filter="), Context.Filter);
+    FParse::Value(*Params, TEXT("Output="), OutputPath);
+    FParse::Value(*Params, TEXT("Baseline="), BaselinePath);
+    FParse::Value(*Params, TEXT("FileMB="), FileMB);
+    FParse::Value(*Params, TEXT("Frames="), Frames);
+    Context.Iterations = FMath::Max(Context.Iterations, 1);
+    Context.Repeats = FMath::Max(Context.Repeats, 1);
+
+    FUnLuaBenchmarkBaseline Baseline;
+    if (!BaselinePath.IsEmpty() && !LoadBaseline(BaselinePath, Baseline))
+        return 1;
+
+    auto& UnLuaModule = IUnLuaModule::Get();
+    const bool bWasActive = UnLuaModule.IsActive();
+    UnLuaModule.SetActive(true);
+
+    // bound on creation by its module name
+    const auto Object = NewObject<UUnLuaBenchmarkObject>(GetTransientPackage());
+    Object->AddToRoot();
+    constexpr int32 ArrayLength = 100;
+    for (int32 i = 0; i < ArrayLength; ++i)
+        Object->Numbers.Add(i);
+    Object->Hit = FHitResult(FVector::ZeroVector, FVector(100, 0, 0));
+    Object->Hit.bBlockingHit = true;
+    Object->Hit.Location = FVector(50, 0, 0);
+    Object->Hit.Distance = 50;
+
+    Context.Object = Object;
+    Context.Env = UnLuaModule.GetEnv(Object);
+    Context.L = Context.Env->GetMainState();
+    const auto L = Context.L;
+    if (!CallLua(L, Object, "BindNotify", 0)
+        || !CallLua(L, Object, "SubscribeEvents1", 0)
+        || !CallLua(L, Object, "SubscribeEvents10", 0)
+        || !CallLua(L, Object, "SubscribeEvents1000", 0))
+    {
+        Object->RemoveFromRoot();
+        UnLuaModule.SetActive(bWasActive);
+        return 1;
+    }
+
+    static FUnLuaBenchmarkMalloc* CountingMalloc = new FUnLuaBenchmarkMalloc(GMalloc);
+    Context.CountingMalloc = CountingMalloc;
+    FMalloc* SavedMalloc = (FMalloc*)FPlatformAtomics::InterlockedExchangePtr((void**)&GMalloc, CountingMalloc);
+
+    TArray<FUnLuaBenchmarkResult> Results;
+    RunMicroBenchmarks(Context, Results);
+    RunGCPauseBenchmarks(Context, Results);
+    RunHotReloadBenchmarks(Context, Results);
+    TArray<FUnLuaHitchResult> Hitches;
+    MeasureHitches(Context, Hitches);
+
+    FPlatformAtomics::InterlockedExchangePtr((void**)&GMalloc, SavedMalloc);
+
+    TArray<FUnLuaThroughputResult> Throughputs;
+    MeasureThroughputs(Context, FileMB, Throughputs);
+    TArray<FUnLuaFrameResult> FrameResults;
+    MeasureFrames(Context, Frames, FrameResults);
+
+    Object->RemoveFromRoot();
+    UnLuaModule.SetActive(bWasActive);
+
+    int32 NumRegressions = 0;
+    const auto FrameValues = ReportFrames(FrameResults, Baseline, Frames, Tolerance, NumRegressions);
+    const auto ThroughputValues = ReportThroughputs(Throughputs, Baseline, FileMB, Tolerance, NumRegressions);
+    const auto HitchValues = ReportHitches(Hitches, Baseline, Tolerance, NumRegressions);
+    const auto ResultValues = ReportResults(Results, Baseline, Tolerance, NumRegressions);
+
+    // disabled kinds are not missing
+    TArray<FString> Missing = FindMissing(Baseline.Results, Results, Context);
+    Missing.Append(FindMissing(Baseline.Hitches, Hitches, Context));
+    if (FileMB > 0)
+        Missing.Append(FindMissing(Baseline.Throughputs, Throughputs, Context));
+    if (Frames > 0)
+        Missing.Append(FindMissing(Baseline.Frames, FrameResults, Context));
+    for (const auto& Name : Missing)
+        UE_LOG(LogUnLua, Error, TEXT("%-20s in baseline %s has no result"), *Name, *BaselinePath);
+
+    TArray<TSharedPtr<FJsonValue>> FailureValues;
+    for (const auto& Name : Context.Failures)
+        FailureValues.Add(MakeShared<FJsonValueString>(Name));
+    TArray<TSharedPtr<FJsonValue>> MissingValues;
+    for (const auto& Name : Missing)
+        MissingValues.Add(MakeShared<FJsonValueString>(Name));
+
+    const auto Root = MakeShared<FJsonObject>();
+    Root->SetStringField(TEXT("engine"), FEngineVersion::Current().ToString());
+    Root->SetNumberField(TEXT("iterations"), Context.Iterations);
+    Root->SetNumberField(TEXT("repeats"), Context.Repeats);
+    Root->SetArrayField(TEXT("results"), ResultValues);
+    Root->SetArrayField(TEXT("hitches"), HitchValues);
+    Root->SetArrayField(TEXT("throughput"), ThroughputValues);
+    Root->SetArrayField(TEXT("frames"), FrameValues);
+    Root->SetArrayField(TEXT("failed"), FailureValues);
+    Root->SetArrayField(TEXT("missing"), MissingValues);
+
+    FString Content;
+    const auto Writer = TJsonWriterFactory<>::Create(&Content);
+    FJsonSerializer::Serialize(Root, Writer);
+    if (!FFileHelper::SaveStringToFile(Content, *OutputPath))
+    {
+        UE_LOG(LogUnLua, Error, TEXT("Failed to save benchmark results to %s"), *OutputPath);
+        return 1;
+    }
+    UE_LOG(LogUnLua, Display, TEXT("Benchmark results saved to %s"), *FPaths::ConvertRelativePathToFull(OutputPath));
+
+    if (Context.Failures.Num() > 0)
+        UE_LOG(LogUnLua, Error, TEXT("%d benchmark(s) failed: %s"), Context.Failures.Num(), *FString::Join(Context.Failures, TEXT(", ")));
+    if (NumRegressions > 0 || Missing.Num() > 0)
+        UE_LOG(LogUnLua, Error, TEXT("%d benchmark(s) regressed beyond %.1f%% of baseline %s, %d missing"), NumRegressions, Tolerance, *BaselinePath, Missing.Num());
+    return Context.Failures.Num() > 0 || NumRegressions > 0 || Missing.Num() > 0 ? 1 : 0;
+}
@@ -0,0 +1,217 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#include "Commandlets/UnLuaLoadAsyncCheckCommandlet.h"
+
+#if ENGINE_MAJOR_VERSION > 4
+#include "AssetRegistry/AssetRegistryModule.h"
+#else
+#include "AssetRegistryModule.h"
+#endif
+#include "Containers/Ticker.h"
+#include "Engine/Blueprint.h"
+#include "Misc/CoreDelegates.h"
+#include "UObject/SoftObjectPtr.h"
+#include "LuaEnv.h"
+#include "UnLuaBase.h"
+#include "UnLuaCompatibility.h"
+
+/** Unloaded assets under the content paths, and the classes of the unloaded blueprints among them */
+static void FindUnloadedAssets(const TArray<FString>& ContentPaths, TArray<FString>& OutObjectPaths, TArray<FString>& OutClassPaths)
+{
+    auto& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+    AssetRegistry.SearchAllAssets(true);
+
+    FARFilter Filter;
+    Filter.bRecursivePaths = true;
+    for (const auto& Path : ContentPaths)
+        Filter.PackagePaths.Add(*Path);
+
+    TArray<FAssetData> Assets;
+    AssetRegistry.GetAssets(Filter, Assets);
+    for (const auto& Asset : Assets)
+    {
+        if (Asset.IsAssetLoaded() || Asset.IsRedirector() || (Asset.PackageFlags & PKG_ContainsMap))
+            continue;
+
+        const FString ObjectPath = Asset.PackageName.ToString() + TEXT(".") + Asset.AssetName.ToString();
+        if (OutClassPaths.Num() == 0 && Asset.GetClass() && Asset.GetClass()->IsChildOf<UBlueprint>())
+        {
+            OutClassPaths.Add(ObjectPath + TEXT("_C"));
+            continue;
+        }
+        if (OutObjectPaths.Num() < 5)
+            OutObjectPaths.Add(ObjectPath);
+    }
+}
+
+UUnLuaLoadAsyncCheckCommandlet::UUnLuaLoadAsyncCheckCommandlet(const FObjectInitializer& ObjectInitializer)
+    : Super(ObjectInitializer)
+{
+    LogToConsole = true;
+}
+
+int32 UUnLuaLoadAsyncCheckCommandlet::Main(const FString& Params)
+{
+    FString AssetsParam;
+    FString PathsParam = TEXT("/Game");
+    float Timeout = 60;
+    FParse::Value(*Params, TEXT("Assets="), AssetsParam);
+    FParse::Value(*Params, TEXT("Paths="), PathsParam);
+    FParse::Value(*Params, TEXT("Timeout="), Timeout);
+
+    TArray<FString> ObjectPaths;
+    TArray<FString> ClassPaths;
+    if (AssetsParam.IsEmpty())
+    {
+        TArray<FString> ContentPaths;
+        PathsParam.ParseIntoArray(ContentPaths, TEXT("+"));
+        FindUnloadedAssets(ContentPaths, ObjectPaths, ClassPaths);
+    }
+    else
+    {
+        AssetsParam.ParseIntoArray(ObjectPaths, TEXT("+"));
+    }
+
+    if (ObjectPaths.Num() == 0)
+    {
+        UE_LOG(LogUnLua, Error, TEXT("No unloaded assets to load under %s"), *PathsParam);
+        return 1;
+    }
+
+    int32 NumSyncLoads = 0;
+    const auto OnSyncLoadPackage = [&NumSyncLoads](const FString& PackageName)
+    {
+        ++NumSyncLoads;
+        UE_LOG(LogUnLua, Error, TEXT("Synchronous load of %s"), *PackageName);
+    };
+#if ENGINE_MAJOR_VERSION > 4
+    const auto SyncLoadHandle = FCoreUObjectDelegates::OnSyncLoadPackage.AddLambda(OnSyncLoadPackage);
+#else
+    const auto SyncLoadHandle = FCoreDelegates::OnSyncLoadPackage.AddLambda(OnSyncLoadPackage);
+#endif
+
+    static const char* Chunk = R"(
+        local Paths, ClassPath = ...
+        local Results = { Done = 0, Expected = ClassPath and 3 or 2, Failed = {} }
+        local function Check(Name, Object)
+            if not Object then
+                table.insert(Results.Failed, Name)
+            end
+        end
+
+        UnLua.StartCoroutine(function()
+            Check("UObject.LoadAsync", UE.UObject.LoadAsync(Paths[1]))
+            local Batch = UE.UObject.LoadAsyncBatch({ Paths[2], Paths[3], Paths[4] })
+            for i = 1, 3 do
+                Check("UObject.LoadAsyncBatch[" .. i .. "]", Batch[i])
+            end
+            Results.Done = Results.Done + 1
+        end)
+
+        UE.UObject.LoadAsync(Paths[5], function(Object)
+            Check("UObject.LoadAsync callback", Object)
+            Results.Done = Results.Done + 1
+        end)
+
+        if ClassPath then
+            UnLua.StartCoroutine(function()
+                Check("UClass.LoadAsync", UE.UClass.LoadAsync(ClassPath))
+                Results.Done = Results.Done + 1
+            end)
+        end
+        return Results
+    )";
+
+    const auto GetObjectPath = [&ObjectPaths](int32 Index) { return ObjectPaths[Index % ObjectPaths.Num()]; };
+    FSoftObjectPtr SoftObject(FSoftObjectPath(GetObjectPath(2)));
+    FSoftObjectPath SoftObjectPath(GetObjectPath(3));
+
+    int32 NumFailed = 0;
+    {
+        UnLua::FLuaEnv Env;
+        lua_State* L = Env.GetMainState();
+        Env.GetClassRegistry()->Register("FSoftObjectPtr");
+        Env.GetClassRegistry()->Register(TBaseStructure<FSoftObjectPath>::Get());
+
+        const int32 Top = lua_gettop(L);
+        lua_pushcfunction(L, UnLua::ReportLuaCallError);
+        luaL_loadstring(L, Chunk);
+        lua_createtable(L, 5, 0);
+        lua_pushstring(L, TCHAR_TO_UTF8(*GetObjectPath(0)));
+        lua_rawseti(L, -2, 1);
+        lua_pushstring(L, TCHAR_TO_UTF8(*GetObjectPath(1)));
+        lua_rawseti(L, -2, 2);
+        UnLua::PushPointer(L, &SoftObject, "FSoftObjectPtr");
+        lua_rawseti(L, -2, 3);
+        UnLua::PushPointer(L, &SoftObjectPath, "FSoftObjectPath");
+        lua_rawseti(L, -2, 4);
+        lua_pushstring(L, TCHAR_TO_UTF8(*GetObjectPath(4)));
+        lua_rawseti(L, -2, 5);
+        if (ClassPaths.Num() > 0)
+            lua_pushstring(L, TCHAR_TO_UTF8(*ClassPaths[0]));
+        else
+            lua_pushnil(L);
+        if (lua_pcall(L, 2, 1, Top + 1) != LUA_OK)
+        {
+            UE_LOG(LogUnLua, Error, TEXT("Failed to start the async loads"));
+            ++NumFailed;
+        }
+        else
+        {
+            const auto GetNumber = [L](const char* Name)
+            {
+                lua_getfield(L, -1, Name);
+                const lua_Integer Value = lua_tointeger(L, -1);
+                lua_pop(L, 1);
+                return Value;
+            };
+
+            // the loads are completed on the game thread, from the async loading and the core ticker
+            const double StartTime = FPlatformTime::Seconds();
+            while (GetNumber("Done") < GetNumber("Expected") && FPlatformTime::Seconds() - StartTime < Timeout)
+            {
+                ProcessAsyncLoading(true, false, 0.01f);
+                FTSTicker::GetCoreTicker().Tick(0.01f);
+            }
+
+            if (GetNumber("Done") < GetNumber("Expected"))
+            {
+                UE_LOG(LogUnLua, Error, TEXT("Async loads didn't complete in %.0f seconds"), Timeout);
+                ++NumFailed;
+            }
+
+            lua_getfield(L, -1, "Failed");
+            const lua_Integer NumFailedLoads = luaL_len(L, -1);
+            for (lua_Integer i = 1; i <= NumFailedLoads; ++i)
+            {
+                lua_rawgeti(L, -1, i);
+                UE_LOG(LogUnLua, Error, TEXT("%s returned nil"), UTF8_TO_TCHAR(lua_tostring(L, -1)));
+                lua_pop(L, 1);
+            }
+            NumFailed += NumFailedLoads;
+        }
+        lua_settop(L, Top);
+    }
+
+#if ENGINE_MAJOR_VERSION > 4
+    FCoreUObjectDelegates::OnSyncLoadPackage.Remove(SyncLoadHandle);
+#else
+    FCoreDelegates::OnSyncLoadPackage.Remove(SyncLoadHandle);
+#endif
+
+    UE_LOG(LogUnLua, Display, TEXT("Async loads of %d asset(s) and %d class(es): %d failed, %d synchronous load(s)"), ObjectPaths.Num(), ClassPaths.Num(), NumFailed, NumSyncLoads);
+    return NumFailed > 0 || NumSyncLoads > 0 ? 1 : 0;
+}
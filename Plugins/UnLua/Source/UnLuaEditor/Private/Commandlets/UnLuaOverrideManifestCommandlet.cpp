@@ -0,0 +1,99 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#include "Commandlets/UnLuaOverrideManifestCommandlet.h"
+
+#if ENGINE_MAJOR_VERSION > 4
+#include "AssetRegistry/AssetRegistryModule.h"
+#else
+#include "AssetRegistryModule.h"
+#endif
+#include "Engine/Blueprint.h"
+#include "Misc/EngineVersionComparison.h"
+#include "LuaEnv.h"
+#include "LuaModuleLocator.h"
+#include "LuaOverrideManifest.h"
+#include "UnLuaBase.h"
+#include "UnLuaInterface.h"
+#include "UnLuaSettings.h"
+
+UUnLuaOverrideManifestCommandlet::UUnLuaOverrideManifestCommandlet(const FObjectInitializer& ObjectInitializer)
+    : Super(ObjectInitializer)
+{
+    LogToConsole = true;
+}
+
+int32 UUnLuaOverrideManifestCommandlet::Main(const FString& Params)
+{
+    FString PathsParam = TEXT("/Game");
+    FString OutputPath = UnLua::FLuaOverrideManifest::GetDefaultPath();
+    FParse::Value(*Params, TEXT("Paths="), PathsParam);
+    FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+    TArray<FString> Paths;
+    PathsParam.ParseIntoArray(Paths, TEXT("+"));
+
+    auto& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+    AssetRegistry.SearchAllAssets(true);
+
+    FARFilter Filter;
+#if UE_VERSION_NEWER_THAN(5, 1, 0)
+    Filter.ClassPaths.Add(UBlueprint::StaticClass()->GetClassPathName());
+#else
+    Filter.ClassNames.Add(UBlueprint::StaticClass()->GetFName());
+#endif
+    Filter.bRecursiveClasses = true;
+    Filter.bRecursivePaths = true;
+    for (const auto& Path : Paths)
+        Filter.PackagePaths.Add(*Path);
+
+    TArray<FAssetData> Assets;
+    AssetRegistry.GetAssets(Filter, Assets);
+    for (const auto& Asset : Assets)
+        Asset.GetAsset();
+
+    const auto ModuleLocatorClass = *GetDefault<UUnLuaSettings>()->ModuleLocatorClass;
+    const auto ModuleLocator = (ModuleLocatorClass ? ModuleLocatorClass : ULuaModuleLocator::StaticClass())->GetDefaultObject<ULuaModuleLocator>();
+
+    UnLua::FLuaEnv Env;
+    UnLua::FLuaOverrideManifest Manifest;
+    int32 NumFailed = 0;
+    for (const auto Class : TObjectRange<UClass>())
+    {
+        if (Class->HasAnyClassFlags(CLASS_NewerVersionExists | CLASS_Interface) || Class->GetName().StartsWith(TEXT("SKEL_")) || Class->GetName().StartsWith(TEXT("REINST_")))
+            continue;
+
+        if (!Class->ImplementsInterface(UUnLuaInterface::StaticClass()))
+            continue;
+
+        const auto ModuleName = ModuleLocator->Locate(Class);
+        if (ModuleName.IsEmpty())
+            continue;
+
+        if (!Manifest.Add(Env, Class, ModuleName))
+            ++NumFailed;
+    }
+
+    if (!Manifest.Save(OutputPath))
+        return 1;
+
+    UE_LOG(LogUnLua, Display, TEXT("Override manifest of %d classes from %d blueprints saved to %s"), Manifest.Num(), Assets.Num(), *FPaths::ConvertRelativePathToFull(OutputPath));
+    if (NumFailed > 0)
+    {
+        UE_LOG(LogUnLua, Error, TEXT("%d class(es) left out as their modules failed to load"), NumFailed);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,119 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+
+#include "Commandlets/UnLuaReplayCommandlet.h"
+
+#include "Dom/JsonObject.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonSerializer.h"
+#include "LuaBoundaryRecorder.h"
+#include "UnLuaBase.h"
+#include "UnLuaModule.h"
+
+UUnLuaReplayCommandlet::UUnLuaReplayCommandlet(const FObjectInitializer& ObjectInitializer)
+    : Super(ObjectInitializer)
+{
+    LogToConsole = true;
+}
+
+int32 UUnLuaReplayCommandlet::Main(const FString& Params)
+{
+#if UNLUA_WITH_BOUNDARY_RECORDER
+    FString FilePath;
+    int32 Repeats = 3;
+    FString OutputPath = FPaths::ProjectSavedDir() / TEXT("UnLua/Replay.json");
+    FParse::Value(*Params, TEXT("File="), FilePath);
+    FParse::Value(*Params, TEXT("Repeats="), Repeats);
+    FParse::Value(*Params, TEXT("Output="), OutputPath);
+    FString AllowLuaToUE;
+    FParse::Value(*Params, TEXT("AllowLuaToUE="), AllowLuaToUE, false);
+    TArray<FString> AllowedNames;
+    AllowLuaToUE.ParseIntoArray(AllowedNames, TEXT(","));
+    TSet<FName> AllowedLuaToUE;
+    for (const auto& AllowedName : AllowedNames)
+        AllowedLuaToUE.Add(*AllowedName.TrimStartAndEnd());
+    Repeats = FMath::Max(Repeats, 1);
+
+    if (FilePath.IsEmpty())
+    {
+        UE_LOG(LogUnLua, Error, TEXT("Usage: -run=UnLuaReplay -File=<Recording> [-Repeats=3] [-Output=<Json>] [-AllowLuaToUE=<Function>,<Function>]"));
+        return 1;
+    }
+
+    UnLua::FLuaBoundaryReplay Replay;
+    if (!Replay.Load(FilePath))
+        return 1;
+
+    auto& UnLuaModule = IUnLuaModule::Get();
+    const bool bWasActive = UnLuaModule.IsActive();
+    UnLuaModule.SetActive(true);
+
+    // actors of the recording are spawned in this world
+    UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+    auto& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+    WorldContext.SetCurrentWorld(World);
+    World->InitializeActorsForPlay(FURL());
+    World->BeginPlay();
+
+    const auto Stats = Replay.Run(World, Repeats, AllowedLuaToUE);
+
+    GEngine->DestroyWorldContext(World);
+    World->DestroyWorld(false);
+    UnLuaModule.SetActive(bWasActive);
+
+    TArray<TSharedPtr<FJsonValue>> FunctionValues;
+    UE_LOG(LogUnLua, Display, TEXT("%-60s %-8s %8s %8s %8s %12s %12s"), TEXT("Function"), TEXT("Dir"), TEXT("Calls"), TEXT("Skipped"), TEXT("NoParams"), TEXT("Recorded ns"), TEXT("Replayed ns"));
+    for (const auto& Stat : Stats)
+    {
+        const auto Direction = Stat.Direction == UnLua::FLuaBoundaryRecorder::EDirection::UEToLua ? TEXT("UE->Lua") : TEXT("Lua->UE");
+        const auto FullName = FString::Printf(TEXT("%s:%s"), *Stat.ClassPath, *Stat.FunctionName.ToString());
+        UE_LOG(LogUnLua, Display, TEXT("%-60s %-8s %8d %8d %8d %12.1f %12.1f"), *FullName, Direction, Stat.NumCalls, Stat.NumSkipped, Stat.NumWithoutParams, Stat.RecordedNs, Stat.ReplayedNs);
+
+        const auto JsonObject = MakeShared<FJsonObject>();
+        JsonObject->SetStringField(TEXT("class"), Stat.ClassPath);
+        JsonObject->SetStringField(TEXT("function"), Stat.FunctionName.ToString());
+        JsonObject->SetStringField(TEXT("direction"), Direction);
+        JsonObject->SetNumberField(TEXT("calls"), Stat.NumCalls);
+        JsonObject->SetNumberField(TEXT("skipped"), Stat.NumSkipped);
+        JsonObject->SetNumberField(TEXT("without_params"), Stat.NumWithoutParams);
+        JsonObject->SetNumberField(TEXT("recorded_ns"), Stat.RecordedNs);
+        JsonObject->SetNumberField(TEXT("replayed_ns"), Stat.ReplayedNs);
+        FunctionValues.Add(MakeShared<FJsonValueObject>(JsonObject));
+    }
+
+    const auto Root = MakeShared<FJsonObject>();
+    Root->SetStringField(TEXT("file"), FilePath);
+    Root->SetNumberField(TEXT("calls"), Replay.GetNumCalls());
+    Root->SetNumberField(TEXT("repeats"), Repeats);
+    Root->SetArrayField(TEXT("functions"), FunctionValues);
+
+    FString Content;
+    const auto Writer = TJsonWriterFactory<>::Create(&Content);
+    FJsonSerializer::Serialize(Root, Writer);
+    if (!FFileHelper::SaveStringToFile(Content, *OutputPath))
+    {
+        UE_LOG(LogUnLua, Error, TEXT("Failed to save replay results to %s"), *OutputPath);
+        return 1;
+    }
+    UE_LOG(LogUnLua, Display, TEXT("Replay results saved to %s"), *FPaths::ConvertRelativePathToFull(OutputPath));
+    return 0;
+#else
+    UE_LOG(LogUnLua, Error, TEXT("Boundary recorder is not available in this build."));
+    return 1;
+#endif
+}
@@ -0,0 +1,120 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "Engine/EngineTypes.h"
+#include "GameFramework/Actor.h"
+#include "UnLuaInterface.h"
+#include "UnLuaBenchmarkCommandlet.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FUnLuaBenchmarkDelegate, int32, Value);
+
+/**
+ * Target of the benchmarks, bound to 'UnLua.Benchmark'. Native only, so the benchmarks run without any asset.
+ * Transient blueprints of it are created to measure the first spawn of bound classes, and to declare the server RPCs
+ * as replicated custom events: UnLua overrides RPCs of blueprints, native RPCs can't be blueprint events.
+ */
+UCLASS(Blueprintable)
+class UUnLuaBenchmarkObject : public UObject, public IUnLuaInterface
+{
+    GENERATED_BODY()
+
+public:
+    virtual FString GetModuleName_Implementation() const override
+    {
+        return TEXT("UnLua.Benchmark");
+    }
+
+    /** Overridden in Lua */
+    UFUNCTION(BlueprintImplementableEvent)
+    int32 Compute(int32 Value);
+
+    UFUNCTION(BlueprintCallable)
+    int32 Add(int32 A, int32 B) const
+    {
+        return A + B;
+    }
+
+    UPROPERTY(BlueprintReadWrite)
+    int32 IntValue = 0;
+
+    UPROPERTY(BlueprintReadWrite)
+    TArray<int32> Numbers;
+
+    UPROPERTY(BlueprintReadWrite)
+    FHitResult Hit;
+
+    UPROPERTY(BlueprintAssignable)
+    FUnLuaBenchmarkDelegate OnNotify;
+};
+
+/**
+ * Ticked every frame by 'ReceiveTick' in Lua, bound to 'UnLua.BenchmarkTick'.
+ */
+UCLASS()
+class AUnLuaBenchmarkTickActor : public AActor, public IUnLuaInterface
+{
+    GENERATED_BODY()
+
+public:
+    AUnLuaBenchmarkTickActor()
+    {
+        PrimaryActorTick.bCanEverTick = true;
+    }
+
+    virtual FString GetModuleName_Implementation() const override
+    {
+        return TEXT("UnLua.BenchmarkTick");
+    }
+};
+
+/**
+ * Same as AUnLuaBenchmarkTickActor but bound to 'UnLua.BenchmarkBatchedTick', ticked in batches.
+ */
+UCLASS()
+class AUnLuaBenchmarkBatchedTickActor : public AUnLuaBenchmarkTickActor
+{
+    GENERATED_BODY()
+
+public:
+    virtual FString GetModuleName_Implementation() const override
+    {
+        return TEXT("UnLua.BenchmarkBatchedTick");
+    }
+};
+
+/**
+ * Runs microbenchmarks of UnLua's hot paths and reports ns/op and allocations/op as json.
+ *
+ * UnrealEditor-Cmd <Project> -run=UnLuaBenchmark -nullrhi [-Filter=Name] [-Iterations=100000] [-Repeats=5]
+ *     [-Output=Saved/UnLua/Benchmark.json] [-Baseline=<Saved json>] [-Tolerance=10]
+ *
+ * Hitches of the first spawn of distinct bound classes, with and without the override manifest, are reported apart.
+ * Frame times of 100, 500 and 2000 actors ticked in Lua, one by one and batched, are reported apart too [-Frames=300],
+ * and so are the throughputs of reading a large file through UE.File [-FileMB=100].
+ *
+ * Returns 1 if any benchmark fails. With a baseline, returns 1 as well if any result is slower, allocates more or reads
+ * less than the tolerance in percent, or if a benchmark of the baseline picked by the filter has no result.
+ */
+UCLASS()
+class UUnLuaBenchmarkCommandlet : public UCommandlet
+{
+    GENERATED_UCLASS_BODY()
+
+public:
+    virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,35 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "UnLuaLoadAsyncCheckCommandlet.generated.h"
+
+/**
+ * Loads assets through UObject.LoadAsync, UObject.LoadAsyncBatch and UClass.LoadAsync, in a coroutine and with a
+ * callback, and fails if any package is loaded synchronously meanwhile. Paths, FSoftObjectPtr and FSoftObjectPath
+ * are passed to the batch. The assets default to unloaded ones found under the content paths.
+ *
+ * UnrealEditor-Cmd <Project> -run=UnLuaLoadAsyncCheck -nullrhi [-Assets=/Game/A.A+/Game/B.B] [-Paths=/Game] [-Timeout=60]
+ */
+UCLASS()
+class UUnLuaLoadAsyncCheckCommandlet : public UCommandlet
+{
+    GENERATED_UCLASS_BODY()
+
+public:
+    virtual int32 Main(const FString& Params) override;
+};
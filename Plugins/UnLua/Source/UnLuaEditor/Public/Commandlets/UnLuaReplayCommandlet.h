@@ -0,0 +1,35 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "UnLuaReplayCommandlet.generated.h"
+
+/**
+ * Replays a recording of the calls between UE and Lua, made with 'lua.record.start', and reports the cost of each
+ * function as json. Lua to UE calls are only replayed for BlueprintPure and const functions and those of -AllowLuaToUE.
+ *
+ * UnrealEditor-Cmd <Project> -run=UnLuaReplay -nullrhi -File=<Recording> [-Repeats=3] [-Output=Saved/UnLua/Replay.json]
+ *     [-AllowLuaToUE=<Function>,<Function>]
+ */
+UCLASS()
+class UUnLuaReplayCommandlet : public UCommandlet
+{
+    GENERATED_UCLASS_BODY()
+
+public:
+    virtual int32 Main(const FString& Params) override;
+};
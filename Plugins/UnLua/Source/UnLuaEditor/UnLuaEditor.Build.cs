@@ -63,6 +63,7 @@ public class UnLuaEditor : ModuleRules
                 "CoreUObject",
                 "Engine",
                 "UnrealEd",
+                "AssetRegistry",
 #if UE_5_0_OR_LATER
                 "DeveloperToolSettings",
 #endif
@@ -80,6 +81,7 @@ public class UnLuaEditor : ModuleRules
                 "Sockets",
                 "UnLua",
                 "Lua",
+                "Json",
                 "ToolMenus"
             }
         );